@@ -70,7 +70,7 @@ typedef struct
   uint8 readmask;         /* Autoselect mode read address mask */
 } T_FLASH_CFI;
 
-static T_FLASH_CFI flash;
+static THREAD_LOCAL T_FLASH_CFI flash;
 
 /* CFI query data arrays */
 static const uint8 cfi_query[MAX_FLASH_CFI_SUPPORTED_TYPES][CFI_QUERY_TABLE_LEN] =
@@ -1016,7 +1016,7 @@ int md_cart_context_save(uint8 *state)
   if (svp)
   {
     save_param(svp->iram_rom, 0x800);
-    save_param(svp->dram,sizeof(svp->dram));
+    save_region(svp->dram,sizeof(svp->dram));
     save_param(&svp->ssp1601,sizeof(ssp1601_t));
   }
 
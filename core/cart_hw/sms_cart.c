@@ -446,11 +446,11 @@ static const rominfo_t game_list[] =
 };
 
 /* Cartridge & BIOS ROM hardware */
-static romhw_t cart_rom;
-static romhw_t bios_rom;
+static THREAD_LOCAL romhw_t cart_rom;
+static THREAD_LOCAL romhw_t bios_rom;
 
 /* Current slot */
-static struct
+static THREAD_LOCAL struct
 {
   uint8 *rom;
   uint8 *fcr;
@@ -72,7 +72,7 @@ typedef struct
   mp3d_sample_t audio[2] ;                /* left & right audio channels outputs */
 } T_YX5200;
 
-static T_YX5200 yx5200;
+static THREAD_LOCAL T_YX5200 yx5200;
 
 static void yx5200_process_cmd(void);
 static void yx5200_load_track(uint16 index, uint8 playbackLoop);
@@ -88,9 +88,9 @@ static int seek_cb(uint64_t position, void *user_data)
   return cdStreamSeek((cdStream*)user_data, position, SEEK_SET);
 }
 
-static mp3dec_ex_t mp3dec;
-static mp3d_sample_t audioBuffer[2048];
-static mp3dec_io_t mp3io = {read_cb, NULL, seek_cb, NULL};
+static THREAD_LOCAL mp3dec_ex_t mp3dec;
+static THREAD_LOCAL mp3d_sample_t audioBuffer[2048];
+static THREAD_LOCAL mp3dec_io_t mp3io = {read_cb, NULL, seek_cb, NULL};
 
 void yx5200_init(int samplerate)
 {
@@ -213,8 +213,8 @@ void yx5200_update(unsigned int samples)
       }
     }
 
-    /* check audio is not silent or muted */
-    if (yx5200.playbackVolume && yx5200.audioEnabled)
+    /* check audio is not silent or muted (decoded samples are dropped if sound generation is disabled) */
+    if (yx5200.playbackVolume && yx5200.audioEnabled && !snd.muted)
     {
       /* update blip buffer with available audio samples */
       int count = 0;
@@ -1343,6 +1343,8 @@ void cdd_unload(void)
 
 void cdd_read_data(uint8 *dst, uint8 *subheader)
 {
+  PROFILE_START(PROF_CDD_READ);
+
   /* only allow reading (first) CD-ROM track sectors */
   if (cdd.toc.tracks[cdd.index].type && (cdd.lba >= 0))
   {
@@ -1386,6 +1388,7 @@ void cdd_read_data(uint8 *dst, uint8 *subheader)
         }
       }
 
+      PROFILE_END(PROF_CDD_READ);
       return;
     }
 #endif
@@ -1417,6 +1420,8 @@ void cdd_read_data(uint8 *dst, uint8 *subheader)
       }
     }
   }
+
+  PROFILE_END(PROF_CDD_READ);
 }
 
 void cdd_seek_audio(int index, int lba)
@@ -1465,14 +1470,89 @@ void cdd_seek_audio(int index, int lba)
   }
 }
 
+/* Update CD-DA read position & fader volume without sound generation (see audio_set_mute) */
+static unsigned int cdd_mute_audio(unsigned int samples)
+{
+  /* current CD-DA fader volume */
+  int curVol = cdd.fader[0];
+
+  /* CD-DA fader volume setup (0-1024) */
+  int endVol = cdd.fader[1];
+
+  /* number of fader steps until CD-DA fader volume setup */
+  unsigned int steps = (curVol < endVol) ? (endVol - curVol) : (curVol - endVol);
+
+#if defined(USE_LIBCHDR)
+  if (cdd.chd.file)
+  {
+    /* number of processed samples (audio remains muted once faded out until next setup) */
+    unsigned int count = (!endVol && (samples > steps)) ? (steps + 1) : samples;
+
+    /* sector data offset after processed samples */
+    unsigned int offset = (cdd.chd.hunkofs % CD_FRAME_SIZE) + (count * 4);
+
+    /* update CHD file offset (subcode data is skipped at the end of each sector data) */
+    cdd.chd.hunkofs += (count * 4) + ((offset / CD_MAX_SECTOR_DATA) * CD_MAX_SUBCODE_DATA);
+  }
+  else
+#endif
+#if defined(USE_LIBTREMOR) || defined(USE_LIBVORBIS)
+  if (cdd.toc.tracks[cdd.index].vf.datasource)
+  {
+    /* VORBIS AUDIO track samples still need to be decoded */
+    int len, done = 0;
+    samples = samples * 4;
+    while (done < samples)
+    {
+#ifdef USE_LIBVORBIS
+      len = ov_read(&cdd.toc.tracks[cdd.index].vf, (char *)(cdc.ram + done), samples - done, 0, 2, 1, 0);
+#else
+      len = ov_read(&cdd.toc.tracks[cdd.index].vf, (char *)(cdc.ram + done), samples - done, 0);
+#endif
+      if (len <= 0)
+      {
+        done = samples;
+        break;
+      }
+      done += len;
+    }
+    samples = done / 4;
+  }
+  else
+#endif
+  {
+    /* skip PCM AUDIO track samples */
+    cdStreamSeek(cdd.toc.tracks[cdd.index].fd, samples * 4, SEEK_CUR);
+  }
+
+  /* update CD-DA fader volume (one step/sample) */
+  if (steps > samples)
+  {
+    steps = samples;
+  }
+  cdd.fader[0] = (curVol < endVol) ? (curVol + steps) : (curVol - steps);
+
+  return samples;
+}
+
 void cdd_read_audio(unsigned int samples)
 {
   /* previous audio outputs */
   int prev_l = cdd.audio[0];
   int prev_r = cdd.audio[1];
 
+  /* check if sound generation is disabled */
+  if (snd.muted)
+  {
+    /* audio track playing ? */
+    if (!scd.regs[0x36>>1].byte.h && cdd.toc.tracks[cdd.index].fd)
+    {
+      samples = cdd_mute_audio(samples);
+    }
+  }
+
   /* audio track playing ? */
-  if (!scd.regs[0x36>>1].byte.h && cdd.toc.tracks[cdd.index].fd)
+  else if (!scd.regs[0x36>>1].byte.h && cdd.toc.tracks[cdd.index].fd)
   {
     int i, mul, l, r;
 
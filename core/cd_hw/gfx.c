@@ -432,10 +432,11 @@ int gfx_context_save(uint8 *state)
   save_param(&gfx.bufferOffset, sizeof(gfx.bufferOffset));
   save_param(&gfx.bufferStart, sizeof(gfx.bufferStart));
 
-  tmp32 = (uint8 *)(gfx.tracePtr) - scd.word_ram_2M;
+  /* offsets are masked the same way as when they are loaded, so that restored state is saved identically */
+  tmp32 = ((uint8 *)(gfx.tracePtr) - scd.word_ram_2M) & 0x3fff8;
   save_param(&tmp32, 4);
 
-  tmp32 = (uint8 *)(gfx.mapPtr) - scd.word_ram_2M;
+  tmp32 = ((uint8 *)(gfx.mapPtr) - scd.word_ram_2M) & ~((1 << ((2*gfx.mapShift) + 1)) - 1) & 0x3ffff;
   save_param(&tmp32, 4);
 
   return bufferptr;
@@ -673,6 +674,8 @@ void gfx_start(unsigned int base, int cycles)
 
 void gfx_update(int cycles)
 {
+  PROFILE_START(PROF_GFX_UPDATE);
+
   /* make sure Word-RAM is assigned to SUB-CPU in 2M mode */
   if ((scd.regs[0x02>>1].byte.l & 0x05) != 0x01)
   {
@@ -751,4 +754,6 @@ void gfx_update(int cycles)
     /* GFX processing is halted */
     gfx.cycles = cycles;
   }
+
+  PROFILE_END(PROF_GFX_UPDATE);
 }
@@ -86,7 +86,7 @@ int pcm_context_save(uint8 *state)
   save_param(&pcm.enabled, sizeof(pcm.enabled));
   save_param(&pcm.status, sizeof(pcm.status));
   save_param(&pcm.index, sizeof(pcm.index));
-  save_param(pcm.ram, sizeof(pcm.ram));
+  save_region(pcm.ram, sizeof(pcm.ram));
 
   return bufferptr;
 }
@@ -110,6 +110,38 @@ int pcm_context_load(uint8 *state)
   return bufferptr;
 }
 
+/* Run PCM channels without sound generation (see audio_set_mute) */
+static void pcm_mute(unsigned int length)
+{
+  int i, j;
+
+  for (j=0; j<8; j++)
+  {
+    /* check if channel is enabled */
+    if (pcm.status & (1 << j))
+    {
+      uint32 addr = pcm.chan[j].addr;
+
+      for (i=0; i<length; i++)
+      {
+        /* loop data ? */
+        if (pcm.ram[(addr >> 11) & 0xffff] == 0xff)
+        {
+          /* reset WAVE RAM address */
+          addr = pcm.chan[j].ls.w << 11;
+        }
+        else
+        {
+          /* increment WAVE RAM address */
+          addr += pcm.chan[j].fd.w;
+        }
+      }
+
+      pcm.chan[j].addr = addr;
+    }
+  }
+}
+
 void pcm_run(unsigned int length)
 {
 #ifdef LOG_PCM
@@ -120,8 +152,18 @@ void pcm_run(unsigned int length)
   int prev_l = pcm.out[0];
   int prev_r = pcm.out[1];
 
+  /* check if sound generation is disabled */
+  if (snd.muted)
+  {
+    /* only update channels WAVE RAM addresses */
+    if (pcm.enabled)
+    {
+      pcm_mute(length);
+    }
+  }
+
   /* check if PCM chip is running */
-  if (pcm.enabled)
+  else if (pcm.enabled)
   {
     int i, j, l, r;
   
@@ -2034,18 +2034,18 @@ int scd_context_save(uint8 *state)
   bufferptr += pcm_context_save(&state[bufferptr]);
 
   /* PRG-RAM */
-  save_param(scd.prg_ram, sizeof(scd.prg_ram));
+  save_region(scd.prg_ram, sizeof(scd.prg_ram));
 
   /* Word-RAM */
   if (scd.regs[0x03>>1].byte.l & 0x04)
   {
     /* 1M mode */
-    save_param(scd.word_ram, sizeof(scd.word_ram));
+    save_region(scd.word_ram, sizeof(scd.word_ram));
   }
   else
   {
     /* 2M mode */
-    save_param(scd.word_ram_2M, sizeof(scd.word_ram_2M));
+    save_region(scd.word_ram_2M, sizeof(scd.word_ram_2M));
   }
 
   /* MAIN-CPU & SUB-CPU polling */
@@ -0,0 +1,175 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Core profiling counters
+ *
+ *  USE_PROFILER should be defined in a makefile or MSVC project to enable this functionality
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifdef USE_PROFILER
+
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#include "macros.h"
+#include "profiler.h"
+
+#ifdef USE_RENDER_THREAD
+static prof_counter_t prof_threads[PROF_THREADS][PROF_MAX];
+static prof_counter_t prof_cur[PROF_MAX];
+PROF_THREAD_LOCAL uint64_t prof_start[PROF_MAX];
+PROF_THREAD_LOCAL prof_counter_t *prof_frame = prof_threads[0];
+#else
+THREAD_LOCAL uint64_t prof_start[PROF_MAX];
+THREAD_LOCAL prof_counter_t prof_frame[PROF_MAX];
+#endif
+
+static THREAD_LOCAL prof_counter_t prof_total[PROF_MAX];
+static THREAD_LOCAL prof_counter_t prof_sum[PROF_MAX];
+static THREAD_LOCAL uint32_t prof_frames;
+
+static const char *prof_names[PROF_MAX] =
+{
+  "m68k", "s68k", "z80", "render_line", "parse_satb", "pattern_cache",
+  "sound_update", "fm_update", "blip_mix", "cdd_read", "gfx_update"
+};
+
+uint64_t profiler_ticks(void)
+{
+#ifdef _WIN32
+  static LARGE_INTEGER freq;
+  LARGE_INTEGER now;
+  if (!freq.QuadPart)
+  {
+    QueryPerformanceFrequency(&freq);
+  }
+  QueryPerformanceCounter(&now);
+  return (uint64_t)((double)now.QuadPart * 1e9 / (double)freq.QuadPart);
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000000000) + ts.tv_nsec;
+#endif
+}
+
+#ifdef USE_RENDER_THREAD
+void profiler_thread(int index)
+{
+  prof_frame = prof_threads[index];
+}
+
+/* current frame counters of all threads */
+static const prof_counter_t *profiler_current(void)
+{
+  int i, j;
+
+  memcpy(prof_cur, prof_threads[0], sizeof(prof_cur));
+  for (j=1; j<PROF_THREADS; j++)
+  {
+    for (i=0; i<PROF_MAX; i++)
+    {
+      prof_cur[i].time += prof_threads[j][i].time;
+      prof_cur[i].calls += prof_threads[j][i].calls;
+    }
+  }
+
+  return prof_cur;
+}
+
+static void profiler_clear(void)
+{
+  memset(prof_threads, 0, sizeof(prof_threads));
+}
+#else
+#define profiler_current() prof_frame
+#define profiler_clear() memset(prof_frame, 0, sizeof(prof_frame))
+#endif
+
+void profiler_reset(void)
+{
+  profiler_clear();
+  memset(prof_total, 0, sizeof(prof_total));
+  prof_frames = 0;
+}
+
+void profiler_frame(void)
+{
+  int i;
+  const prof_counter_t *cur = profiler_current();
+
+  for (i=0; i<PROF_MAX; i++)
+  {
+    prof_total[i].time += cur[i].time;
+    prof_total[i].calls += cur[i].calls;
+  }
+
+  profiler_clear();
+  prof_frames++;
+}
+
+const prof_counter_t *profiler_get_frame(void)
+{
+  return profiler_current();
+}
+
+const prof_counter_t *profiler_get_total(void)
+{
+  int i;
+  const prof_counter_t *cur = profiler_current();
+
+  /* include current frame */
+  for (i=0; i<PROF_MAX; i++)
+  {
+    prof_sum[i].time = prof_total[i].time + cur[i].time;
+    prof_sum[i].calls = prof_total[i].calls + cur[i].calls;
+  }
+
+  return prof_sum;
+}
+
+uint32_t profiler_get_frames(void)
+{
+  return prof_frames;
+}
+
+const char *profiler_get_name(prof_id_t id)
+{
+  return (id < PROF_MAX) ? prof_names[id] : "";
+}
+
+#endif /* USE_PROFILER */
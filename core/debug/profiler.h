@@ -0,0 +1,116 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Core profiling counters
+ *
+ *  USE_PROFILER should be defined in a makefile or MSVC project to enable this functionality
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <stdint.h>
+
+/* Profiled subsystems */
+typedef enum {
+  PROF_M68K = 0,      /* m68k_run */
+  PROF_S68K,          /* s68k_run */
+  PROF_Z80,           /* z80_run */
+  PROF_RENDER_LINE,   /* render_line */
+  PROF_PARSE_SATB,    /* parse_satb (from render_line) */
+  PROF_PATTERN_CACHE, /* pattern cache decoding (from render_line, counted only) */
+  PROF_SOUND_UPDATE,  /* sound_update */
+  PROF_FM_UPDATE,     /* fm_update (YM_Update) */
+  PROF_BLIP_MIX,      /* blip_mix_samples / blip_read_samples */
+  PROF_CDD_READ,      /* cdd_read_data */
+  PROF_GFX_UPDATE,    /* gfx_update */
+  PROF_MAX
+} prof_id_t;
+
+typedef struct
+{
+  uint64_t time;      /* accumulated wall time (nanoseconds) */
+  uint32_t calls;     /* number of calls */
+} prof_counter_t;
+
+/* Counters are inclusive: time spent in a subsystem called from another profiled subsystem  */
+/* (e.g fm_update triggered by YM2612 accesses from m68k_run or z80_run) is also accounted   */
+/* in the caller. Subsystems run too often to be timed individually (PROFILE_COUNT) only    */
+/* count calls, their time is accounted in the caller.                                      */
+/*                                                                                          */
+/* profiler_frame() is called at the start of each emulated frame: it adds counters of the  */
+/* previous frame to the totals and clears them. Once system_frame_* and audio_update have  */
+/* returned, profiler_get_frame() therefore holds counters for the whole frame, while       */
+/* profiler_get_total() holds counters for all frames since last profiler_reset() call.     */
+/*                                                                                          */
+/* Worker threads running profiled code (see render_thread_start) select their own set of   */
+/* counters with PROFILE_THREAD(), so that they never update emulation thread counters.     */
+/* These are added to emulation thread counters by profiler functions, which must therefore */
+/* only be called while workers are idle (i.e once the frame has been rendered).            */
+
+/* Function prototypes */
+extern void profiler_reset(void);
+extern void profiler_frame(void);
+extern const prof_counter_t *profiler_get_frame(void);
+extern const prof_counter_t *profiler_get_total(void);
+extern uint32_t profiler_get_frames(void);
+extern const char *profiler_get_name(prof_id_t id);
+
+/* Internal instrumentation (use PROFILE_START / PROFILE_END / PROFILE_COUNT macros) */
+extern uint64_t profiler_ticks(void);
+#ifdef USE_RENDER_THREAD
+/* one set of counters per thread (0 = emulation thread, 1 = render thread) */
+#define PROF_THREADS 2
+#if defined(_MSC_VER)
+#define PROF_THREAD_LOCAL __declspec(thread)
+#else
+#define PROF_THREAD_LOCAL __thread
+#endif
+extern void profiler_thread(int index);
+extern PROF_THREAD_LOCAL uint64_t prof_start[PROF_MAX];
+extern PROF_THREAD_LOCAL prof_counter_t *prof_frame;
+#define PROFILE_THREAD(index) profiler_thread(index)
+#else
+extern THREAD_LOCAL uint64_t prof_start[PROF_MAX];
+extern THREAD_LOCAL prof_counter_t prof_frame[PROF_MAX];
+#define PROFILE_THREAD(index)
+#endif
+
+#define PROFILE_START(id) prof_start[id] = profiler_ticks()
+#define PROFILE_END(id) do { prof_frame[id].time += profiler_ticks() - prof_start[id]; prof_frame[id].calls++; } while (0)
+#define PROFILE_COUNT(id) prof_frame[id].calls++
+#define PROFILE_FRAME() profiler_frame()
+
+#endif /* _PROFILER_H_ */
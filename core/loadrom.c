@@ -90,11 +90,11 @@ typedef struct
 } PERIPHERALINFO;
 
 
-ROMINFO rominfo;
-uint8 romtype;
-char rompath[256];
+THREAD_LOCAL ROMINFO rominfo;
+THREAD_LOCAL uint8 romtype;
+THREAD_LOCAL char rompath[256];
 
-static uint8 rom_region;
+static THREAD_LOCAL uint8 rom_region;
 
 /***************************************************************************
  * Genesis ROM Manufacturers
@@ -62,9 +62,9 @@ typedef struct
 
 
 /* Global variables */
-extern ROMINFO rominfo;
-extern uint8 romtype;
-extern char rompath[256];
+extern THREAD_LOCAL ROMINFO rominfo;
+extern THREAD_LOCAL uint8 romtype;
+extern THREAD_LOCAL char rompath[256];
 
 /* Function prototypes */
 extern int load_bios(int system);
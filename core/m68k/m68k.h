@@ -295,8 +295,8 @@ typedef struct
 } m68ki_cpu_core;
 
 /* CPU cores */
-extern m68ki_cpu_core m68k;
-extern m68ki_cpu_core s68k;
+extern THREAD_LOCAL m68ki_cpu_core m68k;
+extern THREAD_LOCAL m68ki_cpu_core s68k;
 
 
 /* ======================================================================== */
@@ -13,6 +13,8 @@ extern int vdp_68k_irq_ack(int int_level);
 
 #ifndef BUILD_TABLES
 #include "m68ki_cycles.h"
+#else
+static unsigned char m68ki_cycles[0x10000];
 #endif
 
 #include "m68kconf.h"
@@ -23,13 +25,9 @@ extern int vdp_68k_irq_ack(int int_level);
 /* ================================= DATA ================================= */
 /* ======================================================================== */
 
-#ifdef BUILD_TABLES
-static unsigned char m68ki_cycles[0x10000];
-#endif
+static THREAD_LOCAL int irq_latency;
 
-static int irq_latency;
-
-m68ki_cpu_core m68k;
+THREAD_LOCAL m68ki_cpu_core m68k;
 
 
 /* ======================================================================== */
@@ -275,6 +273,8 @@ void m68k_run(unsigned int cycles)
   /* Save end cycles count for when CPU is stopped */
   m68k.cycle_end = cycles;
 
+  PROFILE_START(PROF_M68K);
+
   /* Return point for when we have an address error (TODO: use goto) */
   m68ki_set_address_error_trap() /* auto-disable (see m68kcpu.h) */
 
@@ -313,6 +313,8 @@ void m68k_run(unsigned int cycles)
     /* Trace m68k_exception, if necessary */
     m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
   }
+
+  PROFILE_END(PROF_M68K);
 }
 
 int m68k_cycles(void)
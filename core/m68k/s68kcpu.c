@@ -13,6 +13,8 @@ extern int scd_68k_irq_ack(int level);
 
 #ifndef BUILD_TABLES
 #include "s68ki_cycles.h"
+#else
+static unsigned char m68ki_cycles[0x10000];
 #endif
 
 #include "s68kconf.h"
@@ -23,10 +25,7 @@ extern int scd_68k_irq_ack(int level);
 /* ================================= DATA ================================= */
 /* ======================================================================== */
 
-#ifdef BUILD_TABLES
-static unsigned char s68ki_cycles[0x10000];
-#endif
-static int irq_latency;
+static THREAD_LOCAL int irq_latency;
 
 /* IRQ priority */
 static const uint8 irq_level[0x40] = 
@@ -41,7 +40,7 @@ static const uint8 irq_level[0x40] =
   6, 6, 6, 6, 6, 6, 6, 6
 };
 
-m68ki_cpu_core s68k;
+THREAD_LOCAL m68ki_cpu_core s68k;
 
 
 /* ======================================================================== */
@@ -238,6 +237,8 @@ void s68k_run(unsigned int cycles)
   /* Save end cycles count for when CPU is stopped */
   s68k.cycle_end = cycles;
 
+  PROFILE_START(PROF_S68K);
+
   /* Return point for when we have an address error (TODO: use goto) */
   m68ki_set_address_error_trap() /* auto-disable (see m68kcpu.h) */
 
@@ -266,6 +267,8 @@ void s68k_run(unsigned int cycles)
     /* Trace m68k_exception, if necessary */
     m68ki_exception_if_trace(); /* auto-disable (see m68kcpu.h) */
   }
+
+  PROFILE_END(PROF_S68K);
 }
 
 
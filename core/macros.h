@@ -62,6 +62,36 @@
 #define UNLIKELY(x) x
 #endif
 
+/* Multi-instance support */
+/* When USE_MULTI_INSTANCE is defined, all emulator state is thread-local: each thread
+   running the core owns an independent instance, while read-only look-up tables are
+   shared by all instances. Cartridge / CD hardware memory is then always dynamically
+   allocated (by load_rom) so that per-thread storage remains small.
+*/
+#ifdef USE_MULTI_INSTANCE
+#ifndef USE_DYNAMIC_ALLOC
+#define USE_DYNAMIC_ALLOC
+#endif
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+#else
+#define THREAD_LOCAL
+#endif
+
+/* Core profiling counters (see core/debug/profiler.h) */
+#ifdef USE_PROFILER
+#include "profiler.h"
+#else
+#define PROFILE_START(id)
+#define PROFILE_END(id)
+#define PROFILE_COUNT(id)
+#define PROFILE_FRAME()
+#define PROFILE_THREAD(index)
+#endif
+
 /* Default CD image file access (read-only) functions */
 /* If you need to override default stdio.h functions with custom filesystem API,
    redefine following macros in platform specific include file (osd.h) or Makefile
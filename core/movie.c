@@ -0,0 +1,396 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Movie recording & playback (deterministic input replay)
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+/* header layout */
+#define MOVIE_HEADER_SIZE 32
+#define MOVIE_OFS_VERSION 8
+#define MOVIE_OFS_FRAMES  12
+#define MOVIE_OFS_STATE   16
+#define MOVIE_OFS_CHKSUM  20
+#define MOVIE_OFS_SYSTEM  22
+#define MOVIE_OFS_DEVICES 24
+
+/* per-device input record size (pad + analog x/y) */
+#define MOVIE_INPUT_SIZE  6
+
+static THREAD_LOCAL struct
+{
+  uint8 *data;                          /* movie buffer */
+  uint32 size;                          /* movie buffer size */
+  uint32 length;                        /* movie data length */
+  uint32 pos;                           /* playback offset */
+  int status;                           /* MOVIE_IDLE, MOVIE_RECORD or MOVIE_PLAY */
+  int frame;                            /* current frame */
+  int frames;                           /* number of frames recorded or to be replayed */
+  uint32 session;                       /* changes whenever a movie is started or stopped */
+  uint16 pad[MAX_DEVICES];              /* last recorded or replayed inputs */
+  int16 analog[MAX_DEVICES][2];
+} movie;
+
+/* movie data is stored in little-endian format, regardless of host endianness */
+static void write_word(uint8 *buf, int offset, uint16 data)
+{
+  buf[offset] = data & 0xff;
+  buf[offset + 1] = data >> 8;
+}
+
+static void write_dword(uint8 *buf, int offset, uint32 data)
+{
+  write_word(buf, offset, data & 0xffff);
+  write_word(buf, offset + 2, data >> 16);
+}
+
+static uint16 read_word(const uint8 *buf, int offset)
+{
+  return buf[offset] | (buf[offset + 1] << 8);
+}
+
+static uint32 read_dword(const uint8 *buf, int offset)
+{
+  return read_word(buf, offset) | ((uint32)read_word(buf, offset + 2) << 16);
+}
+
+static int movie_reserve(uint32 length)
+{
+  uint8 *data;
+  uint32 size = movie.size ? movie.size : 0x10000;
+
+  if (movie.length + length <= movie.size)
+  {
+    return 1;
+  }
+
+  while (size < movie.length + length)
+  {
+    size <<= 1;
+  }
+
+  data = realloc(movie.data, size);
+  if (!data)
+  {
+    return 0;
+  }
+
+  movie.data = data;
+  movie.size = size;
+  return 1;
+}
+
+static void movie_start(int status)
+{
+  memset(movie.pad, 0, sizeof(movie.pad));
+  memset(movie.analog, 0, sizeof(movie.analog));
+  movie.frame = 0;
+  movie.status = status;
+  movie.session++;
+}
+
+int movie_record(int from_state)
+{
+  int size = 0;
+
+  movie_stop();
+  movie.length = 0;
+  movie.frames = 0;
+
+  if (!movie_reserve(MOVIE_HEADER_SIZE + (from_state ? STATE_SIZE : 0)))
+  {
+    return 0;
+  }
+
+  if (from_state)
+  {
+    /* savestates only restore emulated hardware state so current session is restarted */
+    /* from the recorded savestate, exactly like it will be on playback */
+    size = state_save(&movie.data[MOVIE_HEADER_SIZE]);
+    if (!state_load(&movie.data[MOVIE_HEADER_SIZE], size))
+    {
+      return 0;
+    }
+  }
+  else
+  {
+    /* start from power-on */
+    system_reset();
+  }
+
+  memset(movie.data, 0, MOVIE_HEADER_SIZE);
+  memcpy(movie.data, MOVIE_SIGNATURE, 8);
+  write_dword(movie.data, MOVIE_OFS_VERSION, MOVIE_VERSION);
+  write_dword(movie.data, MOVIE_OFS_STATE, size);
+  write_word(movie.data, MOVIE_OFS_CHKSUM, rominfo.realchecksum);
+  memcpy(&movie.data[MOVIE_OFS_SYSTEM], input.system, 2);
+  memcpy(&movie.data[MOVIE_OFS_DEVICES], input.dev, MAX_DEVICES);
+  movie.length = MOVIE_HEADER_SIZE + size;
+
+  movie_start(MOVIE_RECORD);
+  return 1;
+}
+
+int movie_play(const unsigned char *data, int size)
+{
+  uint32 state_size;
+
+  movie_stop();
+
+  /* check movie header */
+  if ((size < MOVIE_HEADER_SIZE) || memcmp(data, MOVIE_SIGNATURE, 8))
+  {
+    return 0;
+  }
+
+  if (read_dword(data, MOVIE_OFS_VERSION) != MOVIE_VERSION)
+  {
+    return 0;
+  }
+
+  state_size = read_dword(data, MOVIE_OFS_STATE);
+  if (state_size > (uint32)(size - MOVIE_HEADER_SIZE))
+  {
+    return 0;
+  }
+
+  /* movie must have been recorded with the same game & input devices */
+  if ((read_word(data, MOVIE_OFS_CHKSUM) != rominfo.realchecksum) ||
+      memcmp(&data[MOVIE_OFS_SYSTEM], input.system, 2) ||
+      memcmp(&data[MOVIE_OFS_DEVICES], input.dev, MAX_DEVICES))
+  {
+    return 0;
+  }
+
+  movie.length = 0;
+  if (!movie_reserve(size))
+  {
+    return 0;
+  }
+
+  memcpy(movie.data, data, size);
+  movie.length = size;
+  movie.frames = read_dword(data, MOVIE_OFS_FRAMES);
+  movie.pos = MOVIE_HEADER_SIZE + state_size;
+
+  if (state_size)
+  {
+    if (!state_load(&movie.data[MOVIE_HEADER_SIZE], state_size))
+    {
+      return 0;
+    }
+  }
+  else
+  {
+    system_reset();
+  }
+
+  movie_start(movie.frames ? MOVIE_PLAY : MOVIE_IDLE);
+  return 1;
+}
+
+void movie_stop(void)
+{
+  if (movie.status == MOVIE_RECORD)
+  {
+    write_dword(movie.data, MOVIE_OFS_FRAMES, movie.frames);
+  }
+
+  movie.status = MOVIE_IDLE;
+  movie.session++;
+}
+
+void movie_shutdown(void)
+{
+  uint32 session = movie.session;
+  free(movie.data);
+  memset(&movie, 0, sizeof(movie));
+  movie.session = session + 1;
+}
+
+/* movie position, not part of savestates (see state_snapshot_save) */
+int movie_context_save(uint8 *state)
+{
+  int bufferptr = 0;
+
+  save_param(&movie.session, sizeof(movie.session));
+  save_param(&movie.status, sizeof(movie.status));
+  save_param(&movie.length, sizeof(movie.length));
+  save_param(&movie.pos, sizeof(movie.pos));
+  save_param(&movie.frame, sizeof(movie.frame));
+  save_param(&movie.frames, sizeof(movie.frames));
+  save_param(movie.pad, sizeof(movie.pad));
+  save_param(movie.analog, sizeof(movie.analog));
+
+  return bufferptr;
+}
+
+int movie_context_size(void)
+{
+  return sizeof(movie.session) + sizeof(movie.status) + sizeof(movie.length) + sizeof(movie.pos) +
+         sizeof(movie.frame) + sizeof(movie.frames) + sizeof(movie.pad) + sizeof(movie.analog);
+}
+
+/* frames emulated after the snapshot was saved are recorded or replayed again, unless */
+/* movie has been started or stopped since then                                        */
+int movie_context_load(uint8 *state)
+{
+  uint32 session;
+  int bufferptr = 0;
+
+  load_param(&session, sizeof(session));
+  if (session != movie.session)
+  {
+    return movie_context_size();
+  }
+
+  load_param(&movie.status, sizeof(movie.status));
+  load_param(&movie.length, sizeof(movie.length));
+  load_param(&movie.pos, sizeof(movie.pos));
+  load_param(&movie.frame, sizeof(movie.frame));
+  load_param(&movie.frames, sizeof(movie.frames));
+  load_param(movie.pad, sizeof(movie.pad));
+  load_param(movie.analog, sizeof(movie.analog));
+
+  return bufferptr;
+}
+
+int movie_status(void)
+{
+  return movie.status;
+}
+
+int movie_frame(void)
+{
+  return movie.frame;
+}
+
+int movie_length(void)
+{
+  return movie.frames;
+}
+
+int movie_data(unsigned char **data)
+{
+  if (movie.status == MOVIE_RECORD)
+  {
+    write_dword(movie.data, MOVIE_OFS_FRAMES, movie.frames);
+  }
+
+  *data = movie.data;
+  return movie.length;
+}
+
+/* replaces osd_input_update() calls from emulation loop */
+void movie_input_update(void)
+{
+  int i;
+  uint8 mask = 0;
+  uint8 *ptr;
+
+  /* frontend inputs are always updated (hotkeys, input devices not controlled by emulation...) */
+  osd_input_update();
+
+  switch (movie.status)
+  {
+    case MOVIE_RECORD:
+    {
+      if (!movie_reserve(1 + MAX_DEVICES * MOVIE_INPUT_SIZE))
+      {
+        /* out of memory, keep what was recorded so far */
+        movie_stop();
+        return;
+      }
+
+      /* only inputs that changed since last frame are recorded */
+      ptr = &movie.data[movie.length + 1];
+      for (i = 0; i < MAX_DEVICES; i++)
+      {
+        if ((input.pad[i] != movie.pad[i]) || (input.analog[i][0] != movie.analog[i][0]) || (input.analog[i][1] != movie.analog[i][1]))
+        {
+          movie.pad[i] = input.pad[i];
+          movie.analog[i][0] = input.analog[i][0];
+          movie.analog[i][1] = input.analog[i][1];
+          write_word(ptr, 0, movie.pad[i]);
+          write_word(ptr, 2, movie.analog[i][0]);
+          write_word(ptr, 4, movie.analog[i][1]);
+          ptr += MOVIE_INPUT_SIZE;
+          mask |= (1 << i);
+        }
+      }
+
+      movie.data[movie.length] = mask;
+      movie.length = ptr - movie.data;
+      movie.frames++;
+      movie.frame++;
+      return;
+    }
+
+    case MOVIE_PLAY:
+    {
+      if (movie.pos < movie.length)
+      {
+        mask = movie.data[movie.pos++];
+      }
+
+      for (i = 0; i < MAX_DEVICES; i++)
+      {
+        if ((mask & (1 << i)) && (movie.pos + MOVIE_INPUT_SIZE <= movie.length))
+        {
+          ptr = &movie.data[movie.pos];
+          movie.pad[i] = read_word(ptr, 0);
+          movie.analog[i][0] = (int16)read_word(ptr, 2);
+          movie.analog[i][1] = (int16)read_word(ptr, 4);
+          movie.pos += MOVIE_INPUT_SIZE;
+        }
+
+        input.pad[i] = movie.pad[i];
+        input.analog[i][0] = movie.analog[i][0];
+        input.analog[i][1] = movie.analog[i][1];
+      }
+
+      /* inputs are given back to frontend once all frames have been replayed */
+      if (++movie.frame >= movie.frames)
+      {
+        movie.status = MOVIE_IDLE;
+      }
+      return;
+    }
+
+    default:
+      return;
+  }
+}
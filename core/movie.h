@@ -0,0 +1,69 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Movie recording & playback (deterministic input replay)
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _MOVIE_H_
+#define _MOVIE_H_
+
+/* A movie holds the starting point of a session (power-on or savestate) followed by
+   per-frame inputs (input.pad & input.analog) as they were set by osd_input_update().
+   Since emulation is deterministic, replaying these inputs from the same starting point
+   reproduces the recorded session bit-exactly, without any frontend input attached. */
+
+#define MOVIE_SIGNATURE "GPGXMOVI"
+#define MOVIE_VERSION   1
+
+/* movie status */
+#define MOVIE_IDLE      0
+#define MOVIE_RECORD    1
+#define MOVIE_PLAY      2
+
+/* Function prototypes */
+extern int movie_record(int from_state);
+extern int movie_play(const unsigned char *data, int size);
+extern void movie_stop(void);
+extern void movie_shutdown(void);
+extern int movie_status(void);
+extern int movie_frame(void);
+extern int movie_length(void);
+extern int movie_data(unsigned char **data);
+extern void movie_input_update(void);
+extern int movie_context_save(uint8 *state);
+extern int movie_context_load(uint8 *state);
+extern int movie_context_size(void);
+
+#endif
@@ -86,9 +86,131 @@ void md_ntsc_init( md_ntsc_t* ntsc, md_ntsc_setup_t const* setup )
 }
 
 #ifndef CUSTOM_BLITTER
+#if defined(__GNUC__) && ((__GNUC__ >= 9) || defined(__clang__)) && (defined(__SSE2__) || defined(__ARM_NEON))
+/* Vectorized blitter (GCC vector extensions): the eight output pixels of each chunk are computed at
+once, using the same integer operations as MD_NTSC_RGB_OUT, so that output is identical. Only the
+low 32 bits of kernel entries are used since higher bits never reach output pixels. */
+#define MD_NTSC_VECTOR
+
+typedef unsigned int md_ntsc_v8_t __attribute__((vector_size(32)));
+typedef unsigned short md_ntsc_v8s_t __attribute__((vector_size(16)));
+typedef md_ntsc_rgb_t md_ntsc_vrgb_t __attribute__((vector_size(8 * sizeof(md_ntsc_rgb_t))));
+
+#ifdef __clang__
+#define MD_NTSC_SHUFFLE( a, b, i0, i1, i2, i3, i4, i5, i6, i7 ) \
+  __builtin_shufflevector( a, b, i0, i1, i2, i3, i4, i5, i6, i7 )
+#else
+#define MD_NTSC_SHUFFLE( a, b, i0, i1, i2, i3, i4, i5, i6, i7 ) \
+  __builtin_shuffle( a, b, (md_ntsc_v8_t) { i0, i1, i2, i3, i4, i5, i6, i7 } )
+#endif
+
+/* eight consecutive kernel entries */
+#define MD_NTSC_LOAD( kernel ) ({\
+  md_ntsc_vrgb_t in_;\
+  memcpy( &in_, (kernel), sizeof(in_) );\
+  __builtin_convertvector( in_, md_ntsc_v8_t );\
+})
+
+static __inline__ md_ntsc_rgb_t const* md_ntsc_kernel( md_ntsc_t const* ntsc, unsigned color )
+{
+  return MD_NTSC_IN_FORMAT( ntsc, color );
+}
+
+/* output pixel x = kernel0 [x] + kernel1 [(x+6)%8+16] + kernel2 [(x+4)%8] + kernel3 [(x+2)%8+16]
+                  + kernelx0 [x+8] + kernelx1 [(x+6)%8+24] + kernelx2 [(x+4)%8+8] + kernelx3 [(x+2)%8+24]
+with kernel j (and kernelx j) being updated before output pixel 2*j */
+static __inline__ void md_ntsc_blit_vector( md_ntsc_t const* ntsc, MD_NTSC_IN_T const* table, unsigned char* input,
+                                            int in_width, void* out, int depth )
+{
+  int n = in_width / md_ntsc_in_chunk;
+  unsigned const border = table[0];
+  md_ntsc_rgb_t const* k0 = md_ntsc_kernel( ntsc, border );
+  md_ntsc_rgb_t const* k1 = md_ntsc_kernel( ntsc, MD_NTSC_ADJ_IN( table[input[0]] ) );
+  md_ntsc_rgb_t const* k2 = md_ntsc_kernel( ntsc, MD_NTSC_ADJ_IN( table[input[1]] ) );
+  md_ntsc_rgb_t const* k3 = md_ntsc_kernel( ntsc, MD_NTSC_ADJ_IN( table[input[2]] ) );
+  md_ntsc_rgb_t const* kx;
+  md_ntsc_v8_t t0, t1, t2, t3, raw, clamp, sub;
+
+  /* contributions of kernels 1-3 to first pixels of first chunk */
+  t1 = MD_NTSC_LOAD( k1 + 16 ) + MD_NTSC_LOAD( k0 + 24 );
+  t1 = MD_NTSC_SHUFFLE( t1, t1, 6, 7, 0, 1, 2, 3, 4, 5 );
+  t2 = MD_NTSC_LOAD( k2 ) + MD_NTSC_LOAD( k0 + 8 );
+  t2 = MD_NTSC_SHUFFLE( t2, t2, 4, 5, 6, 7, 0, 1, 2, 3 );
+  t3 = MD_NTSC_LOAD( k3 + 16 ) + MD_NTSC_LOAD( k0 + 24 );
+  t3 = MD_NTSC_SHUFFLE( t3, t3, 2, 3, 4, 5, 6, 7, 0, 1 );
+
+  input += 3;
+
+  while ( n-- )
+  {
+    /* final chunk only has one input pixel left */
+    unsigned c0 = table[input[0]];
+    unsigned c1 = n ? table[input[1]] : border;
+    unsigned c2 = n ? table[input[2]] : border;
+    unsigned c3 = n ? table[input[3]] : border;
+    input += 4;
+
+    kx = k0;
+    k0 = md_ntsc_kernel( ntsc, MD_NTSC_ADJ_IN( c0 ) );
+    t0 = MD_NTSC_LOAD( k0 ) + MD_NTSC_LOAD( kx + 8 );
+    raw = t0;
+
+    kx = k1;
+    k1 = md_ntsc_kernel( ntsc, MD_NTSC_ADJ_IN( c1 ) );
+    t0 = MD_NTSC_LOAD( k1 + 16 ) + MD_NTSC_LOAD( kx + 24 );
+    t0 = MD_NTSC_SHUFFLE( t0, t0, 6, 7, 0, 1, 2, 3, 4, 5 );
+    raw += MD_NTSC_SHUFFLE( t1, t0, 0, 1, 10, 11, 12, 13, 14, 15 );
+    t1 = t0;
+
+    kx = k2;
+    k2 = md_ntsc_kernel( ntsc, MD_NTSC_ADJ_IN( c2 ) );
+    t0 = MD_NTSC_LOAD( k2 ) + MD_NTSC_LOAD( kx + 8 );
+    t0 = MD_NTSC_SHUFFLE( t0, t0, 4, 5, 6, 7, 0, 1, 2, 3 );
+    raw += MD_NTSC_SHUFFLE( t2, t0, 0, 1, 2, 3, 12, 13, 14, 15 );
+    t2 = t0;
+
+    kx = k3;
+    k3 = md_ntsc_kernel( ntsc, MD_NTSC_ADJ_IN( c3 ) );
+    t0 = MD_NTSC_LOAD( k3 + 16 ) + MD_NTSC_LOAD( kx + 24 );
+    t0 = MD_NTSC_SHUFFLE( t0, t0, 2, 3, 4, 5, 6, 7, 0, 1 );
+    raw += MD_NTSC_SHUFFLE( t3, t0, 0, 1, 2, 3, 4, 5, 14, 15 );
+    t3 = t0;
+
+    /* MD_NTSC_CLAMP_ */
+    sub = (raw >> 9) & (unsigned) md_ntsc_clamp_mask;
+    clamp = (unsigned) md_ntsc_clamp_add - sub;
+    raw |= clamp;
+    clamp -= sub;
+    raw &= clamp;
+
+    /* MD_NTSC_RGB_OUT_ */
+    if ( depth == 32 )
+    {
+      raw = 0xFF000000 | ((raw >> 5) & 0xFF0000) | ((raw >> 3) & 0x00FF00) | ((raw >> 1) & 0x0000FF);
+      memcpy( out, &raw, sizeof(raw) );
+      out = (char*) out + sizeof(raw);
+    }
+    else
+    {
+      md_ntsc_v8s_t rgb;
+      if ( depth == 15 )
+        raw = ((raw >> 14) & 0x7C00) | ((raw >> 9) & 0x03E0) | ((raw >> 4) & 0x001F);
+      else
+        raw = ((raw >> 13) & 0xF800) | ((raw >> 8) & 0x07E0) | ((raw >> 4) & 0x001F);
+      rgb = __builtin_convertvector( raw, md_ntsc_v8s_t );
+      memcpy( out, &rgb, sizeof(rgb) );
+      out = (char*) out + sizeof(rgb);
+    }
+  }
+}
+#endif
+
 void md_ntsc_blit( md_ntsc_t const* ntsc, MD_NTSC_IN_T const* table, unsigned char* input,
                    int in_width, int vline)
 {
+#ifdef MD_NTSC_VECTOR
+  md_ntsc_blit_vector( ntsc, table, input, in_width, &bitmap.data[(vline * bitmap.pitch)], MD_NTSC_OUT_DEPTH );
+#else
   int const chunk_count = in_width / md_ntsc_in_chunk - 1;
 
   /* use palette entry 0 for unused pixels */
@@ -139,5 +261,65 @@ void md_ntsc_blit( md_ntsc_t const* ntsc, MD_NTSC_IN_T const* table, unsigned ch
   MD_NTSC_COLOR_IN( 3, ntsc, border );
   MD_NTSC_RGB_OUT( 6, *line_out++ );
   MD_NTSC_RGB_OUT( 7, *line_out++ );
+#endif
+}
+
+void md_ntsc_blit_32( md_ntsc_t const* ntsc, MD_NTSC_IN_T const* table, unsigned char* input,
+                   int in_width, int vline)
+{
+#ifdef MD_NTSC_VECTOR
+  md_ntsc_blit_vector( ntsc, table, input, in_width, &bitmap.data[(vline * bitmap.pitch)], 32 );
+#else
+  int const chunk_count = in_width / md_ntsc_in_chunk - 1;
+
+  /* use palette entry 0 for unused pixels */
+  MD_NTSC_IN_T border = table[0];
+
+  MD_NTSC_BEGIN_ROW( ntsc, border,
+        MD_NTSC_ADJ_IN( table[*input++] ),
+        MD_NTSC_ADJ_IN( table[*input++] ),
+        MD_NTSC_ADJ_IN( table[*input++] ) );
+
+  unsigned int* restrict line_out  = (unsigned int*)(&bitmap.data[(vline * bitmap.pitch)]);
+
+  int n;
+
+  for ( n = chunk_count; n; --n )
+  {
+    /* order of input and output pixels must not be altered */
+    MD_NTSC_COLOR_IN( 0, ntsc, MD_NTSC_ADJ_IN( table[*input++] ) );
+    MD_NTSC_RGB32_OUT( 0, *line_out++ );
+    MD_NTSC_RGB32_OUT( 1, *line_out++ );
+
+    MD_NTSC_COLOR_IN( 1, ntsc, MD_NTSC_ADJ_IN( table[*input++] ) );
+    MD_NTSC_RGB32_OUT( 2, *line_out++ );
+    MD_NTSC_RGB32_OUT( 3, *line_out++ );
+
+    MD_NTSC_COLOR_IN( 2, ntsc, MD_NTSC_ADJ_IN( table[*input++] ) );
+    MD_NTSC_RGB32_OUT( 4, *line_out++ );
+    MD_NTSC_RGB32_OUT( 5, *line_out++ );
+
+    MD_NTSC_COLOR_IN( 3, ntsc, MD_NTSC_ADJ_IN( table[*input++] ) );
+    MD_NTSC_RGB32_OUT( 6, *line_out++ );
+    MD_NTSC_RGB32_OUT( 7, *line_out++ );
+  }
+
+  /* finish final pixels */
+  MD_NTSC_COLOR_IN( 0, ntsc, MD_NTSC_ADJ_IN( table[*input++] ) );
+  MD_NTSC_RGB32_OUT( 0, *line_out++ );
+  MD_NTSC_RGB32_OUT( 1, *line_out++ );
+
+  MD_NTSC_COLOR_IN( 1, ntsc, border );
+  MD_NTSC_RGB32_OUT( 2, *line_out++ );
+  MD_NTSC_RGB32_OUT( 3, *line_out++ );
+
+  MD_NTSC_COLOR_IN( 2, ntsc, border );
+  MD_NTSC_RGB32_OUT( 4, *line_out++ );
+  MD_NTSC_RGB32_OUT( 5, *line_out++ );
+
+  MD_NTSC_COLOR_IN( 3, ntsc, border );
+  MD_NTSC_RGB32_OUT( 6, *line_out++ );
+  MD_NTSC_RGB32_OUT( 7, *line_out++ );
+#endif
 }
 #endif
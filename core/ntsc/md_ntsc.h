@@ -51,6 +51,10 @@ In_row_width is the number of pixels to get to the next input row. */
 void md_ntsc_blit( md_ntsc_t const* ntsc, MD_NTSC_IN_T const* table, unsigned char* input,
     int in_width, int vline);
 
+/* Same as above with 32-bit XRGB8888 output, whatever MD_NTSC_OUT_DEPTH is. */
+void md_ntsc_blit_32( md_ntsc_t const* ntsc, MD_NTSC_IN_T const* table, unsigned char* input,
+    int in_width, int vline);
+
 /* Number of output pixels written by blitter for given input width. */
 #define MD_NTSC_OUT_WIDTH( in_width ) \
   (((in_width) - 3) / md_ntsc_in_chunk * md_ntsc_out_chunk + md_ntsc_out_chunk)
@@ -98,6 +102,15 @@ Declares variables, so must be before first statement in a block (unless you're
   MD_NTSC_RGB_OUT_( rgb_out, 0 );\
 }
 
+/* Generate 32-bit output pixel */
+#define MD_NTSC_RGB32_OUT( x, rgb_out ) {\
+  raw_ =\
+    kernel0  [x+ 0] + kernel1  [(x+6)%8+16] + kernel2  [(x+4)%8  ] + kernel3  [(x+2)%8+16] +\
+    kernelx0 [x+ 8] + kernelx1 [(x+6)%8+24] + kernelx2 [(x+4)%8+8] + kernelx3 [(x+2)%8+24];\
+  MD_NTSC_CLAMP_( raw_, 0 );\
+  MD_NTSC_RGB32_OUT_( rgb_out, 0 );\
+}
+
 
 /* private */
 enum { md_ntsc_entry_size = 2 * 16 };
@@ -147,6 +160,10 @@ struct md_ntsc_t {
    }
 #endif
 
+#define MD_NTSC_RGB32_OUT_( rgb_out, x ) {\
+    rgb_out = 0xFF000000|(raw_>>(5-x)&0xFF0000)|(raw_>>(3-x)&0x00FF00)|(raw_>>(1-x)&0x0000FF);\
+   }
+
 #ifdef __cplusplus
 }
 #endif
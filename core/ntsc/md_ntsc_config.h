@@ -3,7 +3,7 @@
 #ifndef MD_NTSC_CONFIG_H
 #define MD_NTSC_CONFIG_H
 
-/* Format of source & output pixels (RGB555 or RGB565 only)*/
+/* Format of source & output pixels (RGB555 or RGB565 only, md_ntsc_blit_32 always outputs XRGB8888) */
 #ifdef USE_15BPP_RENDERING
 #define MD_NTSC_IN_FORMAT MD_NTSC_RGB15
 #define MD_NTSC_OUT_DEPTH 15
@@ -85,9 +85,126 @@ void sms_ntsc_init( sms_ntsc_t* ntsc, sms_ntsc_setup_t const* setup )
 }
 
 #ifndef CUSTOM_BLITTER
+#if defined(__GNUC__) && ((__GNUC__ >= 9) || defined(__clang__)) && (defined(__SSE2__) || defined(__ARM_NEON))
+/* Vectorized blitter (GCC vector extensions): the seven output pixels of each chunk are computed at
+once (in eight lanes), using the same integer operations as SMS_NTSC_RGB_OUT, so that output is
+identical. Only the low 32 bits of kernel entries are used since higher bits never reach output pixels. */
+#define SMS_NTSC_VECTOR
+
+typedef unsigned int sms_ntsc_v8_t __attribute__((vector_size(32)));
+typedef unsigned short sms_ntsc_v8s_t __attribute__((vector_size(16)));
+typedef sms_ntsc_rgb_t sms_ntsc_vrgb_t __attribute__((vector_size(8 * sizeof(sms_ntsc_rgb_t))));
+
+#ifdef __clang__
+#define SMS_NTSC_SHUFFLE( a, b, i0, i1, i2, i3, i4, i5, i6, i7 ) \
+  __builtin_shufflevector( a, b, i0, i1, i2, i3, i4, i5, i6, i7 )
+#else
+#define SMS_NTSC_SHUFFLE( a, b, i0, i1, i2, i3, i4, i5, i6, i7 ) \
+  __builtin_shuffle( a, b, (sms_ntsc_v8_t) { i0, i1, i2, i3, i4, i5, i6, i7 } )
+#endif
+
+/* eight consecutive kernel entries */
+#define SMS_NTSC_LOAD( kernel ) ({\
+  sms_ntsc_vrgb_t in_;\
+  memcpy( &in_, (kernel), sizeof(in_) );\
+  __builtin_convertvector( in_, sms_ntsc_v8_t );\
+})
+
+static __inline__ sms_ntsc_rgb_t const* sms_ntsc_kernel( sms_ntsc_t const* ntsc, unsigned color )
+{
+  return SMS_NTSC_IN_FORMAT( ntsc, color );
+}
+
+/* output pixel x = kernel0 [x] + kernel1 [(x+5)%7+14] + kernel2 [(x+3)%7+28]
+                  + kernelx0 [x+7] + kernelx1 [(x+5)%7+21] + kernelx2 [(x+3)%7+35]
+with kernel j (and kernelx j) being updated before output pixel 2*j. Kernel 2 entries are loaded
+one entry earlier so that the last load does not read past the end of the kernel. */
+static __inline__ void sms_ntsc_blit_vector( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* table, unsigned char* input,
+                                             int in_width, void* out, int depth )
+{
+  int n = in_width / sms_ntsc_in_chunk;
+
+  /* handle extra 0, 1, or 2 pixels by placing them at beginning of row */
+  int const in_extra = in_width - n * sms_ntsc_in_chunk;
+  unsigned const extra2 = (unsigned) -(in_extra >> 1 & 1); /* (unsigned) -1 = ~0 */
+  unsigned const extra1 = (unsigned) -(in_extra & 1) | extra2;
+
+  unsigned const border = table[0];
+  sms_ntsc_rgb_t const* k0 = sms_ntsc_kernel( ntsc, border );
+  sms_ntsc_rgb_t const* k1 = sms_ntsc_kernel( ntsc, (SMS_NTSC_ADJ_IN( table[input[0]] )) & extra2 );
+  sms_ntsc_rgb_t const* k2 = sms_ntsc_kernel( ntsc, (SMS_NTSC_ADJ_IN( table[input[extra2 & 1]] )) & extra1 );
+  sms_ntsc_rgb_t const* kx;
+  sms_ntsc_v8_t t0, t1, t2, raw, clamp, sub;
+
+  /* contributions of kernels 1-2 to first pixels of first chunk */
+  t1 = SMS_NTSC_LOAD( k1 + 14 ) + SMS_NTSC_LOAD( k0 + 21 );
+  t1 = SMS_NTSC_SHUFFLE( t1, t1, 5, 6, 0, 1, 2, 3, 4, 5 );
+  t2 = SMS_NTSC_LOAD( k2 + 27 ) + SMS_NTSC_LOAD( k0 + 34 );
+  t2 = SMS_NTSC_SHUFFLE( t2, t2, 4, 5, 6, 7, 1, 2, 3, 4 );
+
+  input += in_extra;
+
+  /* final chunk only uses unused pixels */
+  for ( n++; n; --n )
+  {
+    unsigned c0 = (n > 1) ? SMS_NTSC_ADJ_IN( table[input[0]] ) : border;
+    unsigned c1 = (n > 1) ? SMS_NTSC_ADJ_IN( table[input[1]] ) : border;
+    unsigned c2 = (n > 1) ? SMS_NTSC_ADJ_IN( table[input[2]] ) : border;
+    input += 3;
+
+    kx = k0;
+    k0 = sms_ntsc_kernel( ntsc, c0 );
+    raw = SMS_NTSC_LOAD( k0 ) + SMS_NTSC_LOAD( kx + 7 );
+
+    kx = k1;
+    k1 = sms_ntsc_kernel( ntsc, c1 );
+    t0 = SMS_NTSC_LOAD( k1 + 14 ) + SMS_NTSC_LOAD( kx + 21 );
+    t0 = SMS_NTSC_SHUFFLE( t0, t0, 5, 6, 0, 1, 2, 3, 4, 5 );
+    raw += SMS_NTSC_SHUFFLE( t1, t0, 0, 1, 10, 11, 12, 13, 14, 15 );
+    t1 = t0;
+
+    kx = k2;
+    k2 = sms_ntsc_kernel( ntsc, c2 );
+    t0 = SMS_NTSC_LOAD( k2 + 27 ) + SMS_NTSC_LOAD( kx + 34 );
+    t0 = SMS_NTSC_SHUFFLE( t0, t0, 4, 5, 6, 7, 1, 2, 3, 4 );
+    raw += SMS_NTSC_SHUFFLE( t2, t0, 0, 1, 2, 3, 12, 13, 14, 15 );
+    t2 = t0;
+
+    /* SMS_NTSC_CLAMP_ */
+    sub = (raw >> 9) & (unsigned) sms_ntsc_clamp_mask;
+    clamp = (unsigned) sms_ntsc_clamp_add - sub;
+    raw |= clamp;
+    clamp -= sub;
+    raw &= clamp;
+
+    /* SMS_NTSC_RGB_OUT_ (last lane is not output) */
+    if ( depth == 32 )
+    {
+      raw = 0xFF000000 | ((raw >> 5) & 0xFF0000) | ((raw >> 3) & 0x00FF00) | ((raw >> 1) & 0x0000FF);
+      memcpy( out, &raw, sms_ntsc_out_chunk * sizeof(unsigned int) );
+      out = (unsigned int*) out + sms_ntsc_out_chunk;
+    }
+    else
+    {
+      sms_ntsc_v8s_t rgb;
+      if ( depth == 15 )
+        raw = ((raw >> 14) & 0x7C00) | ((raw >> 9) & 0x03E0) | ((raw >> 4) & 0x001F);
+      else
+        raw = ((raw >> 13) & 0xF800) | ((raw >> 8) & 0x07E0) | ((raw >> 4) & 0x001F);
+      rgb = __builtin_convertvector( raw, sms_ntsc_v8s_t );
+      memcpy( out, &rgb, sms_ntsc_out_chunk * sizeof(unsigned short) );
+      out = (unsigned short*) out + sms_ntsc_out_chunk;
+    }
+  }
+}
+#endif
+
 void sms_ntsc_blit( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* table, unsigned char* input,
                     int in_width, int vline)
 {
+#ifdef SMS_NTSC_VECTOR
+  sms_ntsc_blit_vector( ntsc, table, input, in_width, &bitmap.data[(vline * bitmap.pitch)], SMS_NTSC_OUT_DEPTH );
+#else
   int n;
   int const chunk_count = in_width / sms_ntsc_in_chunk;
 
@@ -137,5 +254,64 @@ void sms_ntsc_blit( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* table, unsigned
   SMS_NTSC_RGB_OUT( 4, *line_out++ );
   SMS_NTSC_RGB_OUT( 5, *line_out++ );
   SMS_NTSC_RGB_OUT( 6, *line_out++ );
+#endif
+}
+
+void sms_ntsc_blit_32( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* table, unsigned char* input,
+                    int in_width, int vline)
+{
+#ifdef SMS_NTSC_VECTOR
+  sms_ntsc_blit_vector( ntsc, table, input, in_width, &bitmap.data[(vline * bitmap.pitch)], 32 );
+#else
+  int n;
+  int const chunk_count = in_width / sms_ntsc_in_chunk;
+
+  /* handle extra 0, 1, or 2 pixels by placing them at beginning of row */
+  int const in_extra = in_width - chunk_count * sms_ntsc_in_chunk;
+  unsigned const extra2 = (unsigned) -(in_extra >> 1 & 1); /* (unsigned) -1 = ~0 */
+  unsigned const extra1 = (unsigned) -(in_extra & 1) | extra2;
+
+  /* use palette entry 0 for unused pixels */
+  SMS_NTSC_IN_T border = table[0];
+
+  SMS_NTSC_BEGIN_ROW( ntsc, border,
+      (SMS_NTSC_ADJ_IN( table[input[0]] )) & extra2,
+      (SMS_NTSC_ADJ_IN( table[input[extra2 & 1]] )) & extra1 );
+
+  unsigned int* line_out  = (unsigned int*)(&bitmap.data[(vline * bitmap.pitch)]);
+
+  input += in_extra;
+
+  for ( n = chunk_count; n; --n )
+  {
+    /* order of input and output pixels must not be altered */
+    SMS_NTSC_COLOR_IN( 0, ntsc, SMS_NTSC_ADJ_IN( table[*input++] ) );
+    SMS_NTSC_RGB32_OUT( 0, *line_out++ );
+    SMS_NTSC_RGB32_OUT( 1, *line_out++ );
+    
+    SMS_NTSC_COLOR_IN( 1, ntsc, SMS_NTSC_ADJ_IN( table[*input++] ) );
+    SMS_NTSC_RGB32_OUT( 2, *line_out++ );
+    SMS_NTSC_RGB32_OUT( 3, *line_out++ );
+      
+    SMS_NTSC_COLOR_IN( 2, ntsc, SMS_NTSC_ADJ_IN( table[*input++] ) );
+    SMS_NTSC_RGB32_OUT( 4, *line_out++ );
+    SMS_NTSC_RGB32_OUT( 5, *line_out++ );
+    SMS_NTSC_RGB32_OUT( 6, *line_out++ );
+  }
+
+  /* finish final pixels */
+  SMS_NTSC_COLOR_IN( 0, ntsc, border );
+  SMS_NTSC_RGB32_OUT( 0, *line_out++ );
+  SMS_NTSC_RGB32_OUT( 1, *line_out++ );
+
+  SMS_NTSC_COLOR_IN( 1, ntsc, border );
+  SMS_NTSC_RGB32_OUT( 2, *line_out++ );
+  SMS_NTSC_RGB32_OUT( 3, *line_out++ );
+
+  SMS_NTSC_COLOR_IN( 2, ntsc, border );
+  SMS_NTSC_RGB32_OUT( 4, *line_out++ );
+  SMS_NTSC_RGB32_OUT( 5, *line_out++ );
+  SMS_NTSC_RGB32_OUT( 6, *line_out++ );
+#endif
 }
 #endif
@@ -51,6 +51,10 @@ In_row_width is the number of pixels to get to the next input row. */
 void sms_ntsc_blit( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* table, unsigned char* input,
     int in_width, int vline);
 
+/* Same as above with 32-bit XRGB8888 output, whatever SMS_NTSC_OUT_DEPTH is. */
+void sms_ntsc_blit_32( sms_ntsc_t const* ntsc, SMS_NTSC_IN_T const* table, unsigned char* input,
+    int in_width, int vline);
+
 /* Number of output pixels written by blitter for given input width. */
 #define SMS_NTSC_OUT_WIDTH( in_width ) \
   (((in_width) / sms_ntsc_in_chunk + 1) * sms_ntsc_out_chunk)
@@ -85,6 +89,15 @@ Declares variables, so must be before first statement in a block (unless you're
   SMS_NTSC_RGB_OUT_( rgb_out, 0 );\
 }
 
+/* Generate 32-bit output pixel */
+#define SMS_NTSC_RGB32_OUT( x, rgb_out ) {\
+  raw_ =\
+    kernel0  [x       ] + kernel1  [(x+12)%7+14] + kernel2  [(x+10)%7+28] +\
+    kernelx0 [(x+7)%14] + kernelx1 [(x+ 5)%7+21] + kernelx2 [(x+ 3)%7+35];\
+  SMS_NTSC_CLAMP_( raw_, 0 );\
+  SMS_NTSC_RGB32_OUT_( rgb_out, 0 );\
+}
+
 /* private */
 enum { sms_ntsc_entry_size = 3 * 14 };
 typedef unsigned long sms_ntsc_rgb_t;
@@ -147,6 +160,10 @@ struct sms_ntsc_t {
    }
 #endif
 
+#define SMS_NTSC_RGB32_OUT_( rgb_out, x ) {\
+    rgb_out = 0xFF000000|(raw_>>(5-x)&0xFF0000)|(raw_>>(3-x)&0x00FF00)|(raw_>>(1-x)&0x0000FF);\
+   }
+
 #ifdef __cplusplus
   }
 #endif
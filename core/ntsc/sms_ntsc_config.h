@@ -3,7 +3,7 @@
 #ifndef SMS_NTSC_CONFIG_H
 #define SMS_NTSC_CONFIG_H
 
-/* Format of source & output pixels (RGB555 or RGB565 only) */
+/* Format of source & output pixels (RGB555 or RGB565 only, sms_ntsc_blit_32 always outputs XRGB8888) */
 #ifdef USE_15BPP_RENDERING
 #define SMS_NTSC_IN_FORMAT SMS_NTSC_RGB15
 #define SMS_NTSC_OUT_DEPTH 15
@@ -0,0 +1,384 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Rewind buffer (delta-compressed savestate history)
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+/* snapshots are compared in blocks, only modified blocks are encoded */
+#define REWIND_BLOCK  256
+
+/* per-entry overhead in ring buffer (leading & trailing entry length) */
+#define REWIND_ENTRY_OVERHEAD 8
+
+static THREAD_LOCAL struct
+{
+  uint8 *ring;          /* ring buffer holding deltas */
+  uint32 size;          /* ring buffer size */
+  uint32 head;          /* write offset (after most recent delta) */
+  uint32 tail;          /* read offset (oldest delta) */
+  uint32 used;          /* ring buffer usage */
+  int deltas;           /* number of deltas in ring buffer */
+  uint8 *current;       /* most recent snapshot */
+  uint8 *next;          /* snapshot being recorded (without memory regions) */
+  uint8 *delta;         /* delta being encoded / decoded */
+  int capacity;         /* snapshot buffers size (in bytes) */
+  int current_size;     /* most recent snapshot size (in bytes) */
+  int regions;          /* number of memory regions in most recent snapshot */
+  uint32 region_offset[STATE_REGIONS_MAX];
+  uint32 region_size[STATE_REGIONS_MAX];
+  int valid;            /* most recent snapshot can be restored */
+} hist;
+
+static void ring_write(const uint8 *src, uint32 length)
+{
+  uint32 n = hist.size - hist.head;
+  if (n > length) n = length;
+  memcpy(&hist.ring[hist.head], src, n);
+  memcpy(hist.ring, src + n, length - n);
+  hist.head = (hist.head + length) % hist.size;
+  hist.used += length;
+}
+
+static void ring_read(uint32 offset, uint8 *dst, uint32 length)
+{
+  uint32 n;
+  offset %= hist.size;
+  n = hist.size - offset;
+  if (n > length) n = length;
+  memcpy(dst, &hist.ring[offset], n);
+  memcpy(dst + n, hist.ring, length - n);
+}
+
+static void ring_drop_oldest(void)
+{
+  uint32 length;
+  ring_read(hist.tail, (uint8 *)&length, 4);
+  hist.tail = (hist.tail + length + REWIND_ENTRY_OVERHEAD) % hist.size;
+  hist.used -= (length + REWIND_ENTRY_OVERHEAD);
+  hist.deltas--;
+}
+
+/* encode XOR difference between two blocks as (unchanged bytes, changed bytes) runs */
+static uint8 *block_encode(const uint8 *older, const uint8 *newer, int length, uint8 *out)
+{
+  int i = 0;
+
+  while (i < length)
+  {
+    int skip = 0, count = 0;
+
+    while ((i < length) && (older[i] == newer[i]) && (skip < 255))
+    {
+      skip++;
+      i++;
+    }
+
+    /* unchanged bytes between changed ones are cheaper to store than a new run */
+    while ((i < length) && (count < 255) && ((older[i] != newer[i]) ||
+           ((i + 1 < length) && (older[i + 1] != newer[i + 1]))))
+    {
+      out[2 + count++] = older[i] ^ newer[i];
+      i++;
+    }
+
+    out[0] = skip;
+    out[1] = count;
+    out += 2 + count;
+  }
+
+  return out;
+}
+
+/* encode modified blocks of a snapshot area as (offset, length, runs) records, most recent snapshot is updated */
+static uint8 *delta_encode(uint32 offset, const uint8 *newer, uint32 length, uint8 *out)
+{
+  uint8 *older = &hist.current[offset];
+  uint8 *record = NULL;
+  uint16 size = 0;
+
+  while (length)
+  {
+    uint16 n = (length < REWIND_BLOCK) ? length : REWIND_BLOCK;
+
+    if (memcmp(older, newer, n))
+    {
+      if (record && (size <= (0xffff - REWIND_BLOCK)))
+      {
+        /* consecutive modified blocks share the same record */
+        size += n;
+      }
+      else
+      {
+        record = out;
+        size = n;
+        memcpy(record, &offset, 4);
+        out += 6;
+      }
+      memcpy(record + 4, &size, 2);
+      out = block_encode(older, newer, n, out);
+      memcpy(older, newer, n);
+    }
+    else
+    {
+      record = NULL;
+    }
+
+    older += n;
+    newer += n;
+    offset += n;
+    length -= n;
+  }
+
+  return out;
+}
+
+/* apply delta to a snapshot */
+static void delta_decode(uint8 *data, const uint8 *in, uint32 length)
+{
+  const uint8 *end = in + length;
+
+  while (in < end)
+  {
+    uint32 offset;
+    uint16 n;
+    uint8 *ptr;
+    int left;
+
+    memcpy(&offset, in, 4);
+    memcpy(&n, in + 4, 2);
+    in += 6;
+    ptr = &data[offset];
+
+    for (left = n; left > 0; left -= (in[0] + in[1]), in += 2 + in[1])
+    {
+      int i;
+      ptr += in[0];
+      for (i = 0; i < in[1]; i++)
+      {
+        *ptr++ ^= in[2 + i];
+      }
+    }
+  }
+}
+
+/* snapshot buffers are sized for current hardware configuration (see state_size) */
+static int snapshot_alloc(void)
+{
+  int size = state_size();
+
+  if (size > hist.capacity)
+  {
+    free(hist.current);
+    free(hist.next);
+    free(hist.delta);
+
+    /* worst case delta (every other byte modified) */
+    hist.delta = malloc(size * 2);
+    hist.current = malloc(size);
+    hist.next = malloc(size);
+    hist.capacity = size;
+    hist.valid = 0;
+
+    if (!hist.delta || !hist.current || !hist.next)
+    {
+      hist.capacity = 0;
+    }
+  }
+
+  return (size > 0) && hist.capacity;
+}
+
+int rewind_init(unsigned int size)
+{
+  rewind_shutdown();
+
+  hist.ring = malloc(size);
+
+  if (!hist.ring || (size < REWIND_ENTRY_OVERHEAD))
+  {
+    rewind_shutdown();
+    return 0;
+  }
+
+  hist.size = size;
+  rewind_reset();
+  return 1;
+}
+
+void rewind_shutdown(void)
+{
+  free(hist.ring);
+  free(hist.current);
+  free(hist.next);
+  free(hist.delta);
+  memset(&hist, 0, sizeof(hist));
+}
+
+void rewind_reset(void)
+{
+  hist.head = hist.tail = hist.used = 0;
+  hist.deltas = 0;
+  hist.valid = 0;
+}
+
+int rewind_push(void)
+{
+  t_state_region regions[STATE_REGIONS_MAX];
+  int i, count = STATE_REGIONS_MAX;
+  uint32 offset, length;
+  int size, layout;
+  uint8 *ptr;
+
+  if (!hist.ring || !snapshot_alloc())
+  {
+    return 0;
+  }
+
+  /* take new snapshot, memory regions are compared in place */
+  size = state_snapshot_save_regions(hist.next, regions, &count);
+  if (!size)
+  {
+    return 0;
+  }
+
+  layout = (size == hist.current_size) && (count == hist.regions);
+  for (i = 0; i < count; i++)
+  {
+    offset = regions[i].dst - hist.next;
+    layout &= (offset == hist.region_offset[i]) && (regions[i].size == hist.region_size[i]);
+    hist.region_offset[i] = offset;
+    hist.region_size[i] = regions[i].size;
+  }
+
+  if (!hist.valid || !layout)
+  {
+    /* history restarts from new snapshot (also when emulated hardware has changed) */
+    rewind_reset();
+    memcpy(hist.current, hist.next, size);
+    for (i = 0; i < count; i++)
+    {
+      memcpy(&hist.current[hist.region_offset[i]], regions[i].src, regions[i].size);
+    }
+    hist.current_size = size;
+    hist.regions = count;
+    hist.valid = 1;
+    return 1;
+  }
+
+  /* backward delta, snapshot data and memory regions alternate */
+  ptr = hist.delta;
+  offset = 0;
+  for (i = 0; i <= count; i++)
+  {
+    uint32 end = (i < count) ? hist.region_offset[i] : (uint32)size;
+    ptr = delta_encode(offset, &hist.next[offset], end - offset, ptr);
+    if (i < count)
+    {
+      ptr = delta_encode(end, regions[i].src, regions[i].size, ptr);
+      offset = end + regions[i].size;
+    }
+  }
+  length = ptr - hist.delta;
+
+  if ((length + REWIND_ENTRY_OVERHEAD) > hist.size)
+  {
+    /* delta does not fit: history restarts from new snapshot */
+    rewind_reset();
+    hist.valid = 1;
+    return 1;
+  }
+
+  /* discard oldest deltas if needed */
+  while ((hist.used + length + REWIND_ENTRY_OVERHEAD) > hist.size)
+  {
+    ring_drop_oldest();
+  }
+
+  ring_write((uint8 *)&length, 4);
+  ring_write(hist.delta, length);
+  ring_write((uint8 *)&length, 4);
+  hist.deltas++;
+
+  return 1;
+}
+
+int rewind_pop(void)
+{
+  uint32 length;
+
+  if (!hist.valid)
+  {
+    return 0;
+  }
+
+  /* restore most recent snapshot */
+  if (!state_snapshot_load(hist.current))
+  {
+    rewind_reset();
+    return 0;
+  }
+
+  if (!hist.deltas)
+  {
+    /* history is now empty */
+    hist.valid = 0;
+    return 1;
+  }
+
+  /* retrieve most recent delta */
+  ring_read(hist.head + hist.size - 4, (uint8 *)&length, 4);
+  ring_read(hist.head + hist.size - 4 - length, hist.delta, length);
+  hist.head = (hist.head + hist.size - length - REWIND_ENTRY_OVERHEAD) % hist.size;
+  hist.used -= (length + REWIND_ENTRY_OVERHEAD);
+  hist.deltas--;
+
+  /* previous snapshot becomes the most recent one */
+  delta_decode(hist.current, hist.delta, length);
+
+  return 1;
+}
+
+int rewind_count(void)
+{
+  /* number of snapshots that can be restored */
+  return hist.valid ? (hist.deltas + 1) : 0;
+}
+
+unsigned int rewind_usage(void)
+{
+  return hist.used;
+}
@@ -0,0 +1,59 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Rewind buffer (delta-compressed savestate history)
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _REWIND_H_
+#define _REWIND_H_
+
+/* Snapshots are kept in a ring buffer as backward deltas against the next (more recent)
+   snapshot. Only the most recent snapshot is kept in full: large memory regions (work RAM,
+   Z80 RAM, VRAM, PRG-RAM, Word-RAM, PCM RAM, SVP DRAM) are not serialized but compared in
+   place with it, in blocks, together with the remaining state. XOR difference of modified
+   blocks is stored as runs of unchanged & changed bytes, so that per-frame cost is mostly
+   a memcmp pass over emulated memory, and memory usage is proportional to what actually
+   changed. When the ring buffer is full, oldest snapshots are discarded. */
+
+/* Function prototypes */
+extern int rewind_init(unsigned int size);
+extern void rewind_shutdown(void);
+extern void rewind_reset(void);
+extern int rewind_push(void);
+extern int rewind_pop(void);
+extern int rewind_count(void);
+extern unsigned int rewind_usage(void);
+
+#endif
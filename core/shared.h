@@ -16,6 +16,8 @@
 #include "genesis.h"
 #include "vdp_ctrl.h"
 #include "vdp_render.h"
+#include "vdp_remap.h"
+#include "vdp_merge.h"
 #include "mem68k.h"
 #include "memz80.h"
 #include "membnk.h"
@@ -36,6 +38,8 @@
 #include "areplay.h"
 #include "svp.h"
 #include "state.h"
+#include "rewind.h"
+#include "movie.h"
 
 #endif /* _SHARED_H_ */
 
@@ -6,6 +6,8 @@
 /*  - added blip_mix_samples function (see blip_buf.h)              */
 /*  - added stereo buffer support (define #BLIP_MONO to disable)    */
 /*  - added inverted stereo output (define #BLIP_INVERT to enable)*/
+/*  - added blip_context_save & blip_context_load functions         */
+/*  - added SIMD kernels for stereo buffers (see blip_kernels)      */
 
 #include "blip_buf.h"
 
@@ -16,6 +18,19 @@
 #include <string.h>
 #include <stdlib.h>
 
+#ifndef BLIP_MONO
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BLIP_X86
+#include <immintrin.h>
+#define TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define BLIP_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 /* Library Copyright (C) 2003-2009 Shay Green. This library is free software;
 you can redistribute it and/or modify it under the terms of the GNU Lesser
 General Public License as published by the Free Software Foundation; either
@@ -87,6 +102,19 @@ struct blip_t
 #ifdef BLIP_MONO
 /* probably not totally portable */
 #define SAMPLES( blip ) ((buf_t*) ((blip) + 1))
+#else
+/* Stereo delta insertion & samples integration (see blip_kernels) */
+typedef struct
+{
+  const char* name;
+  void (*add_delta)( buf_t* out_l, buf_t* out_r, int phase, int interp, int delta_l, int delta_r );
+  void (*mix)( short out [], int integrator [2], buf_t const* in_l [], buf_t const* in_r [], int num, int count );
+} blip_kernels_t;
+
+/* selected kernels (see blip_init_kernels) */
+static blip_kernels_t const* kernels;
+
+static void blip_init_kernels( void );
 #endif
 
 /* Arithmetic (sign-preserving) right shift */
@@ -142,6 +170,7 @@ blip_t* blip_new( int size )
 	if ( m )
 	{
 #ifndef BLIP_MONO
+    blip_init_kernels();
     m->buffer[0] = (buf_t*) malloc( (size + buf_extra) * sizeof (buf_t));
     m->buffer[1] = (buf_t*) malloc( (size + buf_extra) * sizeof (buf_t));
     if ((m->buffer[0] == NULL) || (m->buffer[1] == NULL))
@@ -215,6 +244,79 @@ void blip_clear( blip_t* m )
 #endif
 }
 
+/* samples kept in saved context: only samples up to end of last time frame (plus filter
+tail) are non-zero and, once available samples have been read, few of them are left */
+enum { context_samples = 64 };
+
+int blip_context_save( const blip_t* m, unsigned char* state )
+{
+	/* fixed length, whatever number of samples is pending */
+	int length = (context_samples + buf_extra) * sizeof (buf_t);
+	unsigned char* ptr = state;
+
+	if ( (m->offset >> time_bits) > context_samples || context_samples > m->size )
+		return 0;
+
+	memcpy( ptr, &m->offset, sizeof m->offset );
+	ptr += sizeof m->offset;
+	memcpy( ptr, &m->integrator, sizeof m->integrator );
+	ptr += sizeof m->integrator;
+#ifdef BLIP_MONO
+	memcpy( ptr, SAMPLES( m ), length );
+	ptr += length;
+#else
+	memcpy( ptr, m->buffer[0], length );
+	ptr += length;
+	memcpy( ptr, m->buffer[1], length );
+	ptr += length;
+#endif
+
+	return ptr - state;
+}
+
+int blip_context_size( const blip_t* m )
+{
+	int length = (context_samples + buf_extra) * sizeof (buf_t);
+	(void) m;
+
+#ifdef BLIP_MONO
+	return sizeof m->offset + sizeof m->integrator + length;
+#else
+	return sizeof m->offset + sizeof m->integrator + 2 * length;
+#endif
+}
+
+int blip_context_load( blip_t* m, const unsigned char* state )
+{
+	/* previously used samples are cleared */
+	int prev = ((m->offset >> time_bits) + buf_extra) * sizeof (buf_t);
+	int length = (context_samples + buf_extra) * sizeof (buf_t);
+	const unsigned char* ptr = state;
+
+	memcpy( &m->offset, ptr, sizeof m->offset );
+	ptr += sizeof m->offset;
+	memcpy( &m->integrator, ptr, sizeof m->integrator );
+	ptr += sizeof m->integrator;
+#ifdef BLIP_MONO
+	memcpy( SAMPLES( m ), ptr, length );
+	ptr += length;
+	if ( prev > length )
+		memset( (unsigned char*) SAMPLES( m ) + length, 0, prev - length );
+#else
+	memcpy( m->buffer[0], ptr, length );
+	ptr += length;
+	memcpy( m->buffer[1], ptr, length );
+	ptr += length;
+	if ( prev > length )
+	{
+		memset( (unsigned char*) m->buffer[0] + length, 0, prev - length );
+		memset( (unsigned char*) m->buffer[1] + length, 0, prev - length );
+	}
+#endif
+
+	return ptr - state;
+}
+
 int blip_clocks_needed( const blip_t* m, int samples )
 {
 	fixed_t needed;
@@ -279,12 +381,6 @@ int blip_read_samples( blip_t* m, short out [], int count)
 #ifdef BLIP_MONO
 		buf_t const* in = SAMPLES( m );
 		int sum = m->integrator;
-#else
-		buf_t const* in = m->buffer[0];
-		buf_t const* in2 = m->buffer[1];
-		int sum = m->integrator[0];
-		int sum2 = m->integrator[1];
-#endif
 		buf_t const* end = in + count;
 		do
 		{
@@ -299,28 +395,16 @@ int blip_read_samples( blip_t* m, short out [], int count)
 
 			/* High-pass filter */
 			sum -= s << (delta_bits - bass_shift);
-
-#ifndef BLIP_MONO
-			/* Eliminate fraction */
-			s = ARITH_SHIFT( sum2, delta_bits );
-
-			sum2 += *in2++;
-
-			CLAMP( s );
-
-			*out++ = s;
-
-			/* High-pass filter */
-			sum2 -= s << (delta_bits - bass_shift);
-#endif
 		}
 		while ( in != end );
 
-#ifdef BLIP_MONO
 		m->integrator = sum;
 #else
-		m->integrator[0] = sum;
-		m->integrator[1] = sum2;
+		buf_t const* in [1];
+		buf_t const* in2 [1];
+		in [0] = m->buffer[0];
+		in2 [0] = m->buffer[1];
+		kernels->mix( out, m->integrator, in, in2, 1, count );
 #endif
 		remove_samples( m, count );
 	}
@@ -328,6 +412,17 @@ int blip_read_samples( blip_t* m, short out [], int count)
 	return count;
 }
 
+int blip_discard_samples( blip_t* m, int count )
+{
+	if ( count > (m->offset >> time_bits) )
+		count = m->offset >> time_bits;
+
+	if ( count )
+		remove_samples( m, count );
+
+	return count;
+}
+
 int blip_mix_samples( blip_t* m1, blip_t** m2, int num, short out [], int count)
 {
   int i;
@@ -344,25 +439,13 @@ int blip_mix_samples( blip_t* m1, blip_t** m2, int num, short out [], int count)
   if ( count )
 #endif
   {
-    buf_t const* end;
     buf_t const* in[4];
 #ifdef BLIP_MONO
+    buf_t const* end;
     int sum = m1->integrator;
     in[0] = SAMPLES( m1 );
     for (i=0; i<num; i++)
       in[i+1] = SAMPLES( m2[i] );
-#else
-    int sum = m1->integrator[0];
-    int sum2 = m1->integrator[1];
-    buf_t const* in2[4];
-    in[0] = m1->buffer[0];
-    in2[0] = m1->buffer[1];
-    for (i=0; i<num; i++)
-    {
-      in[i+1] = m2[i]->buffer[0];
-      in2[i+1] = m2[i]->buffer[1];
-    }
-#endif
 
     end = in[0] + count;
     do
@@ -380,30 +463,21 @@ int blip_mix_samples( blip_t* m1, blip_t** m2, int num, short out [], int count)
 
       /* High-pass filter */
       sum -= s << (delta_bits - bass_shift);
-
-#ifndef BLIP_MONO
-      /* Eliminate fraction */
-      s = ARITH_SHIFT( sum2, delta_bits );
-
-      sum2 += *in2[0]++;
-      for (i=1; i<num+1; i++)
-        sum2 += *in2[i]++;
-
-      CLAMP( s );
-
-      *out++ = s;
-
-      /* High-pass filter */
-      sum2 -= s << (delta_bits - bass_shift);
-#endif
     }
     while ( in[0] != end );
 
-#ifdef BLIP_MONO
     m1->integrator = sum;
 #else
-    m1->integrator[0] = sum;
-    m1->integrator[1] = sum2;
+    buf_t const* in2[4];
+    in[0] = m1->buffer[0];
+    in2[0] = m1->buffer[1];
+    for (i=0; i<num; i++)
+    {
+      in[i+1] = m2[i]->buffer[0];
+      in2[i+1] = m2[i]->buffer[1];
+    }
+
+    kernels->mix( out, m1->integrator, in, in2, num + 1, count );
 #endif
     remove_samples( m1, count );
     for (i=0; i<num; i++)
@@ -464,14 +538,476 @@ simply ignoring the low half. */
 
 #ifndef BLIP_MONO
 
+/* Scalar kernels */
+
+static void add_delta_scalar( buf_t* out_l, buf_t* out_r, int phase, int interp, int delta_l, int delta_r )
+{
+  short const* in  = bl_step [phase];
+  short const* rev = bl_step [phase_count - phase];
+  int delta;
+
+  if (delta_l == delta_r)
+  {
+    buf_t out;
+    delta = (delta_l * interp) >> delta_bits;
+    delta_l -= delta;
+    out = in[0]*delta_l + in[half_width+0]*delta;
+    out_l[0] += out;
+    out_r[0] += out;
+    out = in[1]*delta_l + in[half_width+1]*delta;
+    out_l[1] += out;
+    out_r[1] += out;
+    out = in[2]*delta_l + in[half_width+2]*delta;
+    out_l[2] += out;
+    out_r[2] += out;
+    out = in[3]*delta_l + in[half_width+3]*delta;
+    out_l[3] += out;
+    out_r[3] += out;
+    out = in[4]*delta_l + in[half_width+4]*delta;
+    out_l[4] += out;
+    out_r[4] += out;
+    out = in[5]*delta_l + in[half_width+5]*delta;
+    out_l[5] += out;
+    out_r[5] += out;
+    out = in[6]*delta_l + in[half_width+6]*delta;
+    out_l[6] += out;
+    out_r[6] += out;
+    out = in[7]*delta_l + in[half_width+7]*delta;
+    out_l[7] += out;
+    out_r[7] += out;
+    out = rev[7]*delta_l + rev[7-half_width]*delta;
+    out_l[8] += out;
+    out_r[8] += out;
+    out = rev[6]*delta_l + rev[6-half_width]*delta;
+    out_l[9] += out;
+    out_r[9] += out;
+    out = rev[5]*delta_l + rev[5-half_width]*delta;
+    out_l[10] += out;
+    out_r[10] += out;
+    out = rev[4]*delta_l + rev[4-half_width]*delta;
+    out_l[11] += out;
+    out_r[11] += out;
+    out = rev[3]*delta_l + rev[3-half_width]*delta;
+    out_l[12] += out;
+    out_r[12] += out;
+    out = rev[2]*delta_l + rev[2-half_width]*delta;
+    out_l[13] += out;
+    out_r[13] += out;
+    out = rev[1]*delta_l + rev[1-half_width]*delta;
+    out_l[14] += out;
+    out_r[14] += out;
+    out = rev[0]*delta_l + rev[0-half_width]*delta;
+    out_l[15] += out;
+    out_r[15] += out;
+  }
+  else
+  {
+    delta = (delta_l * interp) >> delta_bits;
+    delta_l -= delta;
+    out_l [0] += in[0]*delta_l + in[half_width+0]*delta;
+    out_l [1] += in[1]*delta_l + in[half_width+1]*delta;
+    out_l [2] += in[2]*delta_l + in[half_width+2]*delta;
+    out_l [3] += in[3]*delta_l + in[half_width+3]*delta;
+    out_l [4] += in[4]*delta_l + in[half_width+4]*delta;
+    out_l [5] += in[5]*delta_l + in[half_width+5]*delta;
+    out_l [6] += in[6]*delta_l + in[half_width+6]*delta;
+    out_l [7] += in[7]*delta_l + in[half_width+7]*delta;
+    out_l [8] += rev[7]*delta_l + rev[7-half_width]*delta;
+    out_l [9] += rev[6]*delta_l + rev[6-half_width]*delta;
+    out_l [10] += rev[5]*delta_l + rev[5-half_width]*delta;
+    out_l [11] += rev[4]*delta_l + rev[4-half_width]*delta;
+    out_l [12] += rev[3]*delta_l + rev[3-half_width]*delta;
+    out_l [13] += rev[2]*delta_l + rev[2-half_width]*delta;
+    out_l [14] += rev[1]*delta_l + rev[1-half_width]*delta;
+    out_l [15] += rev[0]*delta_l + rev[0-half_width]*delta;
+
+    delta = (delta_r * interp) >> delta_bits;
+    delta_r -= delta;
+    out_r [0] += in[0]*delta_r + in[half_width+0]*delta;
+    out_r [1] += in[1]*delta_r + in[half_width+1]*delta;
+    out_r [2] += in[2]*delta_r + in[half_width+2]*delta;
+    out_r [3] += in[3]*delta_r + in[half_width+3]*delta;
+    out_r [4] += in[4]*delta_r + in[half_width+4]*delta;
+    out_r [5] += in[5]*delta_r + in[half_width+5]*delta;
+    out_r [6] += in[6]*delta_r + in[half_width+6]*delta;
+    out_r [7] += in[7]*delta_r + in[half_width+7]*delta;
+    out_r [8] += rev[7]*delta_r + rev[7-half_width]*delta;
+    out_r [9] += rev[6]*delta_r + rev[6-half_width]*delta;
+    out_r [10] += rev[5]*delta_r + rev[5-half_width]*delta;
+    out_r [11] += rev[4]*delta_r + rev[4-half_width]*delta;
+    out_r [12] += rev[3]*delta_r + rev[3-half_width]*delta;
+    out_r [13] += rev[2]*delta_r + rev[2-half_width]*delta;
+    out_r [14] += rev[1]*delta_r + rev[1-half_width]*delta;
+    out_r [15] += rev[0]*delta_r + rev[0-half_width]*delta;
+  }
+}
+
+static void mix_scalar( short out [], int integrator [2], buf_t const* in_l [], buf_t const* in_r [], int num, int count )
+{
+  buf_t const* in [4];
+  buf_t const* in2 [4];
+  int sum = integrator[0];
+  int sum2 = integrator[1];
+  int i;
+
+  for (i=0; i<num; i++)
+  {
+    in[i] = in_l[i];
+    in2[i] = in_r[i];
+  }
+
+  while (count--)
+  {
+    /* Eliminate fraction */
+    int s = ARITH_SHIFT( sum, delta_bits );
+
+    sum += *in[0]++;
+    for (i=1; i<num; i++)
+      sum += *in[i]++;
+
+    CLAMP( s );
+
+    *out++ = s;
+
+    /* High-pass filter */
+    sum -= s << (delta_bits - bass_shift);
+
+    /* Eliminate fraction */
+    s = ARITH_SHIFT( sum2, delta_bits );
+
+    sum2 += *in2[0]++;
+    for (i=1; i<num; i++)
+      sum2 += *in2[i]++;
+
+    CLAMP( s );
+
+    *out++ = s;
+
+    /* High-pass filter */
+    sum2 -= s << (delta_bits - bass_shift);
+  }
+
+  integrator[0] = sum;
+  integrator[1] = sum2;
+}
+
+static blip_kernels_t const kernels_scalar = { "scalar", add_delta_scalar, mix_scalar };
+
+#if defined(BLIP_X86) || defined(BLIP_NEON)
+
+/* SIMD kernels produce the same output as scalar kernels:
+ - step taps of each phase are interleaved in 16-bit pairs so that each output sample is updated
+   with one 16-bit multiply-add of both interpolated taps. Deltas which do not fit in 16 bits use
+   scalar kernel instead.
+ - mixed buffers are summed & interleaved by blocks of blip_chunk samples, then samples integration
+   & high-pass filter are run for both channels at once. */
+enum { blip_chunk = 64 };
+
+static short bl_taps [phase_count] [half_width*2] [2];
+
+static void init_taps( void )
+{
+  int phase, i;
+
+  for (phase=0; phase<phase_count; phase++)
+  {
+    short const* in  = bl_step [phase];
+    short const* rev = bl_step [phase_count - phase];
+
+    for (i=0; i<half_width; i++)
+    {
+      bl_taps[phase][i][0] = in[i];
+      bl_taps[phase][i][1] = in[half_width+i];
+      bl_taps[phase][half_width*2-1-i][0] = rev[i];
+      bl_taps[phase][half_width*2-1-i][1] = rev[i-half_width];
+    }
+  }
+}
+
+/* delta & delta2 fit in 16-bit when delta does */
+#define DELTA_16BIT( d ) ((unsigned) ((d) + 0x8000) <= 0xffff)
+
+#endif
+
+#ifdef BLIP_X86
+
+TARGET("sse2") static void add_delta_sse2( buf_t* out_l, buf_t* out_r, int phase, int interp, int delta_l, int delta_r )
+{
+  __m128i const* taps = (__m128i const*) bl_taps [phase];
+  __m128i t0, t1, t2, t3, d;
+  int delta;
+
+  if (!DELTA_16BIT( delta_l ) || !DELTA_16BIT( delta_r ))
+  {
+    add_delta_scalar( out_l, out_r, phase, interp, delta_l, delta_r );
+    return;
+  }
+
+  t0 = _mm_loadu_si128( taps + 0 );
+  t1 = _mm_loadu_si128( taps + 1 );
+  t2 = _mm_loadu_si128( taps + 2 );
+  t3 = _mm_loadu_si128( taps + 3 );
+
+#define ADD_TAPS_SSE2( out, d ) \
+  _mm_storeu_si128( (__m128i*) (out + 0),  _mm_add_epi32( _mm_loadu_si128( (__m128i const*) (out + 0) ),  _mm_madd_epi16( t0, d ) ) ); \
+  _mm_storeu_si128( (__m128i*) (out + 4),  _mm_add_epi32( _mm_loadu_si128( (__m128i const*) (out + 4) ),  _mm_madd_epi16( t1, d ) ) ); \
+  _mm_storeu_si128( (__m128i*) (out + 8),  _mm_add_epi32( _mm_loadu_si128( (__m128i const*) (out + 8) ),  _mm_madd_epi16( t2, d ) ) ); \
+  _mm_storeu_si128( (__m128i*) (out + 12), _mm_add_epi32( _mm_loadu_si128( (__m128i const*) (out + 12) ), _mm_madd_epi16( t3, d ) ) );
+
+  delta = (delta_l * interp) >> delta_bits;
+  d = _mm_set1_epi32( (delta << 16) | ((delta_l - delta) & 0xffff) );
+  ADD_TAPS_SSE2( out_l, d );
+
+  if (delta_l != delta_r)
+  {
+    delta = (delta_r * interp) >> delta_bits;
+    d = _mm_set1_epi32( (delta << 16) | ((delta_r - delta) & 0xffff) );
+  }
+  ADD_TAPS_SSE2( out_r, d );
+
+#undef ADD_TAPS_SSE2
+}
+
+TARGET("sse4.1") static void mix_sse41( short out [], int integrator [2], buf_t const* in_l [], buf_t const* in_r [], int num, int count )
+{
+  buf_t tmp [blip_chunk * 2];
+  buf_t const* in [4];
+  buf_t const* in2 [4];
+  __m128i sum = _mm_set_epi32( 0, 0, integrator[1], integrator[0] );
+  int i, j, n;
+
+  for (i=0; i<num; i++)
+  {
+    in[i] = in_l[i];
+    in2[i] = in_r[i];
+  }
+
+  while (count > 0)
+  {
+    n = (count < blip_chunk) ? count : blip_chunk;
+
+    /* sum & interleave mixed buffers (buffers have extra samples after available ones) */
+    for (j=0; j<n; j+=4)
+    {
+      __m128i l = _mm_loadu_si128( (__m128i const*) (in[0] + j) );
+      __m128i r = _mm_loadu_si128( (__m128i const*) (in2[0] + j) );
+      for (i=1; i<num; i++)
+      {
+        l = _mm_add_epi32( l, _mm_loadu_si128( (__m128i const*) (in[i] + j) ) );
+        r = _mm_add_epi32( r, _mm_loadu_si128( (__m128i const*) (in2[i] + j) ) );
+      }
+      _mm_storeu_si128( (__m128i*) (tmp + j*2),     _mm_unpacklo_epi32( l, r ) );
+      _mm_storeu_si128( (__m128i*) (tmp + j*2 + 4), _mm_unpackhi_epi32( l, r ) );
+    }
+
+    for (i=0; i<num; i++)
+    {
+      in[i] += n;
+      in2[i] += n;
+    }
+
+    count -= n;
+
+    /* integrate left & right channels */
+    for (j=0; j<n; j++)
+    {
+      /* Eliminate fraction & clamp */
+      __m128i s = _mm_max_epi32( _mm_min_epi32( _mm_srai_epi32( sum, delta_bits ), _mm_set1_epi32( max_sample ) ), _mm_set1_epi32( min_sample ) );
+      int lr = _mm_cvtsi128_si32( _mm_packs_epi32( s, s ) );
+      memcpy( out, &lr, sizeof lr );
+      out += 2;
+
+      /* High-pass filter */
+      sum = _mm_sub_epi32( _mm_add_epi32( sum, _mm_loadl_epi64( (__m128i const*) (tmp + j*2) ) ), _mm_slli_epi32( s, delta_bits - bass_shift ) );
+    }
+  }
+
+  integrator[0] = _mm_cvtsi128_si32( sum );
+  integrator[1] = _mm_cvtsi128_si32( _mm_srli_si128( sum, 4 ) );
+}
+
+/* SSE2 lacks 32-bit min/max: clamping with pack/unpack makes integration slower than scalar code */
+static blip_kernels_t const kernels_sse2 = { "sse2", add_delta_sse2, mix_scalar };
+static blip_kernels_t const kernels_sse41 = { "sse4.1", add_delta_sse2, mix_sse41 };
+
+#endif /* BLIP_X86 */
+
+#ifdef BLIP_NEON
+
+static void add_delta_neon( buf_t* out_l, buf_t* out_r, int phase, int interp, int delta_l, int delta_r )
+{
+  int16x8x2_t lo, hi;
+  int32x4_t o0, o1, o2, o3;
+  int16_t d, d2;
+  int delta;
+
+  if (!DELTA_16BIT( delta_l ) || !DELTA_16BIT( delta_r ))
+  {
+    add_delta_scalar( out_l, out_r, phase, interp, delta_l, delta_r );
+    return;
+  }
+
+  /* deinterleave taps */
+  lo = vld2q_s16( bl_taps [phase] [0] );
+  hi = vld2q_s16( bl_taps [phase] [half_width] );
+
+#define MUL_TAPS_NEON( d, d2 ) \
+  o0 = vmlal_n_s16( vmull_n_s16( vget_low_s16( lo.val[0] ), d ),  vget_low_s16( lo.val[1] ), d2 ); \
+  o1 = vmlal_n_s16( vmull_n_s16( vget_high_s16( lo.val[0] ), d ), vget_high_s16( lo.val[1] ), d2 ); \
+  o2 = vmlal_n_s16( vmull_n_s16( vget_low_s16( hi.val[0] ), d ),  vget_low_s16( hi.val[1] ), d2 ); \
+  o3 = vmlal_n_s16( vmull_n_s16( vget_high_s16( hi.val[0] ), d ), vget_high_s16( hi.val[1] ), d2 );
+
+#define ADD_TAPS_NEON( out ) \
+  vst1q_s32( (int32_t*) out + 0,  vaddq_s32( vld1q_s32( (int32_t*) out + 0 ),  o0 ) ); \
+  vst1q_s32( (int32_t*) out + 4,  vaddq_s32( vld1q_s32( (int32_t*) out + 4 ),  o1 ) ); \
+  vst1q_s32( (int32_t*) out + 8,  vaddq_s32( vld1q_s32( (int32_t*) out + 8 ),  o2 ) ); \
+  vst1q_s32( (int32_t*) out + 12, vaddq_s32( vld1q_s32( (int32_t*) out + 12 ), o3 ) );
+
+  delta = (delta_l * interp) >> delta_bits;
+  d = delta_l - delta;
+  d2 = delta;
+  MUL_TAPS_NEON( d, d2 );
+  ADD_TAPS_NEON( out_l );
+
+  if (delta_l != delta_r)
+  {
+    delta = (delta_r * interp) >> delta_bits;
+    d = delta_r - delta;
+    d2 = delta;
+    MUL_TAPS_NEON( d, d2 );
+  }
+  ADD_TAPS_NEON( out_r );
+
+#undef MUL_TAPS_NEON
+#undef ADD_TAPS_NEON
+}
+
+static void mix_neon( short out [], int integrator [2], buf_t const* in_l [], buf_t const* in_r [], int num, int count )
+{
+  buf_t tmp [blip_chunk * 2];
+  buf_t const* in [4];
+  buf_t const* in2 [4];
+  int32x2_t sum = vld1_s32( (int32_t const*) integrator );
+  int i, j, n;
+
+  for (i=0; i<num; i++)
+  {
+    in[i] = in_l[i];
+    in2[i] = in_r[i];
+  }
+
+  while (count > 0)
+  {
+    n = (count < blip_chunk) ? count : blip_chunk;
+
+    /* sum & interleave mixed buffers (buffers have extra samples after available ones) */
+    for (j=0; j<n; j+=4)
+    {
+      int32x4x2_t lr;
+      lr.val[0] = vld1q_s32( (int32_t const*) in[0] + j );
+      lr.val[1] = vld1q_s32( (int32_t const*) in2[0] + j );
+      for (i=1; i<num; i++)
+      {
+        lr.val[0] = vaddq_s32( lr.val[0], vld1q_s32( (int32_t const*) in[i] + j ) );
+        lr.val[1] = vaddq_s32( lr.val[1], vld1q_s32( (int32_t const*) in2[i] + j ) );
+      }
+      vst2q_s32( (int32_t*) tmp + j*2, lr );
+    }
+
+    for (i=0; i<num; i++)
+    {
+      in[i] += n;
+      in2[i] += n;
+    }
+
+    count -= n;
+
+    /* integrate left & right channels */
+    for (j=0; j<n; j++)
+    {
+      /* Eliminate fraction & clamp */
+      int32x2_t s = vmax_s32( vmin_s32( vshr_n_s32( sum, delta_bits ), vdup_n_s32( max_sample ) ), vdup_n_s32( min_sample ) );
+      vst1_lane_s32( (int32_t*) out, vreinterpret_s32_s16( vmovn_s32( vcombine_s32( s, s ) ) ), 0 );
+      out += 2;
+
+      /* High-pass filter */
+      sum = vsub_s32( vadd_s32( sum, vld1_s32( (int32_t const*) tmp + j*2 ) ), vshl_n_s32( s, delta_bits - bass_shift ) );
+    }
+  }
+
+  vst1_s32( (int32_t*) integrator, sum );
+}
+
+static blip_kernels_t const kernels_neon = { "neon", add_delta_neon, mix_neon };
+
+#endif /* BLIP_NEON */
+
+/* kernels supported by host CPU, from slowest to fastest */
+static blip_kernels_t const* available [4];
+
+static void blip_init_kernels( void )
+{
+  int count = 0;
+
+  if (kernels)
+    return;
+
+  available[count++] = &kernels_scalar;
+
+#if defined(BLIP_X86) || defined(BLIP_NEON)
+  init_taps();
+#endif
+
+#ifdef BLIP_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    available[count++] = &kernels_sse2;
+  if (__builtin_cpu_supports("sse4.1"))
+    available[count++] = &kernels_sse41;
+#endif
+
+#ifdef BLIP_NEON
+  /* NEON is mandatory on AArch64 */
+  available[count++] = &kernels_neon;
+#endif
+
+  kernels = available[count - 1];
+}
+
+const char* blip_kernels( int index )
+{
+  blip_init_kernels();
+
+  if ((index < 0) || (index >= (int) (sizeof available / sizeof available[0])) || !available[index])
+    return NULL;
+
+  return available[index]->name;
+}
+
+int blip_select_kernels( const char* name )
+{
+  int i;
+
+  blip_init_kernels();
+
+  for (i=0; i<(int) (sizeof available / sizeof available[0]) && available[i]; i++)
+  {
+    if (!strcmp( available[i]->name, name ))
+    {
+      kernels = available[i];
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
 void blip_add_delta( blip_t* m, unsigned time, int delta_l, int delta_r )
 {
   if (delta_l | delta_r)
   {
     unsigned fixed = (unsigned) ((time * m->factor + m->offset) >> pre_shift);
     int phase = fixed >> phase_shift & (phase_count - 1);
-    short const* in  = bl_step [phase];
-    short const* rev = bl_step [phase_count - phase];
     int interp = fixed >> (phase_shift - delta_bits) & (delta_unit - 1);
     int pos = fixed >> frac_bits;
 
@@ -483,107 +1019,12 @@ void blip_add_delta( blip_t* m, unsigned time, int delta_l, int delta_r )
     buf_t* out_r = m->buffer[1] + pos;
 #endif
 
-    int delta;
-
 #ifdef BLIP_ASSERT
     /* Fails if buffer size was exceeded */
     assert( pos <= m->size + end_frame_extra );
 #endif
 
-    if (delta_l == delta_r)
-    {
-      buf_t out;
-      delta = (delta_l * interp) >> delta_bits;
-      delta_l -= delta;
-      out = in[0]*delta_l + in[half_width+0]*delta;
-      out_l[0] += out;
-      out_r[0] += out;
-      out = in[1]*delta_l + in[half_width+1]*delta;
-      out_l[1] += out;
-      out_r[1] += out;
-      out = in[2]*delta_l + in[half_width+2]*delta;
-      out_l[2] += out;
-      out_r[2] += out;
-      out = in[3]*delta_l + in[half_width+3]*delta;
-      out_l[3] += out;
-      out_r[3] += out;
-      out = in[4]*delta_l + in[half_width+4]*delta;
-      out_l[4] += out;
-      out_r[4] += out;
-      out = in[5]*delta_l + in[half_width+5]*delta;
-      out_l[5] += out;
-      out_r[5] += out;
-      out = in[6]*delta_l + in[half_width+6]*delta;
-      out_l[6] += out;
-      out_r[6] += out;
-      out = in[7]*delta_l + in[half_width+7]*delta;
-      out_l[7] += out;
-      out_r[7] += out;
-      out = rev[7]*delta_l + rev[7-half_width]*delta;
-      out_l[8] += out;
-      out_r[8] += out;
-      out = rev[6]*delta_l + rev[6-half_width]*delta;
-      out_l[9] += out;
-      out_r[9] += out;
-      out = rev[5]*delta_l + rev[5-half_width]*delta;
-      out_l[10] += out;
-      out_r[10] += out;
-      out = rev[4]*delta_l + rev[4-half_width]*delta;
-      out_l[11] += out;
-      out_r[11] += out;
-      out = rev[3]*delta_l + rev[3-half_width]*delta;
-      out_l[12] += out;
-      out_r[12] += out;
-      out = rev[2]*delta_l + rev[2-half_width]*delta;
-      out_l[13] += out;
-      out_r[13] += out;
-      out = rev[1]*delta_l + rev[1-half_width]*delta;
-      out_l[14] += out;
-      out_r[14] += out;
-      out = rev[0]*delta_l + rev[0-half_width]*delta;
-      out_l[15] += out;
-      out_r[15] += out;
-    }
-    else
-    {
-      delta = (delta_l * interp) >> delta_bits;
-      delta_l -= delta;
-      out_l [0] += in[0]*delta_l + in[half_width+0]*delta;
-      out_l [1] += in[1]*delta_l + in[half_width+1]*delta;
-      out_l [2] += in[2]*delta_l + in[half_width+2]*delta;
-      out_l [3] += in[3]*delta_l + in[half_width+3]*delta;
-      out_l [4] += in[4]*delta_l + in[half_width+4]*delta;
-      out_l [5] += in[5]*delta_l + in[half_width+5]*delta;
-      out_l [6] += in[6]*delta_l + in[half_width+6]*delta;
-      out_l [7] += in[7]*delta_l + in[half_width+7]*delta;
-      out_l [8] += rev[7]*delta_l + rev[7-half_width]*delta;
-      out_l [9] += rev[6]*delta_l + rev[6-half_width]*delta;
-      out_l [10] += rev[5]*delta_l + rev[5-half_width]*delta;
-      out_l [11] += rev[4]*delta_l + rev[4-half_width]*delta;
-      out_l [12] += rev[3]*delta_l + rev[3-half_width]*delta;
-      out_l [13] += rev[2]*delta_l + rev[2-half_width]*delta;
-      out_l [14] += rev[1]*delta_l + rev[1-half_width]*delta;
-      out_l [15] += rev[0]*delta_l + rev[0-half_width]*delta;
-
-      delta = (delta_r * interp) >> delta_bits;
-      delta_r -= delta;
-      out_r [0] += in[0]*delta_r + in[half_width+0]*delta;
-      out_r [1] += in[1]*delta_r + in[half_width+1]*delta;
-      out_r [2] += in[2]*delta_r + in[half_width+2]*delta;
-      out_r [3] += in[3]*delta_r + in[half_width+3]*delta;
-      out_r [4] += in[4]*delta_r + in[half_width+4]*delta;
-      out_r [5] += in[5]*delta_r + in[half_width+5]*delta;
-      out_r [6] += in[6]*delta_r + in[half_width+6]*delta;
-      out_r [7] += in[7]*delta_r + in[half_width+7]*delta;
-      out_r [8] += rev[7]*delta_r + rev[7-half_width]*delta;
-      out_r [9] += rev[6]*delta_r + rev[6-half_width]*delta;
-      out_r [10] += rev[5]*delta_r + rev[5-half_width]*delta;
-      out_r [11] += rev[4]*delta_r + rev[4-half_width]*delta;
-      out_r [12] += rev[3]*delta_r + rev[3-half_width]*delta;
-      out_r [13] += rev[2]*delta_r + rev[2-half_width]*delta;
-      out_r [14] += rev[1]*delta_r + rev[1-half_width]*delta;
-      out_r [15] += rev[0]*delta_r + rev[0-half_width]*delta;
-    }
+    kernels->add_delta( out_l, out_r, phase, interp, delta_l, delta_r );
   }
 }
 
@@ -685,4 +1126,15 @@ void blip_add_delta_fast( blip_t* m, unsigned time, int delta )
 	out [7] += delta * delta_unit - delta2;
 	out [8] += delta2;
 }
+
+/* mono buffers only use scalar code */
+const char* blip_kernels( int index )
+{
+	return index ? NULL : "scalar";
+}
+
+int blip_select_kernels( const char* name )
+{
+	return !strcmp( name, "scalar" );
+}
 #endif
@@ -72,6 +72,32 @@ int blip_read_samples( blip_t*, short out [], int count);
 /* m2 is an array with 'num' blip buffer streams to be mixed with m1 blip buffer stream */
 int blip_mix_samples( blip_t* m1, blip_t** m2, int num, short out [], int count);
 
+/** Removes at most 'count' samples without reading them. Returns number of
+samples actually removed. */
+int blip_discard_samples( blip_t*, int count );
+
+/** blip_add_delta() and sample reading/mixing functions are implemented with SIMD
+instructions when supported by host CPU (stereo buffers only). Implementation is
+selected at runtime (the fastest one by default) and all of them produce identical
+output. Returns name of implementation at 'index' (0 = "scalar", always available)
+or NULL if there is none. */
+const char* blip_kernels( int index );
+
+/** Selects implementation by name. Returns 0 if it is not available. */
+int blip_select_kernels( const char* name );
+
+/** Copies buffer state (pending samples included) to 'state'. Returns number
+of bytes written, which is always the same, or 0 if too many samples are pending
+(available samples should be read first). */
+int blip_context_save( const blip_t*, unsigned char* state );
+
+/** Number of bytes written by blip_context_save(). */
+int blip_context_size( const blip_t* );
+
+/** Restores buffer state previously copied by blip_context_save(). Sample rates
+must be unchanged. Returns number of bytes read. */
+int blip_context_load( blip_t*, const unsigned char* state );
+
 /** Frees buffer. No effect if NULL is passed. */
 void blip_delete( blip_t* );
 
@@ -74,7 +74,7 @@ static const uint16 chanVolume[16] = {
   0                             /*  OFF  */
 };
 
-static struct
+static THREAD_LOCAL struct
 {
   int clocks;
   int latch;
@@ -156,6 +156,14 @@ int psg_context_save(uint8 *state)
   return bufferptr;
 }
 
+/* length of psg_context_save data */
+int psg_context_size(void)
+{
+  /* saved data is a subset of PSG state */
+  uint8 state[sizeof(psg)];
+  return psg_context_save(state);
+}
+
 int psg_context_load(uint8 *state)
 {
   int delta[2];
@@ -222,6 +230,34 @@ int psg_context_load(uint8 *state)
   return bufferptr;
 }
 
+/* channels output state, not part of savestates (see state_snapshot_save) */
+int psg_output_context_save(uint8 *state)
+{
+  int bufferptr = 0;
+
+  save_param(psg.chanDelta,sizeof(psg.chanDelta));
+  save_param(psg.chanOut,sizeof(psg.chanOut));
+  save_param(psg.chanAmp,sizeof(psg.chanAmp));
+
+  return bufferptr;
+}
+
+int psg_output_context_size(void)
+{
+  return sizeof(psg.chanDelta) + sizeof(psg.chanOut) + sizeof(psg.chanAmp);
+}
+
+int psg_output_context_load(uint8 *state)
+{
+  int bufferptr = 0;
+
+  load_param(psg.chanDelta,sizeof(psg.chanDelta));
+  load_param(psg.chanOut,sizeof(psg.chanOut));
+  load_param(psg.chanAmp,sizeof(psg.chanAmp));
+
+  return bufferptr;
+}
+
 void psg_write(unsigned int clocks, unsigned int data)
 {
   int index;
@@ -452,10 +488,95 @@ void psg_end_frame(unsigned int clocks)
   }
 }
 
+/* Run PSG chip generators without sound generation (see audio_set_mute) */
+static void psg_mute(unsigned int clocks)
+{
+  int i, timestamp, polarity, count;
+
+  for (i=0; i<4; i++)
+  {
+    /* pending channel volume variations are dropped */
+    psg.chanDelta[i][0] = 0;
+    psg.chanDelta[i][1] = 0;
+
+    /* timestamp of next transition */
+    timestamp = psg.freqCounter[i];
+
+    /* Tone channels */
+    if (i < 3)
+    {
+      if (timestamp < clocks)
+      {
+        /* number of transitions occurring until current clock timestamp */
+        count = (clocks - timestamp + psg.freqInc[i] - 1) / psg.freqInc[i];
+
+        /* tone generator polarity is inverted on each transition */
+        if (count & 1)
+        {
+          psg.polarity[i] = -psg.polarity[i];
+        }
+
+        /* save timestamp of next transition */
+        psg.freqCounter[i] = timestamp + (count * psg.freqInc[i]);
+      }
+    }
+
+    /* Noise channel */
+    else
+    {
+      /* current noise shift register value */
+      int shiftValue = psg.noiseShiftValue;
+
+      /* current channel generator polarity */
+      polarity = psg.polarity[3];
+
+      /* process all transitions occurring until current clock timestamp */
+      while (timestamp < clocks)
+      {
+        /* invert noise generator polarity */
+        polarity = -polarity;
+
+        /* noise register is shifted on positive edge only */
+        if (polarity > 0)
+        {
+          /* White noise (-----1xx) */
+          if (psg.regs[6] & 0x04)
+          {
+            /* shift and apply XOR feedback network */
+            shiftValue = (shiftValue >> 1) | (noiseFeedback[shiftValue & psg.noiseBitMask] << psg.noiseShiftWidth);
+          }
+
+          /* Periodic noise (-----0xx) */
+          else
+          {
+            /* shift and feedback current output */
+            shiftValue = (shiftValue >> 1) | ((shiftValue & 0x01) << psg.noiseShiftWidth);
+          }
+        }
+
+        /* timestamp of next transition */
+        timestamp += psg.freqInc[3];
+      }
+
+      /* save noise channel state */
+      psg.noiseShiftValue = shiftValue;
+      psg.freqCounter[3] = timestamp;
+      psg.polarity[3] = polarity;
+    }
+  }
+}
+
 static void psg_update(unsigned int clocks)
 {
   int i, timestamp, polarity;
 
+  /* sound generation is disabled */
+  if (snd.muted)
+  {
+    psg_mute(clocks);
+    return;
+  }
+
   for (i=0; i<4; i++)
   {
     /* apply any pending channel volume variations */
@@ -53,6 +53,10 @@ extern void psg_init(PSG_TYPE type);
 extern void psg_reset(void);
 extern int psg_context_save(uint8 *state);
 extern int psg_context_load(uint8 *state);
+extern int psg_context_size(void);
+extern int psg_output_context_save(uint8 *state);
+extern int psg_output_context_load(uint8 *state);
+extern int psg_output_context_size(void);
 extern void psg_write(unsigned int clocks, unsigned int data);
 extern void psg_config(unsigned int clocks, unsigned int preamp, unsigned int panning);
 extern void psg_end_frame(unsigned int clocks);
@@ -40,44 +40,109 @@
 #include "shared.h"
 #include "blip_buf.h"
 
+#ifdef USE_FM_THREAD
+#include <pthread.h>
+
+/* FM thread accesses emulator state of the thread that started it */
+#ifdef USE_MULTI_INSTANCE
+#error "USE_FM_THREAD is not supported with USE_MULTI_INSTANCE"
+#endif
+#endif
+
 /* YM2612 internal clock = input clock / 6 = (master clock / 7) / 6 */
 #define YM2612_CLOCK_RATIO (7*6)
 
 /* FM output buffer (large enough to hold a whole frame at original chips rate) */
 #if defined(HAVE_YM3438_CORE) || defined(HAVE_OPLL_CORE)
-static int fm_buffer[1080 * 2 * 24];
+static THREAD_LOCAL int fm_buffer[1080 * 2 * 24];
 #else
-static int fm_buffer[1080 * 2];
+static THREAD_LOCAL int fm_buffer[1080 * 2];
 #endif
 
-static int fm_last[2];
-static int *fm_ptr;
+static THREAD_LOCAL int fm_last[2];
+static THREAD_LOCAL int *fm_ptr;
 
 /* Cycle-accurate FM samples */
-static int fm_cycles_ratio;
-static int fm_cycles_start;
-static int fm_cycles_count;
-static int fm_cycles_busy;
+static THREAD_LOCAL int fm_cycles_ratio;
+static THREAD_LOCAL int fm_cycles_start;
+static THREAD_LOCAL int fm_cycles_count;
+static THREAD_LOCAL int fm_cycles_busy;
 
 /* YM chip function pointers */
-static void (*YM_Update)(int *buffer, int length);
-void (*fm_reset)(unsigned int cycles);
-void (*fm_write)(unsigned int cycles, unsigned int address, unsigned int data);
-unsigned int (*fm_read)(unsigned int cycles, unsigned int address);
+static THREAD_LOCAL void (*YM_Update)(int *buffer, int length);
+static THREAD_LOCAL void (*YM_Mute)(int length);
+THREAD_LOCAL void (*fm_reset)(unsigned int cycles);
+THREAD_LOCAL void (*fm_write)(unsigned int cycles, unsigned int address, unsigned int data);
+THREAD_LOCAL unsigned int (*fm_read)(unsigned int cycles, unsigned int address);
 
 #ifdef HAVE_YM3438_CORE
-static ym3438_t ym3438;
-static short ym3438_accm[24][2];
-static int ym3438_sample[2];
-static int ym3438_cycles;
+static THREAD_LOCAL ym3438_t ym3438;
+static THREAD_LOCAL short ym3438_accm[24][2];
+static THREAD_LOCAL int ym3438_sample[2];
+static THREAD_LOCAL int ym3438_cycles;
 #endif
 
 #ifdef HAVE_OPLL_CORE
-static opll_t opll;
-static int opll_accm[18][2];
-static int opll_sample;
-static int opll_cycles;
-static int opll_status;
+static THREAD_LOCAL opll_t opll;
+static THREAD_LOCAL int opll_accm[18][2];
+static THREAD_LOCAL int opll_sample;
+static THREAD_LOCAL int opll_cycles;
+static THREAD_LOCAL int opll_status;
+#endif
+
+#ifdef USE_FM_THREAD
+/* YM2612 samples are run by a worker thread. Register writes & resets are queued with the */
+/* number of samples to run before them, in the same order and at the same sample position */
+/* as synchronous emulation, so the output is identical. Only the status register (timers */
+/* & busy flags) is emulated by the calling thread, using a copy of chip registers updated */
+/* by the same writes (see YM2612Status* & OPN2_ClockStatus). The queue is drained before */
+/* FM samples are mixed at the end of frame & before chip state is saved or modified.     */
+#define FM_QUEUE_SIZE 4096
+
+enum
+{
+  FM_EVENT_RUN = 0,
+  FM_EVENT_WRITE,
+  FM_EVENT_RESET
+};
+
+typedef struct
+{
+  int samples;      /* samples to run before event */
+  uint8 type;       /* FM_EVENT_xxx */
+  uint8 address;
+  uint8 data;
+} t_fm_event;
+
+static struct
+{
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond_work;           /* events have been queued */
+  pthread_cond_t cond_idle;           /* all queued events have been processed */
+  t_fm_event queue[FM_QUEUE_SIZE];
+  unsigned int head;                  /* queue write index (emulation thread) */
+  unsigned int tail;                  /* queue read index (FM thread) */
+  int waiting;                        /* FM thread waits for queued events */
+  int syncing;                        /* emulation thread waits for empty queue */
+  int samples;                        /* samples not queued yet */
+  int running;
+  int quit;
+} fm_thread;
+
+/* YM2612 samples are run by FM thread */
+static int fm_deferred;
+
+#ifdef HAVE_YM3438_CORE
+/* Nuked OPN2 copy used for status register emulation */
+static ym3438_t ym3438_status;
+#endif
+
+static void fm_queue(int type, unsigned int address, unsigned int data);
+static void fm_flush(void);
+static void fm_status_update(int samples);
+#else
+#define fm_flush()
 #endif
 
 /* Run FM chip until required M-cycles */
@@ -88,11 +153,35 @@ INLINE void fm_update(int cycles)
     /* number of samples to run */
     int samples = (cycles - fm_cycles_count + fm_cycles_ratio - 1) / fm_cycles_ratio;
 
-    /* run FM chip to sample buffer */
-    YM_Update(fm_ptr, samples);
+#ifdef USE_FM_THREAD
+    if (fm_deferred)
+    {
+      /* samples are run by FM thread before next queued event */
+      fm_status_update(samples);
+      fm_thread.samples += samples;
+    }
+    else
+#endif
+    if (snd.muted)
+    {
+      /* run FM chip status only (no sample generation) */
+      if (YM_Mute)
+      {
+        YM_Mute(samples);
+      }
+    }
+    else
+    {
+      PROFILE_START(PROF_FM_UPDATE);
 
-    /* update FM buffer pointer */
-    fm_ptr += (samples * 2);
+      /* run FM chip to sample buffer */
+      YM_Update(fm_ptr, samples);
+
+      PROFILE_END(PROF_FM_UPDATE);
+
+      /* update FM buffer pointer */
+      fm_ptr += (samples * 2);
+    }
 
     /* update FM cycle counter */
     fm_cycles_count += (samples * fm_cycles_ratio);
@@ -105,6 +194,14 @@ static void YM2612_Reset(unsigned int cycles)
   fm_update(cycles);
 
   /* reset FM chip */
+#ifdef USE_FM_THREAD
+  if (fm_deferred)
+  {
+    YM2612StatusReset();
+    fm_queue(FM_EVENT_RESET, 0, 0);
+  }
+  else
+#endif
   YM2612ResetChip();
   fm_cycles_busy = 0;
 }
@@ -125,6 +222,14 @@ static void YM2612_Write(unsigned int cycles, unsigned int a, unsigned int v)
   }
 
   /* write FM register */
+#ifdef USE_FM_THREAD
+  if (fm_deferred)
+  {
+    YM2612StatusWrite(a, v);
+    fm_queue(FM_EVENT_WRITE, a, v);
+    return;
+  }
+#endif
   YM2612Write(a, v);
 }
 
@@ -133,19 +238,30 @@ static unsigned int YM2612_Read(unsigned int cycles, unsigned int a)
   /* FM status can only be read from (A0,A1)=(0,0) on discrete YM2612 */
   if ((a == 0) || (config.ym2612 > YM2612_DISCRETE))
   {
+    unsigned int data;
+
     /* synchronize FM chip with CPU */
     fm_update(cycles);
 
     /* read FM status */
+#ifdef USE_FM_THREAD
+    if (fm_deferred)
+    {
+      data = YM2612StatusRead();
+    }
+    else
+#endif
+    data = YM2612Read();
+
     if (cycles >= fm_cycles_busy)
     {
       /* BUSY flag cleared */
-      return YM2612Read();
+      return data;
     }
     else
     {
       /* BUSY flag set */
-      return YM2612Read() | 0x80;
+      return data | 0x80;
     }
   }
 
@@ -183,19 +299,34 @@ static unsigned int YM2413_Read(unsigned int cycles, unsigned int a)
 #ifdef HAVE_YM3438_CORE
 static void YM3438_Update(int *buffer, int length)
 {
-  int i, j;
-  for (i = 0; i < length; i++)
+  int i, count;
+  while (length > 0)
   {
-    OPN2_Clock(&ym3438, ym3438_accm[ym3438_cycles]);
-    ym3438_cycles = (ym3438_cycles + 1) % 24;
-    if (ym3438_cycles == 0)
+    /* run chip up to the end of current sample period */
+    count = 24 - ym3438_cycles;
+    if (count > length)
     {
+      count = length;
+    }
+    OPN2_ClockBatch(&ym3438, ym3438_accm[ym3438_cycles], count);
+    ym3438_cycles += count;
+    length -= count;
+
+    /* output is only updated at the end of sample period */
+    for (i = 1; i < count; i++)
+    {
+      *buffer++ = ym3438_sample[0] * 11;
+      *buffer++ = ym3438_sample[1] * 11;
+    }
+    if (ym3438_cycles == 24)
+    {
+      ym3438_cycles = 0;
       ym3438_sample[0] = 0;
       ym3438_sample[1] = 0;
-      for (j = 0; j < 24; j++)
+      for (i = 0; i < 24; i++)
       {
-        ym3438_sample[0] += ym3438_accm[j][0];
-        ym3438_sample[1] += ym3438_accm[j][1];
+        ym3438_sample[0] += ym3438_accm[i][0];
+        ym3438_sample[1] += ym3438_accm[i][1];
       }
     }
     *buffer++ = ym3438_sample[0] * 11;
@@ -203,12 +334,32 @@ static void YM3438_Update(int *buffer, int length)
   }
 }
 
+static void YM3438_Mute(int length)
+{
+  /* keep current sample period */
+  ym3438_cycles = (ym3438_cycles + length) % 24;
+
+  /* run chip timers & registers writes only (one chip clock per sample) */
+  while (length--)
+  {
+    OPN2_ClockStatus(&ym3438);
+  }
+}
+
 static void YM3438_Reset(unsigned int cycles)
 {
   /* synchronize FM chip with CPU */
   fm_update(cycles);
 
   /* reset FM chip */
+#ifdef USE_FM_THREAD
+  if (fm_deferred)
+  {
+    OPN2_Reset(&ym3438_status);
+    fm_queue(FM_EVENT_RESET, 0, 0);
+    return;
+  }
+#endif
   OPN2_Reset(&ym3438);
 }
 
@@ -218,6 +369,14 @@ static void YM3438_Write(unsigned int cycles, unsigned int a, unsigned int v)
   fm_update(cycles);
 
   /* write FM register */
+#ifdef USE_FM_THREAD
+  if (fm_deferred)
+  {
+    OPN2_Write(&ym3438_status, a, v);
+    fm_queue(FM_EVENT_WRITE, a, v);
+    return;
+  }
+#endif
   OPN2_Write(&ym3438, a, v);
 }
 
@@ -227,6 +386,26 @@ static unsigned int YM3438_Read(unsigned int cycles, unsigned int a)
   fm_update(cycles);
 
   /* read FM status */
+#ifdef USE_FM_THREAD
+  if (fm_deferred)
+  {
+    unsigned int data;
+
+    /* test register data is only available from FM thread chip */
+    if (!ym3438_status.mode_test_21[6])
+    {
+      return OPN2_Read(&ym3438_status, a);
+    }
+
+    fm_flush();
+    ym3438.status = ym3438_status.status;
+    ym3438.status_time = ym3438_status.status_time;
+    data = OPN2_Read(&ym3438, a);
+    ym3438_status.status = ym3438.status;
+    ym3438_status.status_time = ym3438.status_time;
+    return data;
+  }
+#endif
   return OPN2_Read(&ym3438, a);
 }
 #endif
@@ -284,8 +463,237 @@ static unsigned int OPLL2413_Read(unsigned int cycles, unsigned int a)
 
 #endif
 
+#ifdef USE_FM_THREAD
+static void fm_status_update(int samples)
+{
+#ifdef HAVE_YM3438_CORE
+  if (YM_Update == YM3438_Update)
+  {
+    /* one chip clock per sample */
+    while (samples--)
+    {
+      OPN2_ClockStatus(&ym3438_status);
+    }
+    return;
+  }
+#endif
+  YM2612StatusUpdate(samples);
+}
+
+static void fm_event(const t_fm_event *event)
+{
+  /* run FM chip to sample buffer */
+  if (event->samples)
+  {
+    YM_Update(fm_ptr, event->samples);
+    fm_ptr += (event->samples * 2);
+  }
+
+#ifdef HAVE_YM3438_CORE
+  if (YM_Update == YM3438_Update)
+  {
+    if (event->type == FM_EVENT_WRITE)
+    {
+      OPN2_Write(&ym3438, event->address, event->data);
+    }
+    else if (event->type == FM_EVENT_RESET)
+    {
+      OPN2_Reset(&ym3438);
+    }
+    return;
+  }
+#endif
+
+  if (event->type == FM_EVENT_WRITE)
+  {
+    YM2612Write(event->address, event->data);
+  }
+  else if (event->type == FM_EVENT_RESET)
+  {
+    YM2612ResetChip();
+  }
+}
+
+static void *fm_thread_main(void *arg)
+{
+  unsigned int head, tail;
+
+  pthread_mutex_lock(&fm_thread.mutex);
+
+  for (;;)
+  {
+    while ((fm_thread.tail == fm_thread.head) && !fm_thread.quit)
+    {
+      pthread_cond_wait(&fm_thread.cond_work, &fm_thread.mutex);
+    }
+
+    if (fm_thread.tail == fm_thread.head)
+    {
+      break;
+    }
+
+    /* process queued events */
+    head = fm_thread.head;
+    tail = fm_thread.tail;
+    pthread_mutex_unlock(&fm_thread.mutex);
+
+    while (tail != head)
+    {
+      fm_event(&fm_thread.queue[tail++ % FM_QUEUE_SIZE]);
+    }
+
+    pthread_mutex_lock(&fm_thread.mutex);
+    fm_thread.tail = tail;
+    if (fm_thread.syncing && (tail == fm_thread.head))
+    {
+      pthread_cond_signal(&fm_thread.cond_idle);
+    }
+  }
+
+  pthread_mutex_unlock(&fm_thread.mutex);
+  return NULL;
+}
+
+/* wait until all queued events have been processed (mutex locked) */
+static void fm_wait(void)
+{
+  fm_thread.syncing = 1;
+  while (fm_thread.tail != fm_thread.head)
+  {
+    pthread_cond_wait(&fm_thread.cond_idle, &fm_thread.mutex);
+  }
+  fm_thread.syncing = 0;
+}
+
+static void fm_queue(int type, unsigned int address, unsigned int data)
+{
+  t_fm_event *event = &fm_thread.queue[fm_thread.head % FM_QUEUE_SIZE];
+
+  /* samples to run before event */
+  event->samples = fm_thread.samples;
+  event->type = type;
+  event->address = address;
+  event->data = data;
+  fm_thread.samples = 0;
+
+  pthread_mutex_lock(&fm_thread.mutex);
+  fm_thread.head++;
+  pthread_cond_signal(&fm_thread.cond_work);
+
+  /* queue is full */
+  if ((fm_thread.head - fm_thread.tail) == FM_QUEUE_SIZE)
+  {
+    fm_wait();
+  }
+  pthread_mutex_unlock(&fm_thread.mutex);
+}
+
+/* run FM chip up to current sample before its state or output is accessed */
+static void fm_flush(void)
+{
+  if (!fm_deferred)
+  {
+    return;
+  }
+
+  if (fm_thread.samples)
+  {
+    fm_queue(FM_EVENT_RUN, 0, 0);
+  }
+
+  pthread_mutex_lock(&fm_thread.mutex);
+  fm_wait();
+  pthread_mutex_unlock(&fm_thread.mutex);
+}
+
+/* copy FM chip state to status register emulation */
+static void fm_status_init(void)
+{
+  /* YM2612 only, muted chip is run synchronously */
+  fm_deferred = fm_thread.running && ((system_hw & SYSTEM_PBC) == SYSTEM_MD) && !snd.muted;
+  if (!fm_deferred)
+  {
+    return;
+  }
+
+#ifdef HAVE_YM3438_CORE
+  if (YM_Update == YM3438_Update)
+  {
+    memcpy(&ym3438_status, &ym3438, sizeof(ym3438));
+    return;
+  }
+#endif
+  YM2612StatusInit();
+}
+
+int fm_thread_start(void)
+{
+  if (fm_thread.running)
+  {
+    return 1;
+  }
+
+  fm_thread.head = fm_thread.tail = 0;
+  fm_thread.samples = 0;
+  fm_thread.syncing = 0;
+  fm_thread.quit = 0;
+
+  pthread_mutex_init(&fm_thread.mutex, NULL);
+  pthread_cond_init(&fm_thread.cond_work, NULL);
+  pthread_cond_init(&fm_thread.cond_idle, NULL);
+
+  if (pthread_create(&fm_thread.thread, NULL, fm_thread_main, NULL))
+  {
+    pthread_cond_destroy(&fm_thread.cond_idle);
+    pthread_cond_destroy(&fm_thread.cond_work);
+    pthread_mutex_destroy(&fm_thread.mutex);
+    return 0;
+  }
+
+  fm_thread.running = 1;
+
+  /* sound chips may already be initialized */
+  if (YM_Update)
+  {
+    fm_status_init();
+  }
+
+  return 1;
+}
+
+void fm_thread_stop(void)
+{
+  if (!fm_thread.running)
+  {
+    return;
+  }
+
+  /* FM chip is emulated by calling thread */
+  fm_flush();
+  fm_deferred = 0;
+
+  pthread_mutex_lock(&fm_thread.mutex);
+  fm_thread.quit = 1;
+  pthread_cond_signal(&fm_thread.cond_work);
+  pthread_mutex_unlock(&fm_thread.mutex);
+
+  pthread_join(fm_thread.thread, NULL);
+
+  pthread_cond_destroy(&fm_thread.cond_idle);
+  pthread_cond_destroy(&fm_thread.cond_work);
+  pthread_mutex_destroy(&fm_thread.mutex);
+  fm_thread.running = 0;
+}
+#endif
+
 void sound_init( void )
 {
+  /* FM chip state is about to be modified */
+  fm_flush();
+
+  /* savestate layout depends on emulated FM chip */
+  state_invalidate();
+
   /* Initialize FM chip */
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
@@ -298,6 +706,7 @@ void sound_init( void )
       memset(&ym3438_sample, 0, sizeof(ym3438_sample));
       memset(&ym3438_accm, 0, sizeof(ym3438_accm));
       YM_Update = YM3438_Update;
+      YM_Mute = YM3438_Mute;
       fm_reset = YM3438_Reset;
       fm_write = YM3438_Write;
       fm_read = YM3438_Read;
@@ -312,6 +721,7 @@ void sound_init( void )
       YM2612Init();
       YM2612Config(config.ym2612);
       YM_Update = YM2612Update;
+      YM_Mute = YM2612UpdateTimers;
       fm_reset = YM2612_Reset;
       fm_write = YM2612_Write;
       fm_read = YM2612_Read;
@@ -332,6 +742,7 @@ void sound_init( void )
       opll_sample = 0;
       opll_status = 0;
       YM_Update = (config.ym2413 & 1) ? OPLL2413_Update : NULL;
+      YM_Mute = NULL;
       fm_reset = OPLL2413_Reset;
       fm_write = OPLL2413_Write;
       fm_read = OPLL2413_Read;
@@ -344,6 +755,7 @@ void sound_init( void )
     {
       YM2413Init();
       YM_Update = (config.ym2413 & 1) ? YM2413Update : NULL;
+      YM_Mute = NULL;
       fm_reset = YM2413_Reset;
       fm_write = YM2413_Write;
       fm_read = YM2413_Read;
@@ -355,6 +767,10 @@ void sound_init( void )
 
   /* Initialize PSG chip */
   psg_init((system_hw == SYSTEM_SG) ? PSG_DISCRETE : PSG_INTEGRATED);
+
+#ifdef USE_FM_THREAD
+  fm_status_init();
+#endif
 }
 
 void sound_reset(void)
@@ -367,6 +783,9 @@ void sound_reset(void)
   /* reset FM buffer ouput */
   fm_last[0] = fm_last[1] = 0;
 
+  /* FM thread has run FM chip reset */
+  fm_flush();
+
   /* reset FM buffer pointer */
   fm_ptr = fm_buffer;
   
@@ -376,6 +795,8 @@ void sound_reset(void)
 
 int sound_update(unsigned int cycles)
 {
+  PROFILE_START(PROF_SOUND_UPDATE);
+
   /* Run PSG chip until end of frame */
   psg_end_frame(cycles);
 
@@ -386,6 +807,7 @@ int sound_update(unsigned int cycles)
 
     /* Run FM chip until end of frame */
     fm_update(cycles);
+    fm_flush();
 
     /* FM output pre-amplification */
     preamp = config.fm_preamp;
@@ -401,7 +823,12 @@ int sound_update(unsigned int cycles)
     ptr = fm_buffer;
 
     /* flush FM samples */
-    if (config.hq_fm)
+    if (snd.muted)
+    {
+      /* no samples were generated, end of last FM sample period */
+      time = fm_cycles_count;
+    }
+    else if (config.hq_fm)
     {
       /* high-quality Band-Limited synthesis */
       do
@@ -458,14 +885,63 @@ int sound_update(unsigned int cycles)
   /* end of blip buffer time frame */
   blip_end_frame(snd.blips[0], cycles);
 
+  PROFILE_END(PROF_SOUND_UPDATE);
+
   /* return number of available samples */
   return blip_samples_avail(snd.blips[0]);
 }
 
+void sound_mute(int mute)
+{
+  /* FM thread has run all queued samples */
+  fm_flush();
+
+  snd.muted = mute;
+
+#ifdef USE_FM_THREAD
+  /* muted FM chip is not run by FM thread */
+  if (YM_Update)
+  {
+    fm_status_init();
+  }
+#endif
+}
+
+/* FM output & busy state and PSG output state are not part of savestates (see state_snapshot_save) */
+int sound_output_context_save(uint8 *state)
+{
+  int bufferptr = 0;
+
+  save_param(fm_last, sizeof(fm_last));
+  save_param(&fm_cycles_busy, sizeof(fm_cycles_busy));
+  bufferptr += psg_output_context_save(&state[bufferptr]);
+
+  return bufferptr;
+}
+
+int sound_output_context_size(void)
+{
+  return sizeof(fm_last) + sizeof(fm_cycles_busy) + psg_output_context_size();
+}
+
+int sound_output_context_load(uint8 *state)
+{
+  int bufferptr = 0;
+
+  load_param(fm_last, sizeof(fm_last));
+  load_param(&fm_cycles_busy, sizeof(fm_cycles_busy));
+  bufferptr += psg_output_context_load(&state[bufferptr]);
+
+  return bufferptr;
+}
+
 int sound_context_save(uint8 *state)
 {
   int bufferptr = 0;
-  
+
+  /* FM chip state must be up to date */
+  fm_flush();
+
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
 #ifdef HAVE_YM3438_CORE
@@ -511,10 +987,50 @@ int sound_context_save(uint8 *state)
   return bufferptr;
 }
 
+/* length of sound_context_save data, for FM core used by saved data or, if state is NULL, for the largest FM core */
+int sound_context_size(const uint8 *state)
+{
+  int size;
+
+  if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
+  {
+#ifdef HAVE_YM3438_CORE
+    int nuked = sizeof(ym3438) + sizeof(ym3438_accm) + sizeof(ym3438_sample) + sizeof(ym3438_cycles);
+#endif
+    size = YM2612GetContextSize();
+#ifdef HAVE_YM3438_CORE
+    if (state ? state[0] : (nuked > size))
+    {
+      size = nuked;
+    }
+    size += sizeof(config.ym3438);
+#endif
+  }
+  else
+  {
+#ifdef HAVE_OPLL_CORE
+    int nuked = sizeof(opll) + sizeof(opll_accm) + sizeof(opll_sample) + sizeof(opll_cycles) + sizeof(opll_status);
+#endif
+    size = YM2413GetContextSize();
+#ifdef HAVE_OPLL_CORE
+    if (state ? state[0] : (nuked > size))
+    {
+      size = nuked;
+    }
+    size += sizeof(config.opll);
+#endif
+  }
+
+  return size + psg_context_size() + sizeof(fm_cycles_start);
+}
+
 int sound_context_load(uint8 *state)
 {
   int bufferptr = 0;
 
+  /* FM chip state is about to be modified */
+  fm_flush();
+
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
 #ifdef HAVE_YM3438_CORE
@@ -560,5 +1076,9 @@ int sound_context_load(uint8 *state)
   load_param(&fm_cycles_start,sizeof(fm_cycles_start));
   fm_cycles_count = fm_cycles_start;
 
+#ifdef USE_FM_THREAD
+  fm_status_init();
+#endif
+
   return bufferptr;
 }
@@ -45,9 +45,19 @@ extern void sound_init(void);
 extern void sound_reset(void);
 extern int sound_context_save(uint8 *state);
 extern int sound_context_load(uint8 *state);
+extern int sound_context_size(const uint8 *state);
+extern int sound_output_context_save(uint8 *state);
+extern int sound_output_context_load(uint8 *state);
+extern int sound_output_context_size(void);
 extern int sound_update(unsigned int cycles);
-extern void (*fm_reset)(unsigned int cycles);
-extern void (*fm_write)(unsigned int cycles, unsigned int address, unsigned int data);
-extern unsigned int (*fm_read)(unsigned int cycles, unsigned int address);
+extern void sound_mute(int mute);
+extern THREAD_LOCAL void (*fm_reset)(unsigned int cycles);
+extern THREAD_LOCAL void (*fm_write)(unsigned int cycles, unsigned int address, unsigned int data);
+extern THREAD_LOCAL unsigned int (*fm_read)(unsigned int cycles, unsigned int address);
+
+#ifdef USE_FM_THREAD
+extern int fm_thread_start(void);
+extern void fm_thread_stop(void);
+#endif
 
 #endif /* _SOUND_H_ */
@@ -395,13 +395,20 @@ static const UINT8 mul_tab[16]= {
 *  TL_RES_LEN - sinus resolution (X axis)
 */
 #define TL_TAB_LEN (11*2*TL_RES_LEN)
+#ifdef BUILD_TABLES
 static signed int tl_tab[TL_TAB_LEN];
+#endif
 
 #define ENV_QUIET    (TL_TAB_LEN>>5)
 
 /* sin waveform table in 'decibel' scale */
 /* two waveforms on OPLL type chips */
+#ifdef BUILD_TABLES
 static unsigned int sin_tab[SIN_LEN * 2];
+#else
+/* Pre-generated tables (tl_tab, sin_tab) */
+#include "ym2413_tables.h"
+#endif
 
 
 /* LFO Amplitude Modulation table (verified on real YM3812)
@@ -576,13 +583,13 @@ static unsigned char table[19][8] = {
   {0x05, 0x01, 0x00, 0x00, 0xf8, 0xaa, 0x59, 0x55 }  /* TOM, TOP CYM */
 };
 
-static signed int output[2];
+static THREAD_LOCAL signed int output[2];
 
-static UINT32  LFO_AM;
-static INT32  LFO_PM;
+static THREAD_LOCAL UINT32  LFO_AM;
+static THREAD_LOCAL INT32  LFO_PM;
 
 /* emulated chip */
-static YM2413 ym2413;
+static THREAD_LOCAL YM2413 ym2413;
 
 /* advance LFO to next sample */
 INLINE void advance_lfo(void)
@@ -1094,6 +1101,7 @@ INLINE void rhythm_calc( YM2413_OPLL_CH *CH, unsigned int noise )
 }
 
 
+#ifdef BUILD_TABLES
 /* generic table initialize */
 static int init_tables(void)
 {
@@ -1161,6 +1169,14 @@ static int init_tables(void)
   return 1;
 }
 
+/* tables built by YM2413Init, in ym2413_tables.h order (see sdl/headless/gen_tables.c) */
+void YM2413GetTables(const void *tables[2])
+{
+  tables[0] = tl_tab;
+  tables[1] = sin_tab;
+}
+#endif
+
 
 static void OPLL_initalize(void)
 {
@@ -1699,7 +1715,16 @@ static void OPLLWriteReg(int r, int v)
 
 void YM2413Init(void)
 {
-  init_tables();
+#ifdef BUILD_TABLES
+  static int tables_initialized = 0;
+
+  /* global tables are shared by all instances and only need to be built once */
+  if (!tables_initialized)
+  {
+    init_tables();
+    tables_initialized = 1;
+  }
+#endif
 
   /* clear */
   memset(&ym2413,0,sizeof(YM2413));
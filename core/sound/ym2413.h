@@ -19,5 +19,8 @@ extern void YM2413Write(unsigned int a, unsigned int v);
 extern unsigned int YM2413Read(void);
 extern unsigned char *YM2413GetContextPtr(void);
 extern unsigned int YM2413GetContextSize(void);
+#ifdef BUILD_TABLES
+extern void YM2413GetTables(const void *tables[2]);
+#endif
 
 #endif /*_H_YM2413_*/
@@ -149,6 +149,10 @@
 
 #include "shared.h"
 
+#if defined(USE_YM2612_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 /* envelope generator */
 #define ENV_BITS    10
 #define ENV_LEN      (1<<ENV_BITS)
@@ -183,12 +187,16 @@
 *   TL_RES_LEN - sinus resolution (X axis)
 */
 #define TL_TAB_LEN (13*2*TL_RES_LEN)
+#ifdef BUILD_TABLES
 static signed int tl_tab[TL_TAB_LEN];
+#endif
 
 #define ENV_QUIET    (TL_TAB_LEN>>3)
 
 /* sin waveform table in 'decibel' scale */
+#ifdef BUILD_TABLES
 static unsigned int sin_tab[SIN_LEN];
+#endif
 
 /* sustain level table (3dB per step) */
 /* bit0, bit1, bit2, bit3, bit4, bit5, bit6 */
@@ -394,7 +402,8 @@ static const UINT8 lfo_ams_depth_shift[4] = {8, 3, 1, 0};
 
   Here we store only first quarter (positive one) of full waveform.
   Full table (lfo_pm_table) containing all 128 waveforms is build
-  at run (init) time.
+  at run (init) time when BUILD_TABLES is defined, otherwise it is
+  pre-generated in ym2612_tables.h.
 
   One value in table below represents 4 (four) basic LFO steps
   (1 PM step = 4 AM steps).
@@ -406,6 +415,7 @@ static const UINT8 lfo_ams_depth_shift[4] = {8, 3, 1, 0};
    samples (32*432=13824; 32 because we store only a quarter of whole
             waveform in the table below)
 */
+#ifdef BUILD_TABLES
 static const UINT8 lfo_pm_output[7*8][8]={
 /* 7 bits meaningful (of F-NUMBER), 8 LFO output levels per one depth (out of 32), 8 LFO depths */
 /* FNUM BIT 4: 000 0001xxxx */
@@ -482,6 +492,10 @@ static const UINT8 lfo_pm_output[7*8][8]={
 
 /* all 128 LFO PM waveforms */
 static INT32 lfo_pm_table[128*8*32]; /* 128 combinations of 7 bits meaningful (of F-NUMBER), 8 LFO depths, 32 LFO output levels per one depth */
+#else
+/* Pre-generated tables (tl_tab, sin_tab, lfo_pm_table) */
+#include "ym2612_tables.h"
+#endif
 
 /* register number to channel number , slot offset */
 #define OPN_CHAN(N) (N&3)
@@ -625,16 +639,26 @@ typedef struct
 } YM2612;
 
 /* emulated chip */
-static YM2612 ym2612;
+static THREAD_LOCAL YM2612 ym2612;
+
+/* status register state, emulated apart from sound generation (see YM2612StatusUpdate) */
+static THREAD_LOCAL struct
+{
+  UINT16  address;
+  UINT8   status;
+  UINT32  mode;
+  INT32   TA, TAL, TAC;
+  INT32   TBL, TBC;
+} ym2612_status;
 
 /* current chip state */
-static INT32  m2,c1,c2;   /* Phase Modulation input for operators 2,3,4 */
-static INT32  mem;        /* one sample delay memory */
-static INT32  out_fm[6];  /* outputs of working channels */
+static THREAD_LOCAL INT32  m2,c1,c2;   /* Phase Modulation input for operators 2,3,4 */
+static THREAD_LOCAL INT32  mem;        /* one sample delay memory */
+static THREAD_LOCAL INT32  out_fm[6];  /* outputs of working channels */
 
 /* chip type */
-static UINT32 op_mask[8][4];  /* operator output bitmasking (DAC quantization) */
-static int chip_type = YM2612_DISCRETE;
+static THREAD_LOCAL UINT32 op_mask[8][4];  /* operator output bitmasking (DAC quantization) */
+static THREAD_LOCAL int chip_type = YM2612_DISCRETE;
 
 
 INLINE void FM_KEYON(FM_CH *CH , int s )
@@ -1433,6 +1457,25 @@ INLINE signed int op_calc1(UINT32 phase, unsigned int env, unsigned int pm, unsi
   return (tl_tab[p] & opmask);
 }
 
+INLINE void update_phase_lfo_chan(FM_CH *CH)
+{
+  /* 3-slot mode */
+  if ((ym2612.OPN.ST.mode & 0xC0) && (CH == &ym2612.CH[2]))
+  {
+    /* keyscale code is not modifiedby LFO */
+    UINT8 kc = ym2612.CH[2].kcode;
+    UINT32 pm = ym2612.CH[2].pms + ym2612.OPN.LFO_PM;
+    update_phase_lfo_slot(&ym2612.CH[2].SLOT[SLOT1], pm, kc, ym2612.OPN.SL3.block_fnum[1]);
+    update_phase_lfo_slot(&ym2612.CH[2].SLOT[SLOT2], pm, kc, ym2612.OPN.SL3.block_fnum[2]);
+    update_phase_lfo_slot(&ym2612.CH[2].SLOT[SLOT3], pm, kc, ym2612.OPN.SL3.block_fnum[0]);
+    update_phase_lfo_slot(&ym2612.CH[2].SLOT[SLOT4], pm, kc, ym2612.CH[2].block_fnum);
+  }
+  else
+  {
+    update_phase_lfo_channel(CH);
+  }
+}
+
 INLINE void chan_calc(FM_CH *CH, int num)
 {
   do
@@ -1483,21 +1526,7 @@ INLINE void chan_calc(FM_CH *CH, int num)
     /* update phase counters AFTER output calculations */
     if (CH->pms)
     {
-      /* 3-slot mode */
-      if ((ym2612.OPN.ST.mode & 0xC0) && (CH == &ym2612.CH[2]))
-      {
-        /* keyscale code is not modifiedby LFO */
-        UINT8 kc = ym2612.CH[2].kcode;
-        UINT32 pm = ym2612.CH[2].pms + ym2612.OPN.LFO_PM;
-        update_phase_lfo_slot(&ym2612.CH[2].SLOT[SLOT1], pm, kc, ym2612.OPN.SL3.block_fnum[1]);
-        update_phase_lfo_slot(&ym2612.CH[2].SLOT[SLOT2], pm, kc, ym2612.OPN.SL3.block_fnum[2]);
-        update_phase_lfo_slot(&ym2612.CH[2].SLOT[SLOT3], pm, kc, ym2612.OPN.SL3.block_fnum[0]);
-        update_phase_lfo_slot(&ym2612.CH[2].SLOT[SLOT4], pm, kc, ym2612.CH[2].block_fnum);
-      }
-      else
-      {
-        update_phase_lfo_channel(CH);
-      }
+      update_phase_lfo_chan(CH);
     }
     else  /* no LFO phase modulation */
     {
@@ -1512,6 +1541,222 @@ INLINE void chan_calc(FM_CH *CH, int num)
   } while (--num);
 }
 
+#ifdef USE_YM2612_SIMD
+/* Structure-of-arrays operator evaluation: same computation as chan_calc, but each operator   */
+/* is evaluated for all channels at once, one lane per channel. Algorithms are handled with    */
+/* per-lane selection masks instead of connection pointers, so the same code runs whatever     */
+/* the algorithm of each channel. Unused lanes (and channel 6 in DAC mode) output nothing.     */
+/* Phase counters and envelope outputs are still read from FM_SLOT as they are also updated    */
+/* by Key ON, SSG-EG and envelope generator. LFO phase modulation remains per channel.         */
+#define OP_LANES 8
+
+/* algorithm selection masks (one bit per algorithm) */
+enum
+{
+  SEL_S3_MEM, SEL_S2_OP1, SEL_S4_OP1, SEL_S4_MEM, SEL_S4_S3,
+  SEL_OUT_S2, SEL_OUT_S3, SEL_OUT_OP1, SEL_MEM_S2, SEL_MEM_OP1, SEL_MEM_MEM,
+  SEL_MAX
+};
+
+static const UINT8 algo_sel[SEL_MAX] =
+{
+  0x27, /* SLOT3 input: MEM (algorithms 0,1,2,5) */
+  0x79, /* SLOT2 input: SLOT1 (algorithms 0,3,4,5,6) */
+  0x24, /* SLOT4 input: SLOT1 (algorithms 2,5) */
+  0x08, /* SLOT4 input: MEM (algorithm 3) */
+  0x1f, /* SLOT4 input: SLOT3 (algorithms 0-4) */
+  0xf0, /* carrier: SLOT2 (algorithms 4-7) */
+  0xe0, /* carrier: SLOT3 (algorithms 5-7) */
+  0x80, /* carrier: SLOT1 (algorithm 7) */
+  0x0f, /* next MEM: SLOT2 (algorithms 0-3) */
+  0x22, /* next MEM: SLOT1 (algorithms 1,5) */
+  0xd0  /* next MEM: unchanged (algorithms 4,6,7) */
+};
+
+typedef struct
+{
+  UINT32  AMmask[4][OP_LANES];  /* AM enable flag */
+  UINT32  mask[4][OP_LANES];    /* operator output bitmasking (DAC quantization) */
+  UINT32  ams[OP_LANES];        /* channel AMS */
+  UINT32  FB[OP_LANES];         /* feedback shift */
+  INT32   fb_en[OP_LANES];      /* feedback enable */
+  INT32   on[OP_LANES];         /* lane enable */
+  INT32   op1_out[2][OP_LANES]; /* op1 output for feedback */
+  INT32   mem[OP_LANES];        /* delayed sample (MEM) value */
+  INT32   sel[SEL_MAX][OP_LANES];
+} FM_OPS;
+
+static THREAD_LOCAL FM_OPS ops;
+
+/* operators evaluation in use (see YM2612SelectOperators) */
+static int ops_soa = 1;
+
+/* copy channels state to lanes, before samples are generated */
+static void ops_load(int num)
+{
+  int c, s, i;
+  FM_CH *CH = &ym2612.CH[0];
+
+  memset(&ops, 0, sizeof(ops));
+
+  for (c=0; c<num; c++, CH++)
+  {
+    for (s=0; s<4; s++)
+    {
+      ops.AMmask[s][c] = CH->SLOT[s].AMmask;
+    }
+
+    ops.mask[SLOT1][c] = op_mask[CH->ALGO][0];
+    ops.mask[SLOT2][c] = op_mask[CH->ALGO][1];
+    ops.mask[SLOT3][c] = op_mask[CH->ALGO][2];
+    ops.mask[SLOT4][c] = op_mask[CH->ALGO][3];
+
+    ops.ams[c] = CH->ams;
+    ops.FB[c] = CH->FB;
+    ops.fb_en[c] = (CH->FB < SIN_BITS) ? ~0 : 0;
+    ops.on[c] = ~0;
+    ops.op1_out[0][c] = CH->op1_out[0];
+    ops.op1_out[1][c] = CH->op1_out[1];
+    ops.mem[c] = CH->mem_value;
+
+    for (i=0; i<SEL_MAX; i++)
+    {
+      ops.sel[i][c] = ((algo_sel[i] >> CH->ALGO) & 1) ? ~0 : 0;
+    }
+  }
+}
+
+/* copy lanes state back to channels, once samples are generated */
+static void ops_store(int num)
+{
+  int c;
+  FM_CH *CH = &ym2612.CH[0];
+
+  for (c=0; c<num; c++, CH++)
+  {
+    CH->op1_out[0] = ops.op1_out[0][c];
+    CH->op1_out[1] = ops.op1_out[1][c];
+    CH->mem_value = ops.mem[c];
+  }
+}
+
+/* one operator of all lanes (same as op_calc, or op_calc1 when shift = 0) */
+INLINE void ops_op_calc(INT32 *out, int s, const UINT32 *pm, int shift, int num)
+{
+  UINT32 AM = ym2612.OPN.LFO_AM;
+#if defined(__AVX2__)
+  /* phase counters & envelope outputs gathered from each channel slot */
+  const __m256i chan = _mm256_setr_epi32(0, 1*sizeof(FM_CH)/4, 2*sizeof(FM_CH)/4, 3*sizeof(FM_CH)/4,
+                                         4*sizeof(FM_CH)/4, 5*sizeof(FM_CH)/4, 6*sizeof(FM_CH)/4, 7*sizeof(FM_CH)/4);
+  __m256i on = _mm256_loadu_si256((const __m256i *)ops.on);
+  __m256i phase = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int *)&ym2612.CH[0].SLOT[s].phase, chan, on, 4);
+  __m256i env = _mm256_mask_i32gather_epi32(_mm256_set1_epi32(ENV_QUIET), (const int *)&ym2612.CH[0].SLOT[s].vol_out, chan, on, 4);
+  __m256i p;
+
+  env = _mm256_add_epi32(env, _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(AM), _mm256_loadu_si256((const __m256i *)ops.ams)),
+                                               _mm256_loadu_si256((const __m256i *)ops.AMmask[s])));
+  phase = _mm256_add_epi32(_mm256_srli_epi32(phase, SIN_BITS), _mm256_srl_epi32(_mm256_loadu_si256((const __m256i *)pm), _mm_cvtsi32_si128(shift)));
+  p = _mm256_add_epi32(_mm256_slli_epi32(env, 3), _mm256_i32gather_epi32((const int *)sin_tab, _mm256_and_si256(phase, _mm256_set1_epi32(SIN_MASK)), 4));
+
+  /* quiet envelope (>= ENV_QUIET) is also out of table */
+  on = _mm256_cmpgt_epi32(_mm256_set1_epi32(TL_TAB_LEN), p);
+  p = _mm256_i32gather_epi32((const int *)tl_tab, _mm256_and_si256(p, on), 4);
+  _mm256_storeu_si256((__m256i *)out, _mm256_and_si256(_mm256_and_si256(p, on), _mm256_loadu_si256((const __m256i *)ops.mask[s])));
+#else
+  FM_CH *CH = &ym2612.CH[0];
+  int c;
+
+  /* phase counters & envelope outputs read from each channel slot */
+  for (c=0; c<num; c++, CH++)
+  {
+    UINT32 env = CH->SLOT[s].vol_out + ((AM >> ops.ams[c]) & ops.AMmask[s][c]);
+    UINT32 p = (env<<3) + sin_tab[((CH->SLOT[s].phase >> SIN_BITS) + (pm[c] >> shift)) & SIN_MASK];
+
+    /* quiet envelope (>= ENV_QUIET) is also out of table */
+    UINT32 on = (p < TL_TAB_LEN) ? ~0 : 0;
+    out[c] = tl_tab[p & on] & ops.mask[s][c] & on;
+  }
+
+  /* unused lanes */
+  for (; c<OP_LANES; c++)
+  {
+    out[c] = 0;
+  }
+#endif
+}
+
+INLINE void ops_calc(int num)
+{
+  INT32 op1[OP_LANES], op2[OP_LANES], op3[OP_LANES], op4[OP_LANES];
+  UINT32 pm[OP_LANES];
+  FM_CH *CH;
+  int c;
+
+  /* SLOT 1 (self-feedback) */
+  for (c=0; c<OP_LANES; c++)
+    pm[c] = ((ops.op1_out[0][c] + ops.op1_out[1][c]) >> ops.FB[c]) & ops.fb_en[c];
+  ops_op_calc(op1, SLOT1, pm, 0, num);
+  for (c=0; c<OP_LANES; c++)
+  {
+    ops.op1_out[0][c] = ops.op1_out[1][c];
+    ops.op1_out[1][c] = op1[c];
+  }
+
+  /* SLOT 3 */
+  for (c=0; c<OP_LANES; c++)
+    pm[c] = ops.mem[c] & ops.sel[SEL_S3_MEM][c];
+  ops_op_calc(op3, SLOT3, pm, 1, num);
+
+  /* SLOT 2 */
+  for (c=0; c<OP_LANES; c++)
+    pm[c] = op1[c] & ops.sel[SEL_S2_OP1][c];
+  ops_op_calc(op2, SLOT2, pm, 1, num);
+
+  /* SLOT 4 */
+  for (c=0; c<OP_LANES; c++)
+    pm[c] = (op1[c] & ops.sel[SEL_S4_OP1][c]) + (ops.mem[c] & ops.sel[SEL_S4_MEM][c]) + (op3[c] & ops.sel[SEL_S4_S3][c]);
+  ops_op_calc(op4, SLOT4, pm, 1, num);
+
+  /* carrier outputs & next MEM */
+  for (c=0; c<OP_LANES; c++)
+  {
+    op4[c] += (op2[c] & ops.sel[SEL_OUT_S2][c]) + (op3[c] & ops.sel[SEL_OUT_S3][c]) + (op1[c] & ops.sel[SEL_OUT_OP1][c]);
+    ops.mem[c] = (op2[c] & ops.sel[SEL_MEM_S2][c]) + (op1[c] & ops.sel[SEL_MEM_OP1][c]) + (ops.mem[c] & ops.sel[SEL_MEM_MEM][c]);
+  }
+
+  for (c=0, CH=&ym2612.CH[0]; c<num; c++, CH++)
+  {
+    out_fm[c] += op4[c];
+
+    /* update phase counters AFTER output calculations */
+    if (CH->pms)
+    {
+      update_phase_lfo_chan(CH);
+    }
+    else  /* no LFO phase modulation */
+    {
+      CH->SLOT[SLOT1].phase += CH->SLOT[SLOT1].Incr;
+      CH->SLOT[SLOT2].phase += CH->SLOT[SLOT2].Incr;
+      CH->SLOT[SLOT3].phase += CH->SLOT[SLOT3].Incr;
+      CH->SLOT[SLOT4].phase += CH->SLOT[SLOT4].Incr;
+    }
+  }
+}
+#endif
+
+/* calculate FM channels output */
+INLINE void channels_calc(int num)
+{
+#ifdef USE_YM2612_SIMD
+  if (ops_soa)
+  {
+    ops_calc(num);
+    return;
+  }
+#endif
+  chan_calc(&ym2612.CH[0], num);
+}
+
 /* write a OPN mode register 0x20-0x2f */
 INLINE void OPNWriteMode(int r, int v)
 {
@@ -1781,10 +2026,11 @@ static void reset_channels(FM_CH *CH , int num )
   }
 }
 
+#ifdef BUILD_TABLES
 /* initialize generic tables */
 static void init_tables(void)
 {
-  signed int d,i,x;
+  signed int i,x;
   signed int n;
   double o,m;
 
@@ -1877,6 +2123,37 @@ static void init_tables(void)
       }
     }
   }
+}
+
+/* tables built by YM2612Init, in ym2612_tables.h order (see sdl/headless/gen_tables.c) */
+void YM2612GetTables(const void *tables[3])
+{
+  tables[0] = tl_tab;
+  tables[1] = sin_tab;
+  tables[2] = lfo_pm_table;
+}
+#endif
+
+
+
+/* initialize ym2612 emulator */
+void YM2612Init(void)
+{
+#ifdef BUILD_TABLES
+  static int tables_initialized = 0;
+#endif
+  int d,i;
+
+  memset(&ym2612,0,sizeof(YM2612));
+
+#ifdef BUILD_TABLES
+  /* global tables are shared by all instances and only need to be built once */
+  if (!tables_initialized)
+  {
+    init_tables();
+    tables_initialized = 1;
+  }
+#endif
 
   /* build DETUNE table */
   for (d = 0;d <= 3;d++)
@@ -1896,16 +2173,6 @@ static void init_tables(void)
       op_mask[i][d] = 0xffffffff;
     }
   }
-
-}
-
-
-
-/* initialize ym2612 emulator */
-void YM2612Init(void)
-{
-  memset(&ym2612,0,sizeof(YM2612));
-  init_tables();
 }
 
 /* reset OPN registers */
@@ -2002,6 +2269,120 @@ unsigned int YM2612Read(void)
   return ym2612.OPN.ST.status;
 }
 
+/* Status register emulation without sound generation: timers are run exactly like in   */
+/* YM2612Update and written like in YM2612Write, so status is the one the chip would    */
+/* return after the same register writes and samples. Used when YM2612Update is run     */
+/* later by another thread (see sound.c).                                              */
+void YM2612StatusInit(void)
+{
+  /* copy current chip state */
+  ym2612_status.address = ym2612.OPN.ST.address;
+  ym2612_status.status  = ym2612.OPN.ST.status;
+  ym2612_status.mode    = ym2612.OPN.ST.mode;
+  ym2612_status.TA      = ym2612.OPN.ST.TA;
+  ym2612_status.TAL     = ym2612.OPN.ST.TAL;
+  ym2612_status.TAC     = ym2612.OPN.ST.TAC;
+  ym2612_status.TBL     = ym2612.OPN.ST.TBL;
+  ym2612_status.TBC     = ym2612.OPN.ST.TBC;
+}
+
+static void YM2612StatusTimers(int v)
+{
+  /* same as set_timers */
+  if ((v&1) && !(ym2612_status.mode&1))
+    ym2612_status.TAC = ym2612_status.TAL;
+  if ((v&2) && !(ym2612_status.mode&2))
+    ym2612_status.TBC = ym2612_status.TBL;
+  ym2612_status.status &= (~v >> 4);
+  ym2612_status.mode = v;
+}
+
+void YM2612StatusReset(void)
+{
+  /* same as YM2612ResetChip */
+  ym2612_status.TAC = 0;
+  ym2612_status.TBC = 0;
+  YM2612StatusTimers(0x30);
+  ym2612_status.TBL = 256 << 4;
+  ym2612_status.TA  = 0;
+  ym2612_status.TAL = 1024;
+}
+
+void YM2612StatusWrite(unsigned int a, unsigned int v)
+{
+  v &= 0xff;
+
+  switch (a)
+  {
+    case 0:  /* address port 0 */
+      ym2612_status.address = v;
+      break;
+
+    case 2:  /* address port 1 */
+      ym2612_status.address = v | 0x100;
+      break;
+
+    default:  /* data port (timers registers only) */
+      switch (ym2612_status.address)
+      {
+        case 0x24:  /* timer A High */
+          ym2612_status.TA = (ym2612_status.TA & 0x03)|(((int)v)<<2);
+          ym2612_status.TAL = 1024 - ym2612_status.TA;
+          break;
+        case 0x25:  /* timer A Low */
+          ym2612_status.TA = (ym2612_status.TA & 0x3fc)|(v&3);
+          ym2612_status.TAL = 1024 - ym2612_status.TA;
+          break;
+        case 0x26:  /* timer B */
+          ym2612_status.TBL = (256 - v) << 4;
+          break;
+        case 0x27:  /* mode, timer control */
+          YM2612StatusTimers(v);
+          break;
+      }
+      break;
+  }
+}
+
+void YM2612StatusUpdate(int length)
+{
+  /* timer A control (each sample) */
+  if (ym2612_status.mode & 0x01)
+  {
+    int i;
+    for (i = 0; i < length; i++)
+    {
+      if (--ym2612_status.TAC <= 0)
+      {
+        if (ym2612_status.mode & 0x04)
+          ym2612_status.status |= 0x01;
+        ym2612_status.TAC = ym2612_status.TAL;
+      }
+    }
+  }
+
+  /* timer B control */
+  if (ym2612_status.mode & 0x02)
+  {
+    ym2612_status.TBC -= length;
+    if (ym2612_status.TBC <= 0)
+    {
+      if (ym2612_status.mode & 0x08)
+        ym2612_status.status |= 0x02;
+      do
+      {
+        ym2612_status.TBC += ym2612_status.TBL;
+      }
+      while (ym2612_status.TBC <= 0);
+    }
+  }
+}
+
+unsigned int YM2612StatusRead(void)
+{
+  return ym2612_status.status;
+}
+
 /* Generate samples for ym2612 */
 void YM2612Update(int *buffer, int length)
 {
@@ -2032,6 +2413,13 @@ void YM2612Update(int *buffer, int length)
   refresh_fc_eg_chan(&ym2612.CH[4]);
   refresh_fc_eg_chan(&ym2612.CH[5]);
 
+#ifdef USE_YM2612_SIMD
+  if (ops_soa)
+  {
+    ops_load(ym2612.dacen ? 5 : 6);
+  }
+#endif
+
   /* buffering */
   for(i=0; i<length; i++)
   {
@@ -2049,13 +2437,13 @@ void YM2612Update(int *buffer, int length)
     /* calculate FM */
     if (!ym2612.dacen)
     {
-      chan_calc(&ym2612.CH[0],6);
+      channels_calc(6);
     }
     else
     {
       /* DAC Mode */
       out_fm[5] = ym2612.dacout;
-      chan_calc(&ym2612.CH[0],5);
+      channels_calc(5);
     }
 
     /* advance LFO */
@@ -2153,6 +2541,41 @@ void YM2612Update(int *buffer, int length)
     }
   }
 
+#ifdef USE_YM2612_SIMD
+  if (ops_soa)
+  {
+    ops_store(ym2612.dacen ? 5 : 6);
+  }
+#endif
+
+  /* timer B control */
+  INTERNAL_TIMER_B(length);
+}
+
+/* Run timers only, without sound generation (same as YM2612Update) */
+void YM2612UpdateTimers(int length)
+{
+  /* timer A & CSM mode Key OFF control (each sample) */
+  if ((ym2612.OPN.ST.mode & 0x01) || ym2612.OPN.SL3.key_csm)
+  {
+    int i;
+    for (i=0; i<length; i++)
+    {
+      ym2612.OPN.SL3.key_csm <<= 1;
+
+      INTERNAL_TIMER_A();
+
+      if (ym2612.OPN.SL3.key_csm & 2)
+      {
+        FM_KEYOFF_CSM(&ym2612.CH[2],SLOT1);
+        FM_KEYOFF_CSM(&ym2612.CH[2],SLOT2);
+        FM_KEYOFF_CSM(&ym2612.CH[2],SLOT3);
+        FM_KEYOFF_CSM(&ym2612.CH[2],SLOT4);
+        ym2612.OPN.SL3.key_csm = 0;
+      }
+    }
+  }
+
   /* timer B control */
   INTERNAL_TIMER_B(length);
 }
@@ -2205,6 +2628,14 @@ void YM2612Config(int type)
   }
 }
 
+#ifdef USE_YM2612_SIMD
+/* select operators evaluation: 0 = one channel at a time (chan_calc), 1 = all channels at once (ops_calc) */
+void YM2612SelectOperators(int soa)
+{
+  ops_soa = soa;
+}
+#endif
+
 int YM2612LoadContext(unsigned char *state)
 {
   int c,s;
@@ -2236,6 +2667,13 @@ int YM2612LoadContext(unsigned char *state)
   return bufferptr;
 }
 
+/* length of YM2612SaveContext data */
+int YM2612GetContextSize(void)
+{
+  /* DT table indexes are counted twice (see YM2612SaveContext) */
+  return sizeof(ym2612) + 2 * 6 * 4 * sizeof(uint8);
+}
+
 int YM2612SaveContext(unsigned char *state)
 {
   int c,s;
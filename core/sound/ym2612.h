@@ -26,9 +26,22 @@ extern void YM2612Init(void);
 extern void YM2612Config(int type);
 extern void YM2612ResetChip(void);
 extern void YM2612Update(int *buffer, int length);
+extern void YM2612UpdateTimers(int length);
 extern void YM2612Write(unsigned int a, unsigned int v);
 extern unsigned int YM2612Read(void);
+extern void YM2612StatusInit(void);
+extern void YM2612StatusReset(void);
+extern void YM2612StatusWrite(unsigned int a, unsigned int v);
+extern void YM2612StatusUpdate(int length);
+extern unsigned int YM2612StatusRead(void);
 extern int YM2612LoadContext(unsigned char *state);
 extern int YM2612SaveContext(unsigned char *state);
+extern int YM2612GetContextSize(void);
+#ifdef BUILD_TABLES
+extern void YM2612GetTables(const void *tables[3]);
+#endif
+#ifdef USE_YM2612_SIMD
+extern void YM2612SelectOperators(int soa);
+#endif
 
 #endif /* _YM2612_ */
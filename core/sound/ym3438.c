@@ -29,6 +29,7 @@
  */
 
 #include <string.h>
+#include "macros.h"
 #include "ym3438.h"
 
 #define SIGN_EXTEND(bit_index, value) (((value) & ((1u << (bit_index)) - 1u)) - ((value) & (1u << (bit_index))))
@@ -220,9 +221,29 @@ static const Bit32u fm_algorithm[4][6][8] = {
     }
 };
 
-static Bit32u chip_type = ym3438_mode_readmode;
+/* Slot & channel of cycle + n (n < 24), to avoid divisions on each cycle */
+static const Bit8u slot_mod24[48] = {
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11,
+    12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11,
+    12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23
+};
+
+static const Bit8u slot_mod12[24] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11
+};
+
+static const Bit8u slot_mod6[48] = {
+    0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5,
+    0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5,
+    0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5,
+    0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5
+};
 
-static void OPN2_DoIO(ym3438_t *chip)
+static THREAD_LOCAL Bit32u chip_type = ym3438_mode_readmode;
+
+INLINE void OPN2_DoIO(ym3438_t *chip)
 {
     /* Write signal check */
     chip->write_a_en = (chip->write_a & 0x03) == 0x01;
@@ -236,12 +257,12 @@ static void OPN2_DoIO(ym3438_t *chip)
     chip->write_busy_cnt &= 0x1f;
 }
 
-static void OPN2_DoRegWrite(ym3438_t *chip)
+INLINE void OPN2_DoRegWrite(ym3438_t *chip, Bit32u cycles)
 {
     Bit32u i;
-    Bit32u slot = chip->cycles % 12;
+    Bit32u slot = slot_mod12[cycles];
     Bit32u address;
-    Bit32u channel = chip->channel;
+    Bit32u channel = slot_mod6[cycles];
     /* Update registers */
     if (chip->write_fm_data)
     {
@@ -455,10 +476,10 @@ static void OPN2_DoRegWrite(ym3438_t *chip)
     }
 }
 
-static void OPN2_PhaseCalcIncrement(ym3438_t *chip)
+INLINE void OPN2_PhaseCalcIncrement(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u chan = chip->channel;
-    Bit32u slot = chip->cycles;
+    Bit32u chan = slot_mod6[cycles];
+    Bit32u slot = cycles;
     Bit32u fnum = chip->pg_fnum;
     Bit32u fnum_h = fnum >> 4;
     Bit32u fm;
@@ -524,17 +545,17 @@ static void OPN2_PhaseCalcIncrement(ym3438_t *chip)
     chip->pg_inc[slot] &= 0xfffff;
 }
 
-static void OPN2_PhaseGenerate(ym3438_t *chip)
+INLINE void OPN2_PhaseGenerate(ym3438_t *chip, Bit32u cycles)
 {
     Bit32u slot;
     /* Mask increment */
-    slot = (chip->cycles + 20) % 24;
+    slot = slot_mod24[cycles + 20];
     if (chip->pg_reset[slot])
     {
         chip->pg_inc[slot] = 0;
     }
     /* Phase step */
-    slot = (chip->cycles + 19) % 24;
+    slot = slot_mod24[cycles + 19];
     if (chip->pg_reset[slot] || chip->mode_test_21[3])
     {
         chip->pg_phase[slot] = 0;
@@ -543,9 +564,9 @@ static void OPN2_PhaseGenerate(ym3438_t *chip)
     chip->pg_phase[slot] &= 0xfffff;
 }
 
-static void OPN2_EnvelopeSSGEG(ym3438_t *chip)
+INLINE void OPN2_EnvelopeSSGEG(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u slot = chip->cycles;
+    Bit32u slot = cycles;
     Bit8u direction = 0;
     chip->eg_ssg_pgrst_latch[slot] = 0;
     chip->eg_ssg_repeat_latch[slot] = 0;
@@ -589,9 +610,9 @@ static void OPN2_EnvelopeSSGEG(ym3438_t *chip)
                            & chip->eg_kon[slot];
 }
 
-static void OPN2_EnvelopeADSR(ym3438_t *chip)
+INLINE void OPN2_EnvelopeADSR(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u slot = (chip->cycles + 22) % 24;
+    Bit32u slot = slot_mod24[cycles + 22];
 
     Bit8u nkon = chip->eg_kon_latch[slot];
     Bit8u okon = chip->eg_kon[slot];
@@ -713,12 +734,12 @@ static void OPN2_EnvelopeADSR(ym3438_t *chip)
     chip->eg_state[slot] = nextstate;
 }
 
-static void OPN2_EnvelopePrepare(ym3438_t *chip)
+INLINE void OPN2_EnvelopePrepare(ym3438_t *chip, Bit32u cycles)
 {
     Bit8u rate;
     Bit8u sum;
     Bit8u inc = 0;
-    Bit32u slot = chip->cycles;
+    Bit32u slot = cycles;
     Bit8u rate_sel;
 
     /* Prepare increment */
@@ -788,7 +809,7 @@ static void OPN2_EnvelopePrepare(ym3438_t *chip)
     chip->eg_ksv = chip->pg_kcode >> (chip->ks[slot] ^ 0x03);
     if (chip->am[slot])
     {
-        chip->eg_lfo_am = chip->lfo_am >> eg_am_shift[chip->ams[chip->channel]];
+        chip->eg_lfo_am = chip->lfo_am >> eg_am_shift[chip->ams[slot_mod6[cycles]]];
     }
     else
     {
@@ -801,9 +822,9 @@ static void OPN2_EnvelopePrepare(ym3438_t *chip)
     chip->eg_sl[0] = chip->sl[slot];
 }
 
-static void OPN2_EnvelopeGenerate(ym3438_t *chip)
+INLINE void OPN2_EnvelopeGenerate(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u slot = (chip->cycles + 23) % 24;
+    Bit32u slot = slot_mod24[cycles + 23];
     Bit16u level;
 
     level = chip->eg_level[slot];
@@ -823,7 +844,7 @@ static void OPN2_EnvelopeGenerate(ym3438_t *chip)
     level += chip->eg_lfo_am;
 
     /* Apply TL */
-    if (!(chip->mode_csm && chip->channel == 2 + 1))
+    if (!(chip->mode_csm && slot_mod6[cycles] == 2 + 1))
     {
         level += chip->eg_tl[0] << 3;
     }
@@ -834,7 +855,7 @@ static void OPN2_EnvelopeGenerate(ym3438_t *chip)
     chip->eg_out[slot] = level;
 }
 
-static void OPN2_UpdateLFO(ym3438_t *chip)
+INLINE void OPN2_UpdateLFO(ym3438_t *chip)
 {
     if ((chip->lfo_quotient & lfo_cycles[chip->lfo_freq]) == lfo_cycles[chip->lfo_freq])
     {
@@ -848,14 +869,14 @@ static void OPN2_UpdateLFO(ym3438_t *chip)
     chip->lfo_cnt &= chip->lfo_en;
 }
 
-static void OPN2_FMPrepare(ym3438_t *chip)
+INLINE void OPN2_FMPrepare(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u slot = (chip->cycles + 6) % 24;
-    Bit32u channel = chip->channel;
+    Bit32u slot = slot_mod24[cycles + 6];
+    Bit32u channel = slot_mod6[cycles];
     Bit16s mod, mod1, mod2;
     Bit32u op = slot / 6;
     Bit8u connect = chip->connect[channel];
-    Bit32u prevslot = (chip->cycles + 18) % 24;
+    Bit32u prevslot = slot_mod24[cycles + 18];
 
     /* Calculate modulation */
     mod1 = mod2 = 0;
@@ -896,7 +917,7 @@ static void OPN2_FMPrepare(ym3438_t *chip)
     }
     chip->fm_mod[slot] = mod;
 
-    slot = (chip->cycles + 18) % 24;
+    slot = slot_mod24[cycles + 18];
     /* OP1 */
     if (slot / 6 == 0)
     {
@@ -910,10 +931,10 @@ static void OPN2_FMPrepare(ym3438_t *chip)
     }
 }
 
-static void OPN2_ChGenerate(ym3438_t *chip)
+INLINE void OPN2_ChGenerate(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u slot = (chip->cycles + 18) % 24;
-    Bit32u channel = chip->channel;
+    Bit32u slot = slot_mod24[cycles + 18];
+    Bit32u channel = slot_mod6[cycles];
     Bit32u op = slot / 6;
     Bit32u test_dac = chip->mode_test_2c[5];
     Bit16s acc = chip->ch_acc[channel];
@@ -945,11 +966,10 @@ static void OPN2_ChGenerate(ym3438_t *chip)
     chip->ch_acc[channel] = sum;
 }
 
-static void OPN2_ChOutput(ym3438_t *chip)
+INLINE void OPN2_ChOutput(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u cycles = chip->cycles;
-    Bit32u slot = chip->cycles;
-    Bit32u channel = chip->channel;
+    Bit32u slot = cycles;
+    Bit32u channel = slot_mod6[cycles];
     Bit32u test_dac = chip->mode_test_2c[5];
     Bit16s out;
     Bit16s sign;
@@ -1027,22 +1047,17 @@ static void OPN2_ChOutput(ym3438_t *chip)
     }
 }
 
-static void OPN2_FMGenerate(ym3438_t *chip)
+INLINE void OPN2_FMGenerate(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u slot = (chip->cycles + 19) % 24;
+    Bit32u slot = slot_mod24[cycles + 19];
     /* Calculate phase */
     Bit16u phase = (chip->fm_mod[slot] + (chip->pg_phase[slot] >> 10)) & 0x3ff;
     Bit16u quarter;
     Bit16u level;
     Bit16s output;
-    if (phase & 0x100)
-    {
-        quarter = (phase ^ 0xff) & 0xff;
-    }
-    else
-    {
-        quarter = phase & 0xff;
-    }
+    Bit32s sign;
+    /* Mirror second quarter */
+    quarter = (phase ^ (0xff * ((phase >> 8) & 0x01))) & 0xff;
     level = logsinrom[quarter];
     /* Apply envelope */
     level += chip->eg_out[slot] << 2;
@@ -1052,24 +1067,20 @@ static void OPN2_FMGenerate(ym3438_t *chip)
         level = 0x1fff;
     }
     output = ((exprom[(level & 0xff) ^ 0xff] | 0x400) << 2) >> (level >> 8);
-    if (phase & 0x200)
-    {
-        output = ((~output) ^ (chip->mode_test_21[4] << 13)) + 1;
-    }
-    else
-    {
-        output = output ^ (chip->mode_test_21[4] << 13);
-    }
+    output ^= chip->mode_test_21[4] << 13;
+    /* Negate second half (~output + 1) */
+    sign = -((phase >> 9) & 0x01);
+    output = (output ^ sign) - sign;
     output = SIGN_EXTEND(13, output);
     chip->fm_out[slot] = output;
 }
 
-static void OPN2_DoTimerA(ym3438_t *chip)
+INLINE void OPN2_DoTimerA(ym3438_t *chip, Bit32u cycles)
 {
     Bit16u time;
     Bit8u load;
     load = chip->timer_a_overflow;
-    if (chip->cycles == 2)
+    if (cycles == 2)
     {
         /* Lock load value */
         load |= (!chip->timer_a_load_lock && chip->timer_a_load);
@@ -1095,7 +1106,7 @@ static void OPN2_DoTimerA(ym3438_t *chip)
     }
     chip->timer_a_load_latch = load;
     /* Increase counter */
-    if ((chip->cycles == 1 && chip->timer_a_load_lock) || chip->mode_test_21[2])
+    if ((cycles == 1 && chip->timer_a_load_lock) || chip->mode_test_21[2])
     {
         time++;
     }
@@ -1113,12 +1124,12 @@ static void OPN2_DoTimerA(ym3438_t *chip)
     chip->timer_a_cnt = time & 0x3ff;
 }
 
-static void OPN2_DoTimerB(ym3438_t *chip)
+INLINE void OPN2_DoTimerB(ym3438_t *chip, Bit32u cycles)
 {
     Bit16u time;
     Bit8u load;
     load = chip->timer_b_overflow;
-    if (chip->cycles == 2)
+    if (cycles == 2)
     {
         /* Lock load value */
         load |= (!chip->timer_b_load_lock && chip->timer_b_load);
@@ -1135,7 +1146,7 @@ static void OPN2_DoTimerB(ym3438_t *chip)
     }
     chip->timer_b_load_latch = load;
     /* Increase counter */
-    if (chip->cycles == 1)
+    if (cycles == 1)
     {
         chip->timer_b_subcnt++;
     }
@@ -1158,20 +1169,20 @@ static void OPN2_DoTimerB(ym3438_t *chip)
     chip->timer_b_cnt = time & 0xff;
 }
 
-static void OPN2_KeyOn(ym3438_t*chip)
+INLINE void OPN2_KeyOn(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u slot = chip->cycles;
-    Bit32u chan = chip->channel;
+    Bit32u slot = cycles;
+    Bit32u chan = slot_mod6[cycles];
     /* Key On */
     chip->eg_kon_latch[slot] = chip->mode_kon[slot];
     chip->eg_kon_csm[slot] = 0;
-    if (chip->channel == 2 && chip->mode_kon_csm)
+    if (slot_mod6[cycles] == 2 && chip->mode_kon_csm)
     {
         /* CSM Key On */
         chip->eg_kon_latch[slot] = 1;
         chip->eg_kon_csm[slot] = 1;
     }
-    if (chip->cycles == chip->mode_kon_channel)
+    if (cycles == chip->mode_kon_channel)
     {
         /* OP1 */
         chip->mode_kon[chan] = chip->mode_kon_operator[0];
@@ -1207,15 +1218,16 @@ void OPN2_SetChipType(Bit32u type)
     chip_type = type;
 }
 
-void OPN2_Clock(ym3438_t *chip, Bit16s *buffer)
+/* Run one chip cycle (cycles = chip->cycles) */
+INLINE void OPN2_DoClock(ym3438_t *chip, Bit32u cycles)
 {
-    Bit32u slot = chip->cycles;
+    Bit32u slot = cycles;
     chip->lfo_inc = chip->mode_test_21[1];
     chip->pg_read >>= 1;
     chip->eg_read[1] >>= 1;
     chip->eg_cycle++;
     /* Lock envelope generator timer value */
-    if (chip->cycles == 1 && chip->eg_quotient == 2)
+    if (cycles == 1 && chip->eg_quotient == 2)
     {
         if (chip->eg_cycle_stop)
         {
@@ -1228,7 +1240,7 @@ void OPN2_Clock(ym3438_t *chip, Bit16s *buffer)
         chip->eg_timer_low_lock = chip->eg_timer & 0x03;
     }
     /* Cycle specific functions */
-    switch (chip->cycles)
+    switch (cycles)
     {
     case 0:
         chip->lfo_pm = chip->lfo_cnt >> 2;
@@ -1278,23 +1290,23 @@ void OPN2_Clock(ym3438_t *chip, Bit16s *buffer)
 
     OPN2_DoIO(chip);
 
-    OPN2_DoTimerA(chip);
-    OPN2_DoTimerB(chip);
-    OPN2_KeyOn(chip);
+    OPN2_DoTimerA(chip, cycles);
+    OPN2_DoTimerB(chip, cycles);
+    OPN2_KeyOn(chip, cycles);
 
-    OPN2_ChOutput(chip);
-    OPN2_ChGenerate(chip);
+    OPN2_ChOutput(chip, cycles);
+    OPN2_ChGenerate(chip, cycles);
 
-    OPN2_FMPrepare(chip);
-    OPN2_FMGenerate(chip);
+    OPN2_FMPrepare(chip, cycles);
+    OPN2_FMGenerate(chip, cycles);
 
-    OPN2_PhaseGenerate(chip);
-    OPN2_PhaseCalcIncrement(chip);
+    OPN2_PhaseGenerate(chip, cycles);
+    OPN2_PhaseCalcIncrement(chip, cycles);
 
-    OPN2_EnvelopeADSR(chip);
-    OPN2_EnvelopeGenerate(chip);
-    OPN2_EnvelopeSSGEG(chip);
-    OPN2_EnvelopePrepare(chip);
+    OPN2_EnvelopeADSR(chip, cycles);
+    OPN2_EnvelopeGenerate(chip, cycles);
+    OPN2_EnvelopeSSGEG(chip, cycles);
+    OPN2_EnvelopePrepare(chip, cycles);
 
     /* Prepare fnum & block */
     if (chip->mode_ch3)
@@ -1319,29 +1331,45 @@ void OPN2_Clock(ym3438_t *chip, Bit16s *buffer)
             break;
         case 19: /* OP4 */
         default:
-            chip->pg_fnum = chip->fnum[(chip->channel + 1) % 6];
-            chip->pg_block = chip->block[(chip->channel + 1) % 6];
-            chip->pg_kcode = chip->kcode[(chip->channel + 1) % 6];
+            chip->pg_fnum = chip->fnum[slot_mod6[cycles + 1]];
+            chip->pg_block = chip->block[slot_mod6[cycles + 1]];
+            chip->pg_kcode = chip->kcode[slot_mod6[cycles + 1]];
             break;
         }
     }
     else
     {
-        chip->pg_fnum = chip->fnum[(chip->channel + 1) % 6];
-        chip->pg_block = chip->block[(chip->channel + 1) % 6];
-        chip->pg_kcode = chip->kcode[(chip->channel + 1) % 6];
+        chip->pg_fnum = chip->fnum[slot_mod6[cycles + 1]];
+        chip->pg_block = chip->block[slot_mod6[cycles + 1]];
+        chip->pg_kcode = chip->kcode[slot_mod6[cycles + 1]];
     }
 
     OPN2_UpdateLFO(chip);
-    OPN2_DoRegWrite(chip);
-    chip->cycles = (chip->cycles + 1) % 24;
-    chip->channel = chip->cycles % 6;
+    OPN2_DoRegWrite(chip, cycles);
+    chip->cycles = slot_mod24[cycles + 1];
+    chip->channel = slot_mod6[cycles + 1];
+
+    if (chip->status_time)
+        chip->status_time--;
+}
+
+void OPN2_Clock(ym3438_t *chip, Bit16s *buffer)
+{
+    OPN2_DoClock(chip, chip->cycles);
 
     buffer[0] = chip->mol;
     buffer[1] = chip->mor;
+}
 
-    if (chip->status_time)
-        chip->status_time--;
+/* Run a number of chip cycles, storing output of each cycle (same as OPN2_Clock) */
+void OPN2_ClockBatch(ym3438_t *chip, Bit16s *buffer, Bit32u count)
+{
+    while (count--)
+    {
+        OPN2_DoClock(chip, chip->cycles);
+        *buffer++ = chip->mol;
+        *buffer++ = chip->mor;
+    }
 }
 
 void OPN2_Write(ym3438_t *chip, Bit32u port, Bit8u data)
@@ -1365,6 +1393,22 @@ void OPN2_SetTestPin(ym3438_t *chip, Bit32u value)
     chip->pin_test_in = value & 1;
 }
 
+/* Run one cycle of registers writes, timers & busy flag only (status register emulation) */
+void OPN2_ClockStatus(ym3438_t *chip)
+{
+    OPN2_DoIO(chip);
+
+    OPN2_DoTimerA(chip, chip->cycles);
+    OPN2_DoTimerB(chip, chip->cycles);
+
+    OPN2_DoRegWrite(chip, chip->cycles);
+    chip->channel = slot_mod6[chip->cycles + 1];
+    chip->cycles = slot_mod24[chip->cycles + 1];
+
+    if (chip->status_time)
+        chip->status_time--;
+}
+
 Bit32u OPN2_ReadTestPin(ym3438_t *chip)
 {
     if (!chip->mode_test_2c[7])
@@ -199,6 +199,8 @@ typedef struct
 void OPN2_Reset(ym3438_t *chip);
 void OPN2_SetChipType(Bit32u type);
 void OPN2_Clock(ym3438_t *chip, Bit16s *buffer);
+void OPN2_ClockBatch(ym3438_t *chip, Bit16s *buffer, Bit32u count);
+void OPN2_ClockStatus(ym3438_t *chip);
 void OPN2_Write(ym3438_t *chip, Bit32u port, Bit8u data);
 void OPN2_SetTestPin(ym3438_t *chip, Bit32u value);
 Bit32u OPN2_ReadTestPin(ym3438_t *chip);
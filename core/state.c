@@ -36,84 +36,217 @@
  *
  ****************************************************************************************/
 
+#include <time.h>
 #include "shared.h"
 
-int state_load(unsigned char *state)
+/* Savestate layout:
+
+   header : signature (8 bytes), total size (4 bytes), number of chunks (4 bytes)
+   chunks : identifier (4 bytes), data length (4 bytes), data checksum (4 bytes), data
+
+   Only chunks used by current system are saved. Chunks are loaded in the order they
+   were saved and chunks that are unknown or unused by current system are skipped.
+   The "VERS" chunk holds the version string used by chunk loaders to handle states
+   saved by previous versions.
+
+   States saved in previous linear format (starting with version string) are still supported.
+
+   Snapshots are meant for frequent save & restore within current session (run-ahead,
+   netplay rollback): chunks are stored back to back after a signature, without headers
+   nor checksums, and emulated hardware is not reset before they are restored, so that
+   display and pattern cache are kept. Audio output state (blip buffers, filters), which
+   is not part of savestates, is included so that rollbacks do not alter audio output,
+   as well as movie position, so that rolled back frames are not recorded nor replayed twice.
+   Snapshots are not portable: the signature is followed by a session identifier, which
+   changes whenever emulated hardware configuration changes, and snapshots saved by
+   another instance (e.g. netplay peer) or for another configuration are rejected.
+   Large memory blocks (saved with save_region) can also be left out of snapshots, so that
+   rewind history compares them in place instead of copying them (see rewind.c).
+*/
+
+#define STATE_SIGNATURE "GPGXSTAT"
+#define SNAPSHOT_SIGNATURE "GPGXSNAP"
+#define SNAPSHOT_HEADER_SIZE 12
+#define STATE_HEADER_SIZE 16
+#define CHUNK_HEADER_SIZE 12
+
+typedef struct
 {
-  int i, bufferptr = 0;
+  char id[5];
+  int (*save)(uint8 *state);
+  int (*load)(uint8 *state, char *version);
+  int (*size)(const uint8 *state);  /* chunk length, for chunks whose length depends on saved data (optional) */
+} t_state_chunk;
 
-  /* signature check (GENPLUS-GX x.x.x) */
-  char version[17];
-  load_param(version,16);
-  version[16] = 0;
-  if (memcmp(version,STATE_VERSION,11))
+#define STATE_CHUNKS_MAX 8
+
+/* savestate & snapshot sizes for current hardware configuration (see state_size) */
+static THREAD_LOCAL struct
+{
+  int save;
+  int snapshot;
+  int chunk[STATE_CHUNKS_MAX]; /* length of each chunk */
+  uint32 session;     /* snapshot session identifier */
+} sizes;
+
+/* memory blocks left in place by state_snapshot_save_regions */
+static THREAD_LOCAL struct
+{
+  t_state_region *list;
+  int count;
+  int max;
+} regions;
+
+/* set while a snapshot is restored */
+static THREAD_LOCAL int snapshot_loading;
+
+/* Fletcher-like checksum (data is processed as 32-bit words to keep savestates fast) */
+static uint32 state_checksum(const uint8 *data, uint32 length)
+{
+  uint32 a = 0, b = 0, word;
+
+  while (length >= 4)
   {
-    return 0;
+    memcpy(&word, data, 4);
+    a += word;
+    b += a;
+    data += 4;
+    length -= 4;
   }
 
-  /* version check */
-  if ((version[11] < 0x31) || (version[13] < 0x37) || (version[15] < 0x35))
+  while (length--)
   {
-    return 0;
+    a += *data++;
+    b += a;
   }
 
-  /* reset system */
-  system_reset();
+  return ((b << 16) | (b >> 16)) ^ a;
+}
 
-  /* enable VDP access for TMSS systems */
-  for (i=0xc0; i<0xe0; i+=8)
+/* writes chunk header in front of chunk data, returns chunk size */
+static int state_chunk_header(uint8 *state, const char *id, uint32 length)
+{
+  uint32 checksum = state_checksum(&state[CHUNK_HEADER_SIZE], length);
+  memcpy(&state[0], id, 4);
+  memcpy(&state[4], &length, 4);
+  memcpy(&state[8], &checksum, 4);
+  return CHUNK_HEADER_SIZE + length;
+}
+
+/*--------------------------------------------------------------------------*/
+/* Chunk handlers                                                           */
+/*--------------------------------------------------------------------------*/
+
+static int mram_save(uint8 *state)
+{
+  int bufferptr = 0;
+
+  if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
-    m68k.memory_map[i].read8    = vdp_read_byte;
-    m68k.memory_map[i].read16   = vdp_read_word;
-    m68k.memory_map[i].write8   = vdp_write_byte;
-    m68k.memory_map[i].write16  = vdp_write_word;
-    zbank_memory_map[i].read    = zbank_read_vdp;
-    zbank_memory_map[i].write   = zbank_write_vdp;
+    save_region(work_ram, sizeof(work_ram));
   }
+  else
+  {
+    save_region(work_ram, 0x2000);
+  }
+
+  return bufferptr;
+}
+
+static int mram_load(uint8 *state, char *version)
+{
+  int bufferptr = 0;
 
-  /* GENESIS */
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
     load_param(work_ram, sizeof(work_ram));
-    load_param(zram, sizeof(zram));
-    load_param(&zstate, sizeof(zstate));
-    load_param(&zbank, sizeof(zbank));
-    if (zstate == 3)
-    {
-      m68k.memory_map[0xa0].read8   = z80_read_byte;
-      m68k.memory_map[0xa0].read16  = z80_read_word;
-      m68k.memory_map[0xa0].write8  = z80_write_byte;
-      m68k.memory_map[0xa0].write16 = z80_write_word;
-    }
-    else
-    {
-      m68k.memory_map[0xa0].read8   = m68k_read_bus_8;
-      m68k.memory_map[0xa0].read16  = m68k_read_bus_16;
-      m68k.memory_map[0xa0].write8  = m68k_unused_8_w;
-      m68k.memory_map[0xa0].write16 = m68k_unused_16_w;
-    }
   }
   else
   {
     load_param(work_ram, 0x2000);
   }
 
-  /* IO */
+  return bufferptr;
+}
+
+static int zram_save(uint8 *state)
+{
+  int bufferptr = 0;
+
+  save_region(zram, sizeof(zram));
+  save_param(&zstate, sizeof(zstate));
+  save_param(&zbank, sizeof(zbank));
+
+  return bufferptr;
+}
+
+static int zram_load(uint8 *state, char *version)
+{
+  int bufferptr = 0;
+
+  load_param(zram, sizeof(zram));
+  load_param(&zstate, sizeof(zstate));
+  load_param(&zbank, sizeof(zbank));
+
+  if (zstate == 3)
+  {
+    m68k.memory_map[0xa0].read8   = z80_read_byte;
+    m68k.memory_map[0xa0].read16  = z80_read_word;
+    m68k.memory_map[0xa0].write8  = z80_write_byte;
+    m68k.memory_map[0xa0].write16 = z80_write_word;
+  }
+  else
+  {
+    m68k.memory_map[0xa0].read8   = m68k_read_bus_8;
+    m68k.memory_map[0xa0].read16  = m68k_read_bus_16;
+    m68k.memory_map[0xa0].write8  = m68k_unused_8_w;
+    m68k.memory_map[0xa0].write16 = m68k_unused_16_w;
+  }
+
+  return bufferptr;
+}
+
+static int io_save(uint8 *state)
+{
+  int bufferptr = 0;
+  save_param(io_reg, sizeof(io_reg));
+  return bufferptr;
+}
+
+static int io_load(uint8 *state, char *version)
+{
+  int bufferptr = 0;
+
   load_param(io_reg, sizeof(io_reg));
+
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
-    io_reg[0] = region_code | 0x20 | (config.bios & 1);
+    /* CD unit detection (see io_reset) */
+    io_reg[0] = region_code | ((system_hw != SYSTEM_MCD) ? 0x20 : 0x00) | (config.bios & 1);
   }
   else
   {
     io_reg[0] = 0x80 | (region_code >> 1);
   }
 
-  /* VDP */
-  bufferptr += vdp_context_load(&state[bufferptr]);
+  return bufferptr;
+}
+
+static int vdp_load(uint8 *state, char *version)
+{
+  return vdp_context_load(state);
+}
+
+static int snd_load(uint8 *state, char *version)
+{
+  int bufferptr = sound_context_load(state);
+
+  /* PSG output state is restored as is with snapshots (see audio_context_load) */
+  if (snapshot_loading)
+  {
+    return bufferptr;
+  }
 
-  /* SOUND */
-  bufferptr += sound_context_load(&state[bufferptr]);
   if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
   {
     psg_config(0, config.psg_preamp, 0xff);
@@ -123,68 +256,382 @@ int state_load(unsigned char *state)
     psg_config(0, config.psg_preamp, io_reg[6]);
   }
 
-  /* 68000 */
-  if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
+  return bufferptr;
+}
+
+static int m68k_save(uint8 *state)
+{
+  int bufferptr = 0;
+  uint16 tmp16;
+  uint32 tmp32;
+
+  /* D0-D7 & A0-A7 */
+  save_param(m68k.dar, sizeof(m68k.dar));
+
+  tmp32 = m68k_get_reg(M68K_REG_PC);  save_param(&tmp32, 4);
+  tmp16 = m68k_get_reg(M68K_REG_SR);  save_param(&tmp16, 2);
+  tmp32 = m68k_get_reg(M68K_REG_USP); save_param(&tmp32, 4);
+  tmp32 = m68k_get_reg(M68K_REG_ISP); save_param(&tmp32, 4);
+
+  save_param(&m68k.cycles, sizeof(m68k.cycles));
+  save_param(&m68k.int_level, sizeof(m68k.int_level));
+  save_param(&m68k.stopped, sizeof(m68k.stopped));
+
+  return bufferptr;
+}
+
+static int m68k_load(uint8 *state, char *version)
+{
+  int bufferptr = 0;
+  uint16 tmp16;
+  uint32 tmp32;
+
+  /* D0-D7 & A0-A7 */
+  load_param(m68k.dar, sizeof(m68k.dar));
+
+  /* SR must be restored after A7 (active stack pointer) and before USP & ISP */
+  load_param(&tmp32, 4); m68k_set_reg(M68K_REG_PC, tmp32);
+  load_param(&tmp16, 2); m68k_set_reg(M68K_REG_SR, tmp16);
+  load_param(&tmp32, 4); m68k_set_reg(M68K_REG_USP,tmp32);
+  load_param(&tmp32, 4); m68k_set_reg(M68K_REG_ISP,tmp32);
+
+  load_param(&m68k.cycles, sizeof(m68k.cycles));
+  load_param(&m68k.int_level, sizeof(m68k.int_level));
+  load_param(&m68k.stopped, sizeof(m68k.stopped));
+
+  return bufferptr;
+}
+
+/* CPU timing state, not part of savestates (see state_snapshot_save) */
+static int cpu_timing_save(uint8 *state)
+{
+  int bufferptr = 0;
+
+  save_param(&m68k.poll, sizeof(m68k.poll));
+  save_param(&m68k.refresh_cycles, sizeof(m68k.refresh_cycles));
+  save_param(&m68k.ir, sizeof(m68k.ir));
+
+  if (system_hw == SYSTEM_MCD)
   {
-    uint16 tmp16;
-    uint32 tmp32;
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_D0, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_D1, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_D2, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_D3, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_D4, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_D5, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_D6, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_D7, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_A0, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_A1, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_A2, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_A3, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_A4, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_A5, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_A6, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_A7, tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_PC, tmp32);  
-    load_param(&tmp16, 2); m68k_set_reg(M68K_REG_SR, tmp16);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_USP,tmp32);
-    load_param(&tmp32, 4); m68k_set_reg(M68K_REG_ISP,tmp32);
-
-    load_param(&m68k.cycles, sizeof(m68k.cycles));
-    load_param(&m68k.int_level, sizeof(m68k.int_level));
-    load_param(&m68k.stopped, sizeof(m68k.stopped));
-  }
-
-  /* Z80 */ 
+    save_param(&s68k.poll, sizeof(s68k.poll));
+    save_param(&s68k.refresh_cycles, sizeof(s68k.refresh_cycles));
+    save_param(&s68k.ir, sizeof(s68k.ir));
+  }
+
+  return bufferptr;
+}
+
+static int cpu_timing_load(uint8 *state)
+{
+  int bufferptr = 0;
+
+  load_param(&m68k.poll, sizeof(m68k.poll));
+  load_param(&m68k.refresh_cycles, sizeof(m68k.refresh_cycles));
+  load_param(&m68k.ir, sizeof(m68k.ir));
+
+  if (system_hw == SYSTEM_MCD)
+  {
+    load_param(&s68k.poll, sizeof(s68k.poll));
+    load_param(&s68k.refresh_cycles, sizeof(s68k.refresh_cycles));
+    load_param(&s68k.ir, sizeof(s68k.ir));
+  }
+
+  return bufferptr;
+}
+
+static int z80_save(uint8 *state)
+{
+  int bufferptr = 0;
+  save_param(&Z80, sizeof(Z80_Regs));
+  return bufferptr;
+}
+
+static int z80_load(uint8 *state, char *version)
+{
+  int bufferptr = 0;
   load_param(&Z80, sizeof(Z80_Regs));
   Z80.irq_callback = z80_irq_callback;
+  return bufferptr;
+}
+
+static int md_cart_load(uint8 *state, char *version)
+{
+  return md_cart_context_load(state);
+}
+
+static int sms_cart_load(uint8 *state, char *version)
+{
+  int bufferptr = sms_cart_context_load(state);
+  sms_cart_switch(~io_reg[0x0E]);
+  return bufferptr;
+}
+
+/* chunks used by Mega Drive / Genesis */
+static const t_state_chunk md_chunks[] =
+{
+  {"MRAM", mram_save,            mram_load},
+  {"ZRAM", zram_save,            zram_load},
+  {"IO  ", io_save,              io_load},
+  {"VDP ", vdp_context_save,     vdp_load},
+  {"SND ", sound_context_save,   snd_load, sound_context_size},
+  {"M68K", m68k_save,            m68k_load},
+  {"Z80 ", z80_save,             z80_load},
+  {"CART", md_cart_context_save, md_cart_load},
+  {"", NULL, NULL}
+};
+
+/* chunks used by Mega CD / Sega CD */
+static const t_state_chunk scd_chunks[] =
+{
+  {"MRAM", mram_save,            mram_load},
+  {"ZRAM", zram_save,            zram_load},
+  {"IO  ", io_save,              io_load},
+  {"VDP ", vdp_context_save,     vdp_load},
+  {"SND ", sound_context_save,   snd_load, sound_context_size},
+  {"M68K", m68k_save,            m68k_load},
+  {"Z80 ", z80_save,             z80_load},
+  {"SCD ", scd_context_save,     scd_context_load},
+  {"", NULL, NULL}
+};
+
+/* chunks used by 8-bit systems */
+static const t_state_chunk sms_chunks[] =
+{
+  {"MRAM", mram_save,             mram_load},
+  {"IO  ", io_save,               io_load},
+  {"VDP ", vdp_context_save,      vdp_load},
+  {"SND ", sound_context_save,    snd_load, sound_context_size},
+  {"Z80 ", z80_save,              z80_load},
+  {"CART", sms_cart_context_save, sms_cart_load},
+  {"", NULL, NULL}
+};
 
-  /* Extra HW */
+static const t_state_chunk *state_chunks(void)
+{
   if (system_hw == SYSTEM_MCD)
   {
-    /* handle case of MD cartridge using or not CD hardware */
-    char id[5];
-    load_param(id,4);
-    id[4] = 0;
+    return scd_chunks;
+  }
+  else if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
+  {
+    return md_chunks;
+  }
+  else
+  {
+    return sms_chunks;
+  }
+}
+
+/*--------------------------------------------------------------------------*/
+/* Savestate load & save                                                    */
+/*--------------------------------------------------------------------------*/
+
+static void state_load_init(int reset)
+{
+  int i;
+
+  /* reset system */
+  if (reset)
+  {
+    system_reset();
+  }
+
+  /* enable VDP access for TMSS systems */
+  for (i=0xc0; i<0xe0; i+=8)
+  {
+    m68k.memory_map[i].read8    = vdp_read_byte;
+    m68k.memory_map[i].read16   = vdp_read_word;
+    m68k.memory_map[i].write8   = vdp_write_byte;
+    m68k.memory_map[i].write16  = vdp_write_word;
+    zbank_memory_map[i].read    = zbank_read_vdp;
+    zbank_memory_map[i].write   = zbank_write_vdp;
+  }
+}
+
+/* previous linear savestate format */
+static int state_load_linear(unsigned char *state, int size)
+{
+  const t_state_chunk *chunk;
+  char version[17];
+  int bufferptr = 0;
+
+  /* chunks have no length: data is only known to fit in a full size savestate */
+  if (size < STATE_SIZE)
+  {
+    return 0;
+  }
+
+  /* signature check (GENPLUS-GX x.x.x) */
+  load_param(version,16);
+  version[16] = 0;
+  if (memcmp(version,STATE_VERSION,11))
+  {
+    return 0;
+  }
 
-    /* check if CD hardware was enabled before attempting to restore */
-    if (memcmp(id,"SCD!",4))
+  /* version check */
+  if ((version[11] < 0x31) || (version[13] < 0x37) || (version[15] < 0x35))
+  {
+    return 0;
+  }
+
+  state_load_init(1);
+
+  /* chunks were saved in same order, without headers */
+  for (chunk = state_chunks(); chunk->id[0]; chunk++)
+  {
+    if (!memcmp(chunk->id, "SCD ", 4))
     {
-       return 0;
+      /* handle case of MD cartridge using or not CD hardware */
+      char id[5];
+      load_param(id,4);
+      id[4] = 0;
+
+      /* check if CD hardware was enabled before attempting to restore */
+      if (memcmp(id,"SCD!",4))
+      {
+         return 0;
+      }
     }
 
-    /* CD hardware */
-    bufferptr += scd_context_load(&state[bufferptr], version);
+    bufferptr += chunk->load(&state[bufferptr], version);
   }
-  else if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
-  {  
-    /* MD cartridge hardware */
-    bufferptr += md_cart_context_load(&state[bufferptr]);
+
+  return bufferptr;
+}
+
+int state_load(unsigned char *state, int size)
+{
+  const t_state_chunk *chunk;
+  char version[17];
+  uint32 count, length, checksum;
+  uint32 i, found = 0;
+  uint8 *id;
+  int bufferptr;
+
+  if (size < STATE_HEADER_SIZE)
+  {
+    return 0;
   }
-  else
+
+  if (!memcmp(state, SNAPSHOT_SIGNATURE, 8))
+  {
+    /* snapshot layout is fixed for current hardware configuration */
+    if (!state_size() || (size < sizes.snapshot))
+    {
+      return 0;
+    }
+    return state_snapshot_load(state);
+  }
+
+  if (memcmp(state, STATE_SIGNATURE, 8))
+  {
+    return state_load_linear(state, size);
+  }
+
+  /* savestate size can not exceed provided data */
+  memcpy(&length, &state[8], 4);
+  memcpy(&count, &state[12], 4);
+  if ((length < STATE_HEADER_SIZE) || (length > (uint32)size) || (length > STATE_SIZE))
+  {
+    return 0;
+  }
+  size = length;
+
+  /* chunk lengths expected by current hardware configuration */
+  if (!state_size())
+  {
+    return 0;
+  }
+
+  /* check chunks integrity & lengths before modifying anything: chunk loaders read */
+  /* as much data as current hardware configuration needs, whatever chunk length is */
+  memset(version, 0, sizeof(version));
+  bufferptr = STATE_HEADER_SIZE;
+  for (i = 0; i < count; i++)
+  {
+    int index, expected;
+
+    if ((bufferptr + CHUNK_HEADER_SIZE) > size)
+    {
+      return 0;
+    }
+
+    id = &state[bufferptr];
+    memcpy(&length, &state[bufferptr + 4], 4);
+    memcpy(&checksum, &state[bufferptr + 8], 4);
+    bufferptr += CHUNK_HEADER_SIZE;
+
+    if ((length > (size - bufferptr)) || (state_checksum(&state[bufferptr], length) != checksum))
+    {
+      return 0;
+    }
+
+    if (!memcmp(id, "VERS", 4))
+    {
+      memcpy(version, &state[bufferptr], (length < 16) ? length : 16);
+    }
+
+    /* mark chunks used by current system */
+    for (chunk = state_chunks(), index = 0; chunk->id[0]; chunk++, index++)
+    {
+      if (!memcmp(chunk->id, id, 4))
+      {
+        /* some chunks length also depends on saved data (FM core) */
+        expected = sizes.chunk[index];
+        if (chunk->size && length)
+        {
+          expected = chunk->size(&state[bufferptr]);
+        }
+
+        if (length != (uint32)expected)
+        {
+          return 0;
+        }
+        found |= (1 << index);
+      }
+    }
+
+    bufferptr += length;
+  }
+
+  /* version check (GENPLUS-GX x.x.x) */
+  if (memcmp(version,STATE_VERSION,11) || (version[11] < 0x31) || (version[13] < 0x37) || (version[15] < 0x35))
+  {
+    return 0;
+  }
+
+  /* all chunks used by current system are required */
+  for (chunk = state_chunks(), i = 0; chunk->id[0]; chunk++, i++)
   {
-    /* MS cartridge hardware */
-    bufferptr += sms_cart_context_load(&state[bufferptr]);
-    sms_cart_switch(~io_reg[0x0E]);
+    if (!(found & (1 << i)))
+    {
+      return 0;
+    }
+  }
+
+  state_load_init(1);
+
+  bufferptr = STATE_HEADER_SIZE;
+  for (i = 0; i < count; i++)
+  {
+    id = &state[bufferptr];
+    memcpy(&length, &state[bufferptr + 4], 4);
+    bufferptr += CHUNK_HEADER_SIZE;
+
+    for (chunk = state_chunks(); chunk->id[0]; chunk++)
+    {
+      if (!memcmp(chunk->id, id, 4))
+      {
+        if (chunk->load(&state[bufferptr], version) != (int)length)
+        {
+          return 0;
+        }
+        break;
+      }
+    }
+
+    bufferptr += length;
   }
 
   return bufferptr;
@@ -192,92 +639,163 @@ int state_load(unsigned char *state)
 
 int state_save(unsigned char *state)
 {
-  /* buffer size */
-  int bufferptr = 0;
+  const t_state_chunk *chunk;
+  uint32 size, count = 1;
+  int bufferptr = STATE_HEADER_SIZE;
 
   /* version string */
-  char version[16];
-  memcpy(version,STATE_VERSION,16);
-  save_param(version, 16);
+  memcpy(&state[bufferptr + CHUNK_HEADER_SIZE], STATE_VERSION, 16);
+  bufferptr += state_chunk_header(&state[bufferptr], "VERS", 16);
 
-  /* GENESIS */
-  if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
+  for (chunk = state_chunks(); chunk->id[0]; chunk++)
   {
-    save_param(work_ram, sizeof(work_ram));
-    save_param(zram, sizeof(zram));
-    save_param(&zstate, sizeof(zstate));
-    save_param(&zbank, sizeof(zbank));
+    int length = chunk->save(&state[bufferptr + CHUNK_HEADER_SIZE]);
+    bufferptr += state_chunk_header(&state[bufferptr], chunk->id, length);
+    count++;
   }
-  else
+
+  /* header */
+  size = bufferptr;
+  memcpy(state, STATE_SIGNATURE, 8);
+  memcpy(&state[8], &size, 4);
+  memcpy(&state[12], &count, 4);
+
+  /* return total size */
+  return bufferptr;
+}
+
+/* largest of savestate & snapshot sizes, only measured after emulated hardware configuration has changed. */
+/* Chunks whose length depends on FM core are counted with their largest length, so that size does not    */
+/* change while the same game is running.                                                                  */
+int state_size(void)
+{
+  const t_state_chunk *chunk;
+  uint8 *state;
+  int i;
+
+  if (!sizes.save)
   {
-    save_param(work_ram, 0x2000);
+    state = malloc(STATE_SIZE);
+    if (!state)
+    {
+      return 0;
+    }
+
+    /* savestates have a header & version chunk, then chunk headers */
+    /* snapshots have a signature, then timing & audio output state */
+    sizes.save = STATE_HEADER_SIZE + CHUNK_HEADER_SIZE + 16;
+    sizes.snapshot = SNAPSHOT_HEADER_SIZE;
+    for (chunk = state_chunks(), i = 0; chunk->id[0]; chunk++, i++)
+    {
+      int length = sizes.chunk[i] = chunk->save(state);
+      if (chunk->size)
+      {
+        length = chunk->size(NULL);
+      }
+      sizes.save += CHUNK_HEADER_SIZE + length;
+      sizes.snapshot += length;
+    }
+    sizes.snapshot += cpu_timing_save(state);
+    sizes.snapshot += vdp_timing_context_save(state);
+    sizes.snapshot += movie_context_size();
+    sizes.snapshot += audio_context_size();
+
+    free(state);
   }
 
-  /* IO */
-  save_param(io_reg, sizeof(io_reg));
+  return (sizes.snapshot > sizes.save) ? sizes.snapshot : sizes.save;
+}
 
-  /* VDP */
-  bufferptr += vdp_context_save(&state[bufferptr]);
+void state_invalidate(void)
+{
+  static uint32 sessions;
 
-  /* SOUND */
-  bufferptr += sound_context_save(&state[bufferptr]);
+  sizes.save = 0;
 
-  /* 68000 */ 
-  if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
-  {
-    uint16 tmp16;
-    uint32 tmp32;
-    tmp32 = m68k_get_reg(M68K_REG_D0);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_D1);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_D2);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_D3);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_D4);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_D5);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_D6);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_D7);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_A0);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_A1);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_A2);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_A3);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_A4);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_A5);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_A6);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_A7);  save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_PC);  save_param(&tmp32, 4);
-    tmp16 = m68k_get_reg(M68K_REG_SR);  save_param(&tmp16, 2); 
-    tmp32 = m68k_get_reg(M68K_REG_USP); save_param(&tmp32, 4);
-    tmp32 = m68k_get_reg(M68K_REG_ISP); save_param(&tmp32, 4);
-
-    save_param(&m68k.cycles, sizeof(m68k.cycles));
-    save_param(&m68k.int_level, sizeof(m68k.int_level));
-    save_param(&m68k.stopped, sizeof(m68k.stopped));
-  }
-
-  /* Z80 */ 
-  save_param(&Z80, sizeof(Z80_Regs));
+  /* unique to this instance (process start time & instance storage address) and configuration */
+  sizes.session = ((uint32)time(NULL) << 12) ^ (uint32)(size_t)&sizes ^ ++sessions;
+}
 
-  /* External HW */
-  if (system_hw == SYSTEM_MCD)
+int state_snapshot_save(unsigned char *state)
+{
+  const t_state_chunk *chunk;
+  int length, bufferptr = SNAPSHOT_HEADER_SIZE;
+
+  memcpy(state, SNAPSHOT_SIGNATURE, 8);
+  memcpy(&state[8], &sizes.session, 4);
+
+  for (chunk = state_chunks(); chunk->id[0]; chunk++)
   {
-    /* CD hardware ID flag */
-    char id[4];
-    memcpy(id,"SCD!",4);
-    save_param(id, 4);
+    bufferptr += chunk->save(&state[bufferptr]);
+  }
+
+  /* emulation & audio output are continued from snapshot */
+  bufferptr += cpu_timing_save(&state[bufferptr]);
+  bufferptr += vdp_timing_context_save(&state[bufferptr]);
+  bufferptr += movie_context_save(&state[bufferptr]);
+  length = audio_context_save(&state[bufferptr]);
 
-    /* CD hardware */
-    bufferptr += scd_context_save(&state[bufferptr]);
+  /* audio output state is only saved between frames, once samples have been read */
+  return length ? (bufferptr + length) : 0;
+}
+
+/* same as state_snapshot_save, except that memory blocks saved with save_region are not copied: */
+/* their position in snapshot is returned in regions list, which holds up to *count entries.    */
+int state_snapshot_save_regions(unsigned char *state, t_state_region *list, int *count)
+{
+  int size;
+
+  regions.list = list;
+  regions.count = 0;
+  regions.max = *count;
+
+  size = state_snapshot_save(state);
+
+  regions.list = NULL;
+  *count = regions.count;
+
+  return size;
+}
+
+void state_save_region(uint8 *dst, const void *src, uint32 size)
+{
+  if (regions.list && (regions.count < regions.max))
+  {
+    regions.list[regions.count].dst = dst;
+    regions.list[regions.count].src = src;
+    regions.list[regions.count].size = size;
+    regions.count++;
+    return;
   }
-  else if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
+
+  memcpy(dst, src, size);
+}
+
+int state_snapshot_load(unsigned char *state)
+{
+  const t_state_chunk *chunk;
+  char version[17] = STATE_VERSION;
+  int bufferptr = SNAPSHOT_HEADER_SIZE;
+
+  /* only snapshots saved by this instance, with current hardware configuration, can be restored */
+  if (memcmp(state, SNAPSHOT_SIGNATURE, 8) || memcmp(&state[8], &sizes.session, 4))
   {
-    /* MD cartridge hardware */
-    bufferptr += md_cart_context_save(&state[bufferptr]);
+    return 0;
   }
-  else
+
+  state_load_init(0);
+
+  snapshot_loading = 1;
+  for (chunk = state_chunks(); chunk->id[0]; chunk++)
   {
-    /* MS cartridge hardware */
-    bufferptr += sms_cart_context_save(&state[bufferptr]);
+    bufferptr += chunk->load(&state[bufferptr], version);
   }
+  snapshot_loading = 0;
+
+  bufferptr += cpu_timing_load(&state[bufferptr]);
+  bufferptr += vdp_timing_context_load(&state[bufferptr]);
+  bufferptr += movie_context_load(&state[bufferptr]);
+  bufferptr += audio_context_load(&state[bufferptr]);
 
-  /* return total size */
   return bufferptr;
 }
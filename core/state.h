@@ -50,8 +50,28 @@
   memcpy(&state[bufferptr], param, size); \
   bufferptr+= size;
 
+/* large memory blocks (RAM, VRAM), which snapshots can leave in place (see rewind.c) */
+#define save_region(param, size) \
+  state_save_region(&state[bufferptr], param, size); \
+  bufferptr+= size;
+
+#define STATE_REGIONS_MAX 8
+
+typedef struct
+{
+  uint8 *dst;         /* position in snapshot */
+  const uint8 *src;   /* memory block */
+  uint32 size;
+} t_state_region;
+
 /* Function prototypes */
-extern int state_load(unsigned char *state);
+extern int state_load(unsigned char *state, int size);
 extern int state_save(unsigned char *state);
+extern int state_size(void);
+extern void state_invalidate(void);
+extern int state_snapshot_save(unsigned char *state);
+extern int state_snapshot_load(unsigned char *state);
+extern int state_snapshot_save_regions(unsigned char *state, t_state_region *regions, int *count);
+extern void state_save_region(uint8 *dst, const void *src, uint32 size);
 
 #endif
@@ -44,17 +44,17 @@
 #include "eq.h"
 
 /* Global variables */
-t_bitmap bitmap;
-t_snd snd;
-uint32 mcycles_vdp;
-uint8 system_hw;
-uint8 system_bios;
-uint32 system_clock;
-int16 SVP_cycles = 800; 
-
-static uint8 pause_b;
-static EQSTATE eq[2];
-static int16 llp,rrp;
+THREAD_LOCAL t_bitmap bitmap;
+THREAD_LOCAL t_snd snd;
+THREAD_LOCAL uint32 mcycles_vdp;
+THREAD_LOCAL uint8 system_hw;
+THREAD_LOCAL uint8 system_bios;
+THREAD_LOCAL uint32 system_clock;
+THREAD_LOCAL int16 SVP_cycles = 800; 
+
+static THREAD_LOCAL uint8 pause_b;
+static THREAD_LOCAL EQSTATE eq[2];
+static THREAD_LOCAL int16 llp,rrp;
 
 /******************************************************************************************/
 /* Audio subsystem                                                                        */
@@ -68,6 +68,9 @@ int audio_init(int samplerate, double framerate)
   /* Clear the sound data context */
   memset(&snd, 0, sizeof (snd));
 
+  /* snapshots include audio output state */
+  state_invalidate();
+
   /* Initialize Blip Buffers */
   snd.blips[0] = blip_new(samplerate / 10);
   if (!snd.blips[0])
@@ -177,6 +180,16 @@ void audio_reset(void)
   audio_set_equalizer();
 }
 
+/* When muted, sound chips are only run to keep the state the CPU can observe (FM timers & */
+/* BUSY flag, PCM channel addresses, CD-DA read position) accurate: no sample is rendered */
+/* and audio_update returns the same number of silent samples. Other internal chip state */
+/* (FM envelopes & phases, PSG & PCM outputs) is frozen meanwhile, so savestates made   */
+/* while muted may differ from unmuted emulation. Only change it between frames.        */
+void audio_set_mute(int mute)
+{
+  sound_mute(mute);
+}
+
 void audio_set_equalizer(void)
 {
   init_3band_state(&eq[0],config.low_freq,config.high_freq,snd.sample_rate);
@@ -186,6 +199,69 @@ void audio_set_equalizer(void)
   eq[0].hg = eq[1].hg = (double)(config.hg) / 100.0;
 }
 
+/* audio output state (see state_snapshot_save), only saved once available samples have been read */
+int audio_context_save(uint8 *state)
+{
+  int i, length;
+  int bufferptr = sound_output_context_save(state);
+
+  for (i=0; i<4; i++)
+  {
+    if (snd.blips[i])
+    {
+      length = blip_context_save(snd.blips[i], &state[bufferptr]);
+      if (!length)
+      {
+        return 0;
+      }
+      bufferptr += length;
+    }
+  }
+
+  save_param(eq, sizeof(eq));
+  save_param(&llp, sizeof(llp));
+  save_param(&rrp, sizeof(rrp));
+
+  return bufferptr;
+}
+
+/* audio_context_save length */
+int audio_context_size(void)
+{
+  int i;
+  int size = sound_output_context_size() + sizeof(eq) + sizeof(llp) + sizeof(rrp);
+
+  for (i=0; i<4; i++)
+  {
+    if (snd.blips[i])
+    {
+      size += blip_context_size(snd.blips[i]);
+    }
+  }
+
+  return size;
+}
+
+int audio_context_load(uint8 *state)
+{
+  int i;
+  int bufferptr = sound_output_context_load(state);
+
+  for (i=0; i<4; i++)
+  {
+    if (snd.blips[i])
+    {
+      bufferptr += blip_context_load(snd.blips[i], &state[bufferptr]);
+    }
+  }
+
+  load_param(eq, sizeof(eq));
+  load_param(&llp, sizeof(llp));
+  load_param(&rrp, sizeof(rrp));
+
+  return bufferptr;
+}
+
 void audio_shutdown(void)
 {
   int i;
@@ -234,6 +310,27 @@ int audio_update(int16 *buffer)
   size &= ALIGN_SND;
 #endif
 
+  /* sound output is muted ? */
+  if (snd.muted)
+  {
+    int i;
+
+    /* drop samples from all audio streams */
+    for (i=0; i<4; i++)
+    {
+      if (snd.blips[i])
+      {
+        blip_discard_samples(snd.blips[i], size);
+      }
+    }
+
+    /* return silent samples */
+    memset(buffer, 0, size * 2 * sizeof(int16));
+    return size;
+  }
+
+  PROFILE_START(PROF_BLIP_MIX);
+
   /* check number of audio streams to mix with FM+PSG stream */
   if (mixed_blips)
   {
@@ -246,6 +343,8 @@ int audio_update(int16 *buffer)
     blip_read_samples(snd.blips[0], buffer, size);
   }
 
+  PROFILE_END(PROF_BLIP_MIX);
+
   /* Audio filtering */
   if (config.filter)
   {
@@ -353,6 +452,8 @@ void system_frame_gen(int do_skip)
   /* line counters */
   int start, end, line;
 
+  PROFILE_FRAME();
+
   /* reset frame cycle counter */
   mcycles_vdp = 0;
 
@@ -480,7 +581,7 @@ void system_frame_gen(int do_skip)
   }
 
   /* refresh inputs just before VINT (Warriors of Eternal Sun) */
-  osd_input_update();
+  movie_input_update();
 
   /* VDP always starts after VBLANK so VINT cannot occur on first frame after a VDP reset (verified on real hardware) */
   if (v_counter != bitmap.viewport.h)
@@ -593,6 +694,7 @@ void system_frame_gen(int do_skip)
   /* parse first line of sprites */
   if (reg[1] & 0x40)
   {
+    render_sync();
     parse_satb(-1);
   }
 
@@ -677,6 +779,10 @@ void system_frame_gen(int do_skip)
   }
   while (++line < bitmap.viewport.h);
 
+  /* wait for last lines to be rendered & filtered */
+  render_sync();
+  ntsc_flush();
+
   /* check viewport changes */
   if (bitmap.viewport.w != bitmap.viewport.ow)
   {
@@ -697,6 +803,8 @@ void system_frame_scd(int do_skip)
   /* line counters */
   int start, end, line;
 
+  PROFILE_FRAME();
+
   /* reset frame cycle counter */
   mcycles_vdp = 0;
   scd.cycles = 0;
@@ -825,7 +933,7 @@ void system_frame_scd(int do_skip)
   }
 
   /* refresh inputs just before VINT */
-  osd_input_update();
+  movie_input_update();
 
   /* VDP always starts after VBLANK so VINT cannot occur on first frame after a VDP reset (verified on real hardware) */
   if (v_counter != bitmap.viewport.h)
@@ -930,6 +1038,7 @@ void system_frame_scd(int do_skip)
   /* parse first line of sprites */
   if (reg[1] & 0x40)
   {
+    render_sync();
     parse_satb(-1);
   }
 
@@ -1006,6 +1115,10 @@ void system_frame_scd(int do_skip)
   }
   while (++line < bitmap.viewport.h);
 
+  /* wait for last lines to be rendered & filtered */
+  render_sync();
+  ntsc_flush();
+
   /* check viewport changes */
   if (bitmap.viewport.w != bitmap.viewport.ow)
   {
@@ -1027,6 +1140,8 @@ void system_frame_sms(int do_skip)
   /* line counter */
   int start, end, line;
 
+  PROFILE_FRAME();
+
   /* reset frame cycle count */
   mcycles_vdp = 0;
 
@@ -1206,7 +1321,7 @@ void system_frame_sms(int do_skip)
   }
 
   /* refresh inputs just before VINT */
-  osd_input_update();
+  movie_input_update();
 
   /* run Z80 until end of line */
   z80_run(MCYCLES_PER_LINE);
@@ -1418,6 +1533,9 @@ void system_frame_sms(int do_skip)
   }
   while (++line < bitmap.viewport.h);
 
+  /* wait for last lines to be filtered */
+  ntsc_flush();
+
   /* check viewport changes */
   if (bitmap.viewport.w != bitmap.viewport.ow)
   {
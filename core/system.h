@@ -75,6 +75,7 @@ typedef struct
   int width;        /* Bitmap width */
   int height;       /* Bitmap height */
   int pitch;        /* Bitmap pitch */
+  int format;       /* Output pixel format (PIXEL_FORMAT_NATIVE by default, see vdp_render.h) */
   struct
   {
     int x;          /* X offset of viewport within bitmap */
@@ -92,17 +93,18 @@ typedef struct
   int sample_rate;      /* Output Sample rate (8000-48000) */
   double frame_rate;    /* Output Frame rate (usually 50 or 60 frames per second) */
   int enabled;          /* 1= sound emulation is enabled */
+  int muted;            /* 1= sound samples are not generated (see audio_set_mute) */
   blip_t* blips[4];     /* Blip Buffer resampling (stereo) */
 } t_snd;
 
 /* Global variables */
-extern t_bitmap bitmap;
-extern t_snd snd;
-extern uint32 mcycles_vdp;
-extern int16 SVP_cycles; 
-extern uint8 system_hw;
-extern uint8 system_bios;
-extern uint32 system_clock;
+extern THREAD_LOCAL t_bitmap bitmap;
+extern THREAD_LOCAL t_snd snd;
+extern THREAD_LOCAL uint32 mcycles_vdp;
+extern THREAD_LOCAL int16 SVP_cycles; 
+extern THREAD_LOCAL uint8 system_hw;
+extern THREAD_LOCAL uint8 system_bios;
+extern THREAD_LOCAL uint32 system_clock;
 
 /* Function prototypes */
 extern int audio_init(int samplerate, double framerate);
@@ -110,7 +112,11 @@ extern void audio_set_rate(int samplerate, double framerate);
 extern void audio_reset(void);
 extern void audio_shutdown(void);
 extern int audio_update(int16 *buffer);
+extern void audio_set_mute(int mute);
 extern void audio_set_equalizer(void);
+extern int audio_context_save(uint8 *state);
+extern int audio_context_load(uint8 *state);
+extern int audio_context_size(void);
 extern void system_init(void);
 extern void system_reset(void);
 extern void system_frame_gen(int do_skip);
@@ -45,6 +45,7 @@
 /* Mark a pattern as modified */
 #define MARK_BG_DIRTY(addr)                         \
 {                                                   \
+  render_dirty = 1;                                 \
   name = (addr >> 5) & 0x7FF;                       \
   if (bg_name_dirty[name] == 0)                     \
   {                                                 \
@@ -64,51 +65,51 @@
 #define HBLANK_H40_END_MCYCLE   (872)
 
 /* VDP context */
-uint8 ALIGNED_(4) sat[0x400];     /* Internal copy of sprite attribute table */
-uint8 ALIGNED_(4) vram[0x10000];  /* Video RAM (64K x 8-bit) */
-uint8 ALIGNED_(4) cram[0x80];     /* On-chip color RAM (64 x 9-bit) */
-uint8 ALIGNED_(4) vsram[0x80];    /* On-chip vertical scroll RAM (40 x 11-bit) */
-uint8 reg[0x20];                  /* Internal VDP registers (23 x 8-bit) */
-uint8 hint_pending;               /* 0= Line interrupt is pending */
-uint8 vint_pending;               /* 1= Frame interrupt is pending */
-uint16 status;                    /* VDP status flags */
-uint32 dma_length;                /* DMA remaining length */
-uint32 dma_endCycles;             /* DMA end cycle */
-uint8 dma_type;                   /* DMA mode */
+THREAD_LOCAL uint8 ALIGNED_(4) sat[0x400];     /* Internal copy of sprite attribute table */
+THREAD_LOCAL uint8 ALIGNED_(4) vram[0x10000];  /* Video RAM (64K x 8-bit) */
+THREAD_LOCAL uint8 ALIGNED_(4) cram[0x80];     /* On-chip color RAM (64 x 9-bit) */
+THREAD_LOCAL uint8 ALIGNED_(4) vsram[0x80];    /* On-chip vertical scroll RAM (40 x 11-bit) */
+THREAD_LOCAL uint8 reg[0x20];                  /* Internal VDP registers (23 x 8-bit) */
+THREAD_LOCAL uint8 hint_pending;               /* 0= Line interrupt is pending */
+THREAD_LOCAL uint8 vint_pending;               /* 1= Frame interrupt is pending */
+THREAD_LOCAL uint16 status;                    /* VDP status flags */
+THREAD_LOCAL uint32 dma_length;                /* DMA remaining length */
+THREAD_LOCAL uint32 dma_endCycles;             /* DMA end cycle */
+THREAD_LOCAL uint8 dma_type;                   /* DMA mode */
 
 /* Global variables */
-uint16 ntab;                      /* Name table A base address */
-uint16 ntbb;                      /* Name table B base address */
-uint16 ntwb;                      /* Name table W base address */
-uint16 satb;                      /* Sprite attribute table base address */
-uint16 hscb;                      /* Horizontal scroll table base address */
-uint8 bg_name_dirty[0x800];       /* 1= This pattern is dirty */
-uint16 bg_name_list[0x800];       /* List of modified pattern indices */
-uint16 bg_list_index;             /* # of modified patterns in list */
-uint8 hscroll_mask;               /* Horizontal Scrolling line mask */
-uint8 playfield_shift;            /* Width of planes A, B (in bits) */
-uint8 playfield_col_mask;         /* Playfield column mask */
-uint16 playfield_row_mask;        /* Playfield row mask */
-uint16 vscroll;                   /* Latched vertical scroll value */
-uint8 odd_frame;                  /* 1: odd field, 0: even field */
-uint8 im2_flag;                   /* 1= Interlace mode 2 is being used */
-uint8 interlaced;                 /* 1: Interlaced mode 1 or 2 */
-uint8 vdp_pal;                    /* 1: PAL , 0: NTSC (default) */
-uint8 h_counter;                  /* Horizontal counter */
-uint16 v_counter;                 /* Vertical counter */
-uint16 vc_max;                    /* Vertical counter overflow value */
-uint16 lines_per_frame;           /* PAL: 313 lines, NTSC: 262 lines */
-uint16 max_sprite_pixels;         /* Max. sprites pixels per line (parsing & rendering) */
-uint32 fifo_cycles[4];            /* VDP FIFO read-out cycles */
-uint32 hvc_latch;                 /* latched HV counter */
-uint32 vint_cycle;                /* VINT occurence cycle */
-const uint8 *hctab;               /* pointer to H Counter table */
+THREAD_LOCAL uint16 ntab;                      /* Name table A base address */
+THREAD_LOCAL uint16 ntbb;                      /* Name table B base address */
+THREAD_LOCAL uint16 ntwb;                      /* Name table W base address */
+THREAD_LOCAL uint16 satb;                      /* Sprite attribute table base address */
+THREAD_LOCAL uint16 hscb;                      /* Horizontal scroll table base address */
+THREAD_LOCAL uint8 bg_name_dirty[0x800];       /* 1= This pattern is dirty */
+THREAD_LOCAL uint16 bg_name_list[0x800];       /* List of modified pattern indices */
+THREAD_LOCAL uint16 bg_list_index;             /* # of modified patterns in list */
+THREAD_LOCAL uint8 hscroll_mask;               /* Horizontal Scrolling line mask */
+THREAD_LOCAL uint8 playfield_shift;            /* Width of planes A, B (in bits) */
+THREAD_LOCAL uint8 playfield_col_mask;         /* Playfield column mask */
+THREAD_LOCAL uint16 playfield_row_mask;        /* Playfield row mask */
+THREAD_LOCAL uint16 vscroll;                   /* Latched vertical scroll value */
+THREAD_LOCAL uint8 odd_frame;                  /* 1: odd field, 0: even field */
+THREAD_LOCAL uint8 im2_flag;                   /* 1= Interlace mode 2 is being used */
+THREAD_LOCAL uint8 interlaced;                 /* 1: Interlaced mode 1 or 2 */
+THREAD_LOCAL uint8 vdp_pal;                    /* 1: PAL , 0: NTSC (default) */
+THREAD_LOCAL uint8 h_counter;                  /* Horizontal counter */
+THREAD_LOCAL uint16 v_counter;                 /* Vertical counter */
+THREAD_LOCAL uint16 vc_max;                    /* Vertical counter overflow value */
+THREAD_LOCAL uint16 lines_per_frame;           /* PAL: 313 lines, NTSC: 262 lines */
+THREAD_LOCAL uint16 max_sprite_pixels;         /* Max. sprites pixels per line (parsing & rendering) */
+THREAD_LOCAL uint32 fifo_cycles[4];            /* VDP FIFO read-out cycles */
+THREAD_LOCAL uint32 hvc_latch;                 /* latched HV counter */
+THREAD_LOCAL uint32 vint_cycle;                /* VINT occurence cycle */
+THREAD_LOCAL const uint8 *hctab;               /* pointer to H Counter table */
 
 /* Function pointers */
-void (*vdp_68k_data_w)(unsigned int data);
-void (*vdp_z80_data_w)(unsigned int data);
-unsigned int (*vdp_68k_data_r)(void);
-unsigned int (*vdp_z80_data_r)(void);
+THREAD_LOCAL void (*vdp_68k_data_w)(unsigned int data);
+THREAD_LOCAL void (*vdp_z80_data_w)(unsigned int data);
+THREAD_LOCAL unsigned int (*vdp_68k_data_r)(void);
+THREAD_LOCAL unsigned int (*vdp_z80_data_r)(void);
 
 /* Function prototypes */
 static void vdp_68k_data_w_m4(unsigned int data);
@@ -136,26 +137,26 @@ static const uint8 shift_table[]        = { 6, 7, 0, 8 };
 static const uint8 col_mask_table[]     = { 0x0F, 0x1F, 0x0F, 0x3F };
 static const uint16 row_mask_table[]    = { 0x0FF, 0x1FF, 0x2FF, 0x3FF };
 
-static uint8 border;            /* Border color index */
-static uint8 pending;           /* Pending write flag */
-static uint8 code;              /* Code register */
-static uint16 addr;             /* Address register */
-static uint16 addr_latch;       /* Latched A15, A14 of address */
-static uint16 sat_base_mask;    /* Base bits of SAT */
-static uint16 sat_addr_mask;    /* Index bits of SAT */
-static uint16 dma_src;          /* DMA source address */
-static int dmafill;             /* DMA Fill pending flag */
-static int cached_write;        /* 2nd part of 32-bit CTRL port write (Genesis mode) or LSB of CRAM data (Game Gear mode) */
-static uint16 fifo[4];          /* FIFO ring-buffer */
-static int fifo_idx;            /* FIFO write index */
-static int fifo_byte_access;    /* FIFO byte access flag */
-static int *fifo_timing;        /* FIFO slots timing table */
-static int hblank_start_cycle;  /* HBLANK flag set cycle */
-static int hblank_end_cycle;    /* HBLANK flag clear cycle */
+static THREAD_LOCAL uint8 border;            /* Border color index */
+static THREAD_LOCAL uint8 pending;           /* Pending write flag */
+static THREAD_LOCAL uint8 code;              /* Code register */
+static THREAD_LOCAL uint16 addr;             /* Address register */
+static THREAD_LOCAL uint16 addr_latch;       /* Latched A15, A14 of address */
+static THREAD_LOCAL uint16 sat_base_mask;    /* Base bits of SAT */
+static THREAD_LOCAL uint16 sat_addr_mask;    /* Index bits of SAT */
+static THREAD_LOCAL uint16 dma_src;          /* DMA source address */
+static THREAD_LOCAL int dmafill;             /* DMA Fill pending flag */
+static THREAD_LOCAL int cached_write;        /* 2nd part of 32-bit CTRL port write (Genesis mode) or LSB of CRAM data (Game Gear mode) */
+static THREAD_LOCAL uint16 fifo[4];          /* FIFO ring-buffer */
+static THREAD_LOCAL int fifo_idx;            /* FIFO write index */
+static THREAD_LOCAL int fifo_byte_access;    /* FIFO byte access flag */
+static THREAD_LOCAL int *fifo_timing;        /* FIFO slots timing table */
+static THREAD_LOCAL int hblank_start_cycle;  /* HBLANK flag set cycle */
+static THREAD_LOCAL int hblank_end_cycle;    /* HBLANK flag clear cycle */
 
  /* set Z80 or 68k interrupt lines */
-static void (*set_irq_line)(unsigned int level);
-static void (*set_irq_line_delay)(unsigned int level);
+static THREAD_LOCAL void (*set_irq_line)(unsigned int level);
+static THREAD_LOCAL void (*set_irq_line_delay)(unsigned int level);
 
 /* Vertical counter overflow values (see hvc.h) */
 static const uint16 vc_table[4][2] = 
@@ -257,6 +258,10 @@ void vdp_reset(void)
 {
   int i;
 
+  render_sync();
+  render_dirty = 1;
+  sat_dirty = 1;
+
   memset ((char *) sat, 0, sizeof (sat));
   memset ((char *) vram, 0, sizeof (vram));
   memset ((char *) cram, 0, sizeof (cram));
@@ -355,7 +360,6 @@ void vdp_reset(void)
   }
 
   /* default rendering mode */
-  update_bg_pattern_cache = update_bg_pattern_cache_m4;
   if (system_hw < SYSTEM_MD)
   {
     /* Mode 0 */
@@ -471,8 +475,10 @@ int vdp_context_save(uint8 *state)
 {
   int bufferptr = 0;
 
+  render_sync();
+
   save_param(sat, sizeof(sat));
-  save_param(vram, sizeof(vram));
+  save_region(vram, sizeof(vram));
   save_param(cram, sizeof(cram));
   save_param(vsram, sizeof(vsram));
   save_param(reg, sizeof(reg));
@@ -498,9 +504,18 @@ int vdp_context_load(uint8 *state)
 {
   int i, bufferptr = 0;
   uint8 temp_reg[0x20];
+  uint8 *temp_vram;
+
+  render_sync();
+  render_dirty = 1;
+  sat_dirty = 1;
 
   load_param(sat, sizeof(sat));
-  load_param(vram, sizeof(vram));
+
+  /* VRAM is restored once VDP registers are set, as mode changes re-arrange VRAM addressing */
+  temp_vram = &state[bufferptr];
+  bufferptr += sizeof(vram);
+
   load_param(cram, sizeof(cram));
   load_param(vsram, sizeof(vsram));
   load_param(temp_reg, sizeof(temp_reg));
@@ -537,6 +552,21 @@ int vdp_context_load(uint8 *state)
     }
   }
 
+  /* only invalidate pattern cache entries of modified tiles (whole cache is invalidated on rendering mode change) */
+  for (i = 0; i < ((reg[1] & 0x04) ? 0x800 : 0x200); i++)
+  {
+    if (memcmp(&vram[i << 5], &temp_vram[i << 5], 32))
+    {
+      if (bg_name_dirty[i] == 0)
+      {
+        bg_name_list[bg_list_index++] = i;
+      }
+      bg_name_dirty[i] = 0xFF;
+    }
+  }
+
+  memcpy(vram, temp_vram, sizeof(vram));
+
   load_param(&addr, sizeof(addr));
   load_param(&addr_latch, sizeof(addr_latch));
   load_param(&code, sizeof(code));
@@ -565,7 +595,6 @@ int vdp_context_load(uint8 *state)
   if (reg[1] & 0x04)
   {
     /* Mode 5 */
-    bg_list_index = 0x800;
 
     /* reinitialize palette */
     color_update_m5(0, *(uint16 *)&cram[border << 1]);
@@ -577,7 +606,6 @@ int vdp_context_load(uint8 *state)
   else
   {
     /* Modes 0,1,2,3,4 */
-    bg_list_index = 0x200;
 
     /* reinitialize palette */
     for(i = 0; i < 0x20; i ++)
@@ -587,13 +615,38 @@ int vdp_context_load(uint8 *state)
     color_update_m4(0x40, *(uint16 *)&cram[(0x10 | (border & 0x0F)) << 1]);
   }
 
-  /* invalidate tile cache */
-  for (i=0;i<bg_list_index;i++) 
-  {
-    bg_name_list[i]=i;
-    bg_name_dirty[i]=0xFF;
-  }
+  return bufferptr;
+}
+
+
+/* frame timing state, not part of savestates (see state_snapshot_save) */
+int vdp_timing_context_save(uint8 *state)
+{
+  int bufferptr = 0;
 
+  save_param(&v_counter, sizeof(v_counter));
+  save_param(&odd_frame, sizeof(odd_frame));
+  save_param(&interlaced, sizeof(interlaced));
+  save_param(&im2_flag, sizeof(im2_flag));
+  save_param(&vscroll, sizeof(vscroll));
+  save_param(&hvc_latch, sizeof(hvc_latch));
+  save_param(&dma_endCycles, sizeof(dma_endCycles));
+  save_param(fifo_cycles, sizeof(fifo_cycles));
+  return bufferptr;
+}
+
+int vdp_timing_context_load(uint8 *state)
+{
+  int bufferptr = 0;
+
+  load_param(&v_counter, sizeof(v_counter));
+  load_param(&odd_frame, sizeof(odd_frame));
+  load_param(&interlaced, sizeof(interlaced));
+  load_param(&im2_flag, sizeof(im2_flag));
+  load_param(&vscroll, sizeof(vscroll));
+  load_param(&hvc_latch, sizeof(hvc_latch));
+  load_param(&dma_endCycles, sizeof(dma_endCycles));
+  load_param(fifo_cycles, sizeof(fifo_cycles));
   return bufferptr;
 }
 
@@ -606,6 +659,8 @@ void vdp_dma_update(unsigned int cycles)
 {
   int dma_cycles, dma_bytes;
 
+  render_sync();
+
   /* DMA transfer rate (bytes per line) 
 
       DMA Mode      Width       Display      Transfer Count
@@ -1202,6 +1257,8 @@ unsigned int vdp_68k_ctrl_r(unsigned int cycles)
 {
   unsigned int temp;
 
+  render_sync();
+
   /* Cycle-accurate VDP status read (adjust CPU time with current instruction execution time) */
   cycles += m68k_cycles();
 
@@ -1275,6 +1332,8 @@ unsigned int vdp_z80_ctrl_r(unsigned int cycles)
 {
   unsigned int temp;
 
+  render_sync();
+
   /* Check if DMA busy flag is set (Mega Drive VDP specific) */
   if (status & 2)
   {
@@ -1513,6 +1572,8 @@ int vdp_68k_irq_ack(int int_level)
 
 static void vdp_reg_w(unsigned int r, unsigned int d, unsigned int cycles)
 {
+  render_sync();
+
 #ifdef LOGVDP
   error("[%d(%d)][%d(%d)] VDP register %d write -> 0x%x (%x)\n", v_counter, (v_counter + (cycles - mcycles_vdp)/MCYCLES_PER_LINE)%lines_per_frame, cycles, cycles%MCYCLES_PER_LINE, r, d, m68k_get_reg(M68K_REG_PC));
 #endif
@@ -1523,6 +1584,12 @@ static void vdp_reg_w(unsigned int r, unsigned int d, unsigned int cycles)
     return;
   }
 
+  /* H-Int counter, auto-increment & DMA registers have no effect on rendering */
+  if ((d != reg[r]) && (r != 10) && (r != 15) && (r < 19))
+  {
+    render_dirty = 1;
+  }
+
   switch(r)
   {
     case 0: /* CTRL #1 */
@@ -1758,7 +1825,6 @@ static void vdp_reg_w(unsigned int r, unsigned int d, unsigned int cycles)
             }
 
             /* Mode 5 rendering */
-            update_bg_pattern_cache = update_bg_pattern_cache_m5;
             if (im2_flag)
             {
               parse_satb = parse_satb_m5_im2;
@@ -1815,7 +1881,6 @@ static void vdp_reg_w(unsigned int r, unsigned int d, unsigned int cycles)
 
             /* Mode 4 rendering */
             parse_satb = parse_satb_m4;
-            update_bg_pattern_cache = update_bg_pattern_cache_m4;
             render_bg = render_bg_m4;
             render_obj = render_obj_m4;
 
@@ -2193,8 +2258,18 @@ static void vdp_bus_w(unsigned int data)
       /* Intercept writes to Sprite Attribute Table */
       if ((index & sat_base_mask) == satb)
       {
+        /* Pointer to internal SAT */
+        uint16 *q = (uint16 *) &sat[index & sat_addr_mask];
+
         /* Update internal SAT */
-        *(uint16 *) &sat[index & sat_addr_mask] = data;
+        if (data != *q)
+        {
+          *q = data;
+          render_dirty = 1;
+
+          /* Y position, size & link fields are used by cached sprite list */
+          sat_dirty |= !(index & 4);
+        }
       }
 
       /* Only write unique data to VRAM */
@@ -2271,7 +2346,15 @@ static void vdp_bus_w(unsigned int data)
 
     case 0x05:  /* VSRAM */
     {
-      *(uint16 *)&vsram[addr & 0x7E] = data;
+      /* Pointer to VSRAM word */
+      uint16 *p = (uint16 *)&vsram[addr & 0x7E];
+
+      /* Check if VSRAM data is being modified */
+      if (data != *p)
+      {
+        *p = data;
+        render_dirty = 1;
+      }
 
       /* 2-cell Vscroll mode */
       if (reg[11] & 0x04)
@@ -2409,6 +2492,8 @@ static void vdp_68k_data_w_m4(unsigned int data)
 
 static void vdp_68k_data_w_m5(unsigned int data)
 {
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2652,6 +2737,8 @@ static void vdp_z80_data_w_m4(unsigned int data)
 
 static void vdp_z80_data_w_m5(unsigned int data)
 {
+  render_sync();
+
   /* Clear pending flag */
   pending = 0;
 
@@ -2672,6 +2759,8 @@ static void vdp_z80_data_w_m5(unsigned int data)
       {
         /* Update internal SAT */
         WRITE_BYTE(sat, index & sat_addr_mask, data);
+        render_dirty = 1;
+        sat_dirty |= !(index & 4);
       }
 
       /* Only write unique data to VRAM */
@@ -2734,6 +2823,7 @@ static void vdp_z80_data_w_m5(unsigned int data)
     {
       /* Write low byte to even address & high byte to odd address */
       WRITE_BYTE(vsram, (addr & 0x7F) ^ 1, data);
+      render_dirty = 1;
       break;
     }
   }
@@ -3019,6 +3109,99 @@ static void vdp_z80_data_w_sg(unsigned int data)
 /* DMA operations (Mega Drive VDP only)                                     */
 /*--------------------------------------------------------------------------*/
 
+/* Mark pattern rows of a linear VRAM range as modified (once per 4-byte row) */
+static void vdp_dma_vram_dirty(unsigned int start, unsigned int end)
+{
+  int name;
+
+  for (start &= ~3; start < end; start += 4)
+  {
+    MARK_BG_DIRTY(start);
+  }
+}
+
+/* Update internal SAT from a linear VRAM range (word-aligned) */
+static void vdp_dma_sat_update(unsigned int start, unsigned int end)
+{
+  unsigned int sat_end = satb + sat_addr_mask + 1;
+
+  if (start < satb) start = satb;
+  if (end > sat_end) end = sat_end;
+
+  if ((start < end) && memcmp(&sat[start & sat_addr_mask], &vram[start], end - start))
+  {
+    memcpy(&sat[start & sat_addr_mask], &vram[start], end - start);
+    render_dirty = 1;
+    sat_dirty = 1;
+  }
+}
+
+/* DMA from 68K bus to VRAM with auto-increment of 2 (fast path of vdp_bus_w) */
+/* Source words are copied until end of source 64K bank or VRAM, only modified pattern rows */
+/* are marked dirty. DMA timings are not modified (see vdp_dma_update). Returns number of */
+/* processed words, 0 if fast path can not be used. */
+static unsigned int vdp_dma_68k_vram(const uint8 *base, uint32 source, unsigned int length)
+{
+  const uint16 *src = (const uint16 *)(base + (source & 0xFFFF));
+  uint16 *dst = (uint16 *)&vram[addr];
+  unsigned int start = addr;
+  unsigned int i = 0;
+
+  /* Even VRAM address only (no byte swapping) */
+  if (((code & 0x0F) != 0x01) || (reg[15] != 2) || (addr & 1))
+  {
+    return 0;
+  }
+
+#ifdef HOOK_CPU
+  if (UNLIKELY(cpu_hook))
+  {
+    return 0;
+  }
+#endif
+
+  /* No source or destination wrapping */
+  if (length > ((0x10000 - (source & 0xFFFF)) >> 1))
+  {
+    length = (0x10000 - (source & 0xFFFF)) >> 1;
+  }
+  if (length > ((0x10000 - start) >> 1))
+  {
+    length = (0x10000 - start) >> 1;
+  }
+
+  /* Only write unique data to VRAM, one pattern row (two words) at a time */
+  while (i < length)
+  {
+    int name;
+    unsigned int words = ((start & 2) || (i + 1 == length)) ? 1 : 2;
+
+    if (memcmp(&dst[i], &src[i], words * 2))
+    {
+      memcpy(&dst[i], &src[i], words * 2);
+      MARK_BG_DIRTY(start);
+    }
+
+    start += words * 2;
+    i += words;
+  }
+
+  /* Intercept writes to Sprite Attribute Table */
+  vdp_dma_sat_update(addr, start);
+
+  /* Last written words are left in FIFO */
+  for (i = (length > 4) ? (length - 4) : 0; i < length; i++)
+  {
+    fifo[(fifo_idx + i) & 3] = src[i];
+  }
+  fifo_idx = (fifo_idx + length) & 3;
+
+  /* Increment address register */
+  addr = start;
+
+  return length;
+}
+
 /* DMA from 68K bus: $000000-$7FFFFF (external area) */
 static void vdp_dma_68k_ext(unsigned int length)
 {
@@ -3027,7 +3210,16 @@ static void vdp_dma_68k_ext(unsigned int length)
   /* 68k bus source address */
   uint32 source = (reg[23] << 17) | (dma_src << 1);
 
-  do
+  /* Linear VRAM writes from directly mapped area */
+  while (length && !m68k.memory_map[source>>16].read16)
+  {
+    unsigned int count = vdp_dma_68k_vram(m68k.memory_map[source>>16].base, source, length);
+    if (!count) break;
+    source = (reg[23] << 17) | ((source + (count << 1)) & 0x1FFFF);
+    length -= count;
+  }
+
+  for (; length; length--)
   {
     /* Read data word from 68k bus */
     if (m68k.memory_map[source>>16].read16)
@@ -3048,7 +3240,6 @@ static void vdp_dma_68k_ext(unsigned int length)
     /* Write data word to VRAM, CRAM or VSRAM */
     vdp_bus_w(data);
   }
-  while (--length);
 
   /* Update DMA source address */
   dma_src = (source >> 1) & 0xffff;
@@ -3062,7 +3253,16 @@ static void vdp_dma_68k_ram(unsigned int length)
   /* 68k bus source address */
   uint32 source = (reg[23] << 17) | (dma_src << 1);
 
-  do
+  /* Linear VRAM writes */
+  while (length)
+  {
+    unsigned int count = vdp_dma_68k_vram(work_ram, source, length);
+    if (!count) break;
+    source = (reg[23] << 17) | ((source + (count << 1)) & 0x1FFFF);
+    length -= count;
+  }
+
+  for (; length; length--)
   {
     /* access Work-RAM by default  */
     data = *(uint16 *)(work_ram + (source & 0xFFFF));
@@ -3076,7 +3276,6 @@ static void vdp_dma_68k_ram(unsigned int length)
     /* Write data word to VRAM, CRAM or VSRAM */
     vdp_bus_w(data);
   }
-  while (--length);
 
   /* Update DMA source address */
   dma_src = (source >> 1) & 0xffff;
@@ -3142,7 +3341,23 @@ static void vdp_dma_copy(unsigned int length)
     /* VRAM source address */
     uint16 source = dma_src;
 
-    do
+    /* Linear copy (auto-increment of 1, word-aligned addresses, no wrapping nor overwriting of unread source bytes) */
+    if ((reg[15] == 1) && !((source | addr) & 1) && (length > 1))
+    {
+      unsigned int count = length & ~1;
+
+      if (((source + count) <= 0x10000) && ((addr + count) <= 0x10000) && ((addr <= source) || (addr >= (source + count))))
+      {
+        memmove(&vram[addr], &vram[source], count);
+        vdp_dma_sat_update(addr, addr + count);
+        vdp_dma_vram_dirty(addr, addr + count);
+        source += count;
+        addr += count;
+        length -= count;
+      }
+    }
+
+    for (; length; length--)
     {
       /* Read byte from adjacent VRAM source address */
       data = READ_BYTE(vram, source ^ 1);
@@ -3152,6 +3367,7 @@ static void vdp_dma_copy(unsigned int length)
       {
         /* Update internal SAT */
         WRITE_BYTE(sat, (addr & sat_addr_mask) ^ 1, data);
+        sat_dirty = 1;
       }
 
       /* Write byte to adjacent VRAM destination address */
@@ -3166,7 +3382,6 @@ static void vdp_dma_copy(unsigned int length)
       /* Increment VRAM destination address */
       addr += reg[15];
     }
-    while (--length);
 
     /* Update DMA source address */
     dma_src = source;
@@ -3186,13 +3401,26 @@ static void vdp_dma_fill(unsigned int length)
       /* Get source data from last written FIFO entry */
       uint8 data = fifo[(fifo_idx+3)&3] >> 8;
 
-      do
+      /* Linear fill (auto-increment of 1, word-aligned address, no wrapping) */
+      if ((reg[15] == 1) && !(addr & 1) && (length > 1) && ((addr + (length & ~1)) <= 0x10000))
+      {
+        unsigned int count = length & ~1;
+
+        memset(&vram[addr], data, count);
+        vdp_dma_sat_update(addr, addr + count);
+        vdp_dma_vram_dirty(addr, addr + count);
+        addr += count;
+        length -= count;
+      }
+
+      for (; length; length--)
       {
         /* Intercept writes to Sprite Attribute Table */
         if ((addr & sat_base_mask) == satb)
         {
           /* Update internal SAT */
           WRITE_BYTE(sat, (addr & sat_addr_mask) ^ 1, data);
+          sat_dirty = 1;
         }
 
         /* Write byte to adjacent VRAM address */
@@ -3204,7 +3432,6 @@ static void vdp_dma_fill(unsigned int length)
         /* Increment VRAM address */
         addr += reg[15];
       }
-      while (--length);
       break;
     }
 
@@ -3260,6 +3487,7 @@ static void vdp_dma_fill(unsigned int length)
       {
         /* Write VSRAM data */
         *(uint16 *)&vsram[addr & 0x7E] = data;
+        render_dirty = 1;
           
         /* Increment VSRAM address */
         addr += reg[15];
@@ -0,0 +1,313 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Layers merging kernels (scalar, SSE2, AVX2, NEON)
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MERGE_X86
+#include <immintrin.h>
+#define TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define MERGE_NEON
+#include <arm_neon.h>
+#endif
+
+/*
+   Background layers (see make_lut_bg):
+     layer A pixel is selected when opaque and either high priority or layer B pixel is not (opaque and high priority)
+     transparent result pixel is cleared
+
+   Sprite layer (see make_lut_bgobj), for each opaque sprite pixel:
+     if line buffer already holds a sprite pixel (bit 7 set), it is kept and a collision is reported
+     otherwise, background pixel color is kept only when opaque, high priority and sprite pixel is low priority,
+     bit 7 is set and priority bit is cleared
+*/
+
+const t_merge_kernels *merge_kernels;
+
+
+/*--------------------------------------------------------------------------*/
+/* Scalar kernels                                                           */
+/*--------------------------------------------------------------------------*/
+
+static void merge_bg_scalar(const uint8 *srca, const uint8 *srcb, uint8 *dst, const uint8 *table, int width)
+{
+  do
+  {
+    *dst++ = table[(*srcb++ << 8) | (*srca++)];
+  }
+  while (--width);
+}
+
+static int merge_obj_scalar(uint8 *lb, const uint8 *src, int atex, const uint8 *table)
+{
+  int i, status = 0;
+  unsigned int temp;
+
+  for (i = 0; i < 8; i++)
+  {
+    temp = src[i];
+    if (temp & 0x0f)
+    {
+      temp |= (lb[i] << 8);
+      lb[i] = table[temp | atex];
+      status |= ((temp & 0x8000) >> 10);
+    }
+  }
+
+  return status;
+}
+
+static const t_merge_kernels kernels_scalar = { "scalar", merge_bg_scalar, merge_obj_scalar };
+
+
+/*--------------------------------------------------------------------------*/
+/* SSE2 kernels                                                             */
+/*--------------------------------------------------------------------------*/
+
+#ifdef MERGE_X86
+
+TARGET("sse2") static __m128i merge_bg_sse2_16(__m128i a, __m128i b)
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i color = _mm_set1_epi8(0x0f);
+  __m128i prio = _mm_set1_epi8(0x40);
+  __m128i az = _mm_cmpeq_epi8(_mm_and_si128(a, color), zero);
+  __m128i bz = _mm_cmpeq_epi8(_mm_and_si128(b, color), zero);
+  __m128i ap = _mm_cmpeq_epi8(_mm_and_si128(a, prio), prio);
+  __m128i bp = _mm_cmpeq_epi8(_mm_and_si128(b, prio), prio);
+
+  /* layer B pixel selection mask */
+  __m128i sel = _mm_or_si128(az, _mm_andnot_si128(ap, _mm_andnot_si128(bz, bp)));
+  __m128i c = _mm_and_si128(_mm_or_si128(_mm_and_si128(sel, b), _mm_andnot_si128(sel, a)), _mm_set1_epi8(0x7f));
+  return _mm_andnot_si128(_mm_cmpeq_epi8(_mm_and_si128(c, color), zero), c);
+}
+
+TARGET("sse2") static void merge_bg_sse2(const uint8 *srca, const uint8 *srcb, uint8 *dst, const uint8 *table, int width)
+{
+  for (; width >= 16; width -= 16, srca += 16, srcb += 16, dst += 16)
+  {
+    _mm_storeu_si128((__m128i *)dst, merge_bg_sse2_16(_mm_loadu_si128((const __m128i *)srca), _mm_loadu_si128((const __m128i *)srcb)));
+  }
+
+  while (width--)
+  {
+    *dst++ = table[(*srcb++ << 8) | (*srca++)];
+  }
+}
+
+TARGET("sse2") static int merge_obj_sse2(uint8 *lb, const uint8 *src, int atex, const uint8 *table)
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i color = _mm_set1_epi8(0x0f);
+  __m128i prio = _mm_set1_epi8(0x40);
+  __m128i s = _mm_or_si128(_mm_loadl_epi64((const __m128i *)src), _mm_set1_epi8(atex));
+  __m128i b = _mm_loadl_epi64((const __m128i *)lb);
+  __m128i sz = _mm_cmpeq_epi8(_mm_and_si128(s, color), zero);
+  __m128i bz = _mm_cmpeq_epi8(_mm_and_si128(b, color), zero);
+  __m128i sp = _mm_cmpeq_epi8(_mm_and_si128(s, prio), prio);
+  __m128i bp = _mm_cmpeq_epi8(_mm_and_si128(b, prio), prio);
+  __m128i bs = _mm_cmplt_epi8(b, zero);
+
+  /* background pixel color selection mask */
+  __m128i sel = _mm_andnot_si128(sp, _mm_andnot_si128(bz, bp));
+  __m128i c = _mm_or_si128(_mm_and_si128(_mm_or_si128(_mm_and_si128(sel, b), _mm_andnot_si128(sel, s)), _mm_set1_epi8(0x3f)), _mm_set1_epi8((char)0x80));
+
+  /* line buffer pixels kept */
+  __m128i keep = _mm_or_si128(sz, bs);
+  _mm_storel_epi64((__m128i *)lb, _mm_or_si128(_mm_and_si128(keep, b), _mm_andnot_si128(keep, c)));
+
+  return (_mm_movemask_epi8(_mm_andnot_si128(sz, bs)) & 0xff) ? 0x20 : 0;
+}
+
+static const t_merge_kernels kernels_sse2 = { "sse2", merge_bg_sse2, merge_obj_sse2 };
+
+
+/*--------------------------------------------------------------------------*/
+/* AVX2 kernels                                                             */
+/*--------------------------------------------------------------------------*/
+
+TARGET("avx2") static void merge_bg_avx2(const uint8 *srca, const uint8 *srcb, uint8 *dst, const uint8 *table, int width)
+{
+  __m256i zero = _mm256_setzero_si256();
+  __m256i color = _mm256_set1_epi8(0x0f);
+  __m256i prio = _mm256_set1_epi8(0x40);
+  __m256i mask = _mm256_set1_epi8(0x7f);
+
+  for (; width >= 32; width -= 32, srca += 32, srcb += 32, dst += 32)
+  {
+    __m256i a = _mm256_loadu_si256((const __m256i *)srca);
+    __m256i b = _mm256_loadu_si256((const __m256i *)srcb);
+    __m256i az = _mm256_cmpeq_epi8(_mm256_and_si256(a, color), zero);
+    __m256i bz = _mm256_cmpeq_epi8(_mm256_and_si256(b, color), zero);
+    __m256i ap = _mm256_cmpeq_epi8(_mm256_and_si256(a, prio), prio);
+    __m256i bp = _mm256_cmpeq_epi8(_mm256_and_si256(b, prio), prio);
+    __m256i sel = _mm256_or_si256(az, _mm256_andnot_si256(ap, _mm256_andnot_si256(bz, bp)));
+    __m256i c = _mm256_and_si256(_mm256_blendv_epi8(a, b, sel), mask);
+    _mm256_storeu_si256((__m256i *)dst, _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_and_si256(c, color), zero), c));
+  }
+
+  if (width >= 16)
+  {
+    _mm_storeu_si128((__m128i *)dst, merge_bg_sse2_16(_mm_loadu_si128((const __m128i *)srca), _mm_loadu_si128((const __m128i *)srcb)));
+    width -= 16;
+    srca += 16;
+    srcb += 16;
+    dst += 16;
+  }
+
+  while (width--)
+  {
+    *dst++ = table[(*srcb++ << 8) | (*srca++)];
+  }
+}
+
+/* sprite pattern lines are only 8 pixels wide */
+static const t_merge_kernels kernels_avx2 = { "avx2", merge_bg_avx2, merge_obj_sse2 };
+
+#endif /* MERGE_X86 */
+
+
+/*--------------------------------------------------------------------------*/
+/* NEON kernels                                                             */
+/*--------------------------------------------------------------------------*/
+
+#ifdef MERGE_NEON
+
+static void merge_bg_neon(const uint8 *srca, const uint8 *srcb, uint8 *dst, const uint8 *table, int width)
+{
+  uint8x16_t color = vdupq_n_u8(0x0f);
+  uint8x16_t prio = vdupq_n_u8(0x40);
+  uint8x16_t mask = vdupq_n_u8(0x7f);
+
+  for (; width >= 16; width -= 16, srca += 16, srcb += 16, dst += 16)
+  {
+    uint8x16_t a = vld1q_u8(srca);
+    uint8x16_t b = vld1q_u8(srcb);
+
+    /* layer A pixel selection mask */
+    uint8x16_t sel = vandq_u8(vtstq_u8(a, color), vornq_u8(vtstq_u8(a, prio), vandq_u8(vtstq_u8(b, prio), vtstq_u8(b, color))));
+    uint8x16_t c = vandq_u8(vbslq_u8(sel, a, b), mask);
+    vst1q_u8(dst, vandq_u8(c, vtstq_u8(c, color)));
+  }
+
+  while (width--)
+  {
+    *dst++ = table[(*srcb++ << 8) | (*srca++)];
+  }
+}
+
+static int merge_obj_neon(uint8 *lb, const uint8 *src, int atex, const uint8 *table)
+{
+  uint8x8_t color = vdup_n_u8(0x0f);
+  uint8x8_t prio = vdup_n_u8(0x40);
+  uint8x8_t s = vorr_u8(vld1_u8(src), vdup_n_u8(atex));
+  uint8x8_t b = vld1_u8(lb);
+  uint8x8_t so = vtst_u8(s, color);
+  uint8x8_t bs = vtst_u8(b, vdup_n_u8(0x80));
+
+  /* background pixel color selection mask */
+  uint8x8_t sel = vbic_u8(vand_u8(vtst_u8(b, prio), vtst_u8(b, color)), vtst_u8(s, prio));
+  uint8x8_t c = vorr_u8(vand_u8(vbsl_u8(sel, b, s), vdup_n_u8(0x3f)), vdup_n_u8(0x80));
+
+  vst1_u8(lb, vbsl_u8(vbic_u8(so, bs), c, b));
+
+  return vget_lane_u64(vreinterpret_u64_u8(vand_u8(so, bs)), 0) ? 0x20 : 0;
+}
+
+static const t_merge_kernels kernels_neon = { "neon", merge_bg_neon, merge_obj_neon };
+
+#endif /* MERGE_NEON */
+
+
+/*--------------------------------------------------------------------------*/
+/* Kernels selection                                                        */
+/*--------------------------------------------------------------------------*/
+
+/* kernels supported by host CPU, from slowest to fastest */
+static const t_merge_kernels *available[4];
+
+void merge_init(void)
+{
+  int count = 0;
+
+  available[count++] = &kernels_scalar;
+
+#ifdef MERGE_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+  {
+    available[count++] = &kernels_sse2;
+  }
+  if (__builtin_cpu_supports("avx2"))
+  {
+    available[count++] = &kernels_avx2;
+  }
+#endif
+
+#ifdef MERGE_NEON
+  /* NEON is mandatory on AArch64 */
+  available[count++] = &kernels_neon;
+#endif
+
+  available[count] = NULL;
+  merge_kernels = available[count - 1];
+}
+
+int merge_select(const char *name)
+{
+  int i;
+
+  for (i = 0; available[i]; i++)
+  {
+    if (!strcmp(available[i]->name, name))
+    {
+      merge_kernels = available[i];
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+const t_merge_kernels *merge_get(int index)
+{
+  return ((index >= 0) && (index < 4)) ? available[index] : NULL;
+}
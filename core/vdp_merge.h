@@ -0,0 +1,66 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Layers merging kernels (scalar, SSE2, AVX2, NEON)
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _VDP_MERGE_H_
+#define _VDP_MERGE_H_
+
+/* Kernels resolving Mode 5 layers priority, when shadow/highlight mode is disabled:  */
+/*  - bg  : dst[i] = table[(srcb[i] << 8) | srca[i]] (table = background layers LUT)  */
+/*  - obj : draws one 8-pixel sprite pattern line into line buffer                    */
+/*          (table = sprite layer LUT), returns sprite collision flag (0x20)          */
+/*                                                                                    */
+/* The scalar implementation uses the look-up tables. SIMD implementations compute    */
+/* the same priority rules with vector compare & select operations, 16 or 32 pixels   */
+/* at once, and are selected at runtime according to CPU features by merge_init().    */
+
+typedef struct
+{
+  const char *name;
+  void (*bg)(const uint8 *srca, const uint8 *srcb, uint8 *dst, const uint8 *table, int width);
+  int (*obj)(uint8 *lb, const uint8 *src, int atex, const uint8 *table);
+} t_merge_kernels;
+
+/* Selected kernels */
+extern const t_merge_kernels *merge_kernels;
+
+/* Function prototypes */
+extern void merge_init(void);
+extern int merge_select(const char *name);
+extern const t_merge_kernels *merge_get(int index);
+
+#endif /* _VDP_MERGE_H_ */
@@ -0,0 +1,470 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Pixel color remapping kernels (scalar, SSE2, AVX2, NEON)
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#include "shared.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(USE_8BPP_RENDERING)
+#define REMAP_X86
+#include <immintrin.h>
+#define TARGET(isa) __attribute__((target(isa)))
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON) && !defined(USE_8BPP_RENDERING)
+#define REMAP_NEON
+#include <arm_neon.h>
+#endif
+
+/* Output pixel channels layout, used by vectorized LCD ghosting filter (see RENDER_PIXEL_LCD) */
+#if defined(USE_15BPP_RENDERING)
+#define LCD_SHIFT_0 10
+#define LCD_SHIFT_1 5
+#define LCD_SHIFT_2 0
+#define LCD_MASK_0  0x1f
+#define LCD_MASK_1  0x1f
+#define LCD_MASK_2  0x1f
+#define LCD_ALPHA   0x8000
+#elif defined(USE_16BPP_RENDERING)
+#define LCD_SHIFT_0 11
+#define LCD_SHIFT_1 5
+#define LCD_SHIFT_2 0
+#define LCD_MASK_0  0x1f
+#define LCD_MASK_1  0x3f
+#define LCD_MASK_2  0x1f
+#define LCD_ALPHA   0x0000
+#elif defined(USE_32BPP_RENDERING)
+#define LCD_ALPHA   0xff000000
+#endif
+
+const t_remap_kernels *remap_kernels;
+
+#if defined(REMAP_X86) && !defined(USE_32BPP_RENDERING)
+/* 32-bit copy of 16-bit palette, for AVX2 gathers */
+static THREAD_LOCAL struct
+{
+  const PIXEL_OUT_T *pal;
+  int dirty;
+  uint32 pal32[0x100];
+} cache;
+#endif
+
+void remap_palette_changed(void)
+{
+#if defined(REMAP_X86) && !defined(USE_32BPP_RENDERING)
+  cache.dirty = 1;
+#endif
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Scalar kernels                                                           */
+/*--------------------------------------------------------------------------*/
+
+static void remap_scalar(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width)
+{
+  do
+  {
+    *dst++ = pal[*src++];
+  }
+  while (--width);
+}
+
+static void remap_lcd_scalar(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width, int rate)
+{
+  do
+  {
+    RENDER_PIXEL_LCD(src,dst,pal,rate);
+  }
+  while (--width);
+}
+
+/* simple enough to be vectorized by the compiler, with aligned stores */
+static void fill_scalar(PIXEL_OUT_T *dst, PIXEL_OUT_T color, int width)
+{
+  do
+  {
+    *dst++ = color;
+  }
+  while (--width);
+}
+
+static const t_remap_kernels kernels_scalar = { "scalar", remap_scalar, remap_lcd_scalar, fill_scalar };
+
+#if defined(REMAP_X86) || defined(REMAP_NEON)
+/* palette look-ups have no efficient SSE2 or NEON equivalent: eight indexes are read at once instead */
+static void remap_unrolled(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width)
+{
+  for (; width >= 8; width -= 8, src += 8, dst += 8)
+  {
+    unsigned long long index;
+    memcpy(&index, src, 8);
+    dst[0] = pal[index & 0xff];
+    dst[1] = pal[(index >> 8) & 0xff];
+    dst[2] = pal[(index >> 16) & 0xff];
+    dst[3] = pal[(index >> 24) & 0xff];
+    dst[4] = pal[(index >> 32) & 0xff];
+    dst[5] = pal[(index >> 40) & 0xff];
+    dst[6] = pal[(index >> 48) & 0xff];
+    dst[7] = pal[index >> 56];
+  }
+
+  while (width--)
+  {
+    *dst++ = pal[*src++];
+  }
+}
+#endif
+
+
+/*--------------------------------------------------------------------------*/
+/* SSE2 kernels                                                             */
+/*--------------------------------------------------------------------------*/
+
+#ifdef REMAP_X86
+
+#ifdef USE_32BPP_RENDERING
+#define SSE2_PIXELS 4
+
+/* ghosting filter applied to 8-bit channels expanded to 16-bit */
+/* 4 palette entries */
+#define LOOKUP_SSE2(src, pal) _mm_set_epi32(pal[src[3]], pal[src[2]], pal[src[1]], pal[src[0]])
+
+TARGET("sse2") static __m128i lcd_blend_channels_sse2(__m128i n, __m128i o, __m128i rate)
+{
+  __m128i d = _mm_sub_epi16(o, n);
+  d = _mm_and_si128(d, _mm_cmpgt_epi16(d, _mm_setzero_si128()));
+  return _mm_add_epi16(n, _mm_srli_epi16(_mm_mullo_epi16(d, rate), 8));
+}
+
+TARGET("sse2") static __m128i lcd_blend_sse2(__m128i n, __m128i o, __m128i rate)
+{
+  __m128i zero = _mm_setzero_si128();
+  __m128i lo = lcd_blend_channels_sse2(_mm_unpacklo_epi8(n, zero), _mm_unpacklo_epi8(o, zero), rate);
+  __m128i hi = lcd_blend_channels_sse2(_mm_unpackhi_epi8(n, zero), _mm_unpackhi_epi8(o, zero), rate);
+  return _mm_or_si128(_mm_packus_epi16(lo, hi), _mm_set1_epi32((int)LCD_ALPHA));
+}
+#else
+#define SSE2_PIXELS 8
+
+/* 8 palette entries */
+#define LOOKUP_SSE2(src, pal) _mm_set_epi16(pal[src[7]], pal[src[6]], pal[src[5]], pal[src[4]], pal[src[3]], pal[src[2]], pal[src[1]], pal[src[0]])
+
+#define LCD_BLEND_CHANNEL_SSE2(shift, mask) \
+{ \
+  __m128i nc = _mm_and_si128(_mm_srli_epi16(n, shift), _mm_set1_epi16(mask)); \
+  __m128i oc = _mm_and_si128(_mm_srli_epi16(o, shift), _mm_set1_epi16(mask)); \
+  __m128i d = _mm_sub_epi16(oc, nc); \
+  d = _mm_and_si128(d, _mm_cmpgt_epi16(d, _mm_setzero_si128())); \
+  nc = _mm_add_epi16(nc, _mm_srli_epi16(_mm_mullo_epi16(d, rate), 8)); \
+  out = _mm_or_si128(out, _mm_slli_epi16(nc, shift)); \
+}
+
+TARGET("sse2") static __m128i lcd_blend_sse2(__m128i n, __m128i o, __m128i rate)
+{
+  __m128i out = _mm_set1_epi16((short)LCD_ALPHA);
+  LCD_BLEND_CHANNEL_SSE2(LCD_SHIFT_0, LCD_MASK_0)
+  LCD_BLEND_CHANNEL_SSE2(LCD_SHIFT_1, LCD_MASK_1)
+  LCD_BLEND_CHANNEL_SSE2(LCD_SHIFT_2, LCD_MASK_2)
+  return out;
+}
+#endif
+
+TARGET("sse2") static void remap_lcd_sse2(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width, int rate)
+{
+  __m128i r = _mm_set1_epi16(rate);
+
+  for (; width >= SSE2_PIXELS; width -= SSE2_PIXELS, src += SSE2_PIXELS, dst += SSE2_PIXELS)
+  {
+    _mm_storeu_si128((__m128i *)dst, lcd_blend_sse2(LOOKUP_SSE2(src, pal), _mm_loadu_si128((const __m128i *)dst), r));
+  }
+
+  while (width--)
+  {
+    RENDER_PIXEL_LCD(src,dst,pal,rate);
+  }
+}
+
+static const t_remap_kernels kernels_sse2 = { "sse2", remap_unrolled, remap_lcd_sse2, fill_scalar };
+
+
+/*--------------------------------------------------------------------------*/
+/* AVX2 kernels                                                             */
+/*--------------------------------------------------------------------------*/
+
+#ifdef USE_32BPP_RENDERING
+#define AVX2_PIXELS 8
+
+/* 8 palette entries */
+#define GATHER_AVX2(src, pal) _mm256_i32gather_epi32((const int *)(pal), _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(src))), 4)
+
+TARGET("avx2") static __m256i lcd_blend_channels_avx2(__m256i n, __m256i o, __m256i rate)
+{
+  __m256i d = _mm256_sub_epi16(o, n);
+  d = _mm256_and_si256(d, _mm256_cmpgt_epi16(d, _mm256_setzero_si256()));
+  return _mm256_add_epi16(n, _mm256_srli_epi16(_mm256_mullo_epi16(d, rate), 8));
+}
+
+TARGET("avx2") static __m256i lcd_blend_avx2(__m256i n, __m256i o, __m256i rate)
+{
+  __m256i zero = _mm256_setzero_si256();
+  __m256i lo = lcd_blend_channels_avx2(_mm256_unpacklo_epi8(n, zero), _mm256_unpacklo_epi8(o, zero), rate);
+  __m256i hi = lcd_blend_channels_avx2(_mm256_unpackhi_epi8(n, zero), _mm256_unpackhi_epi8(o, zero), rate);
+  return _mm256_or_si256(_mm256_packus_epi16(lo, hi), _mm256_set1_epi32((int)LCD_ALPHA));
+}
+#else
+#define AVX2_PIXELS 16
+
+/* 16 palette entries, gathered from 32-bit palette copy then packed back to 16-bit */
+TARGET("avx2") static __m256i gather_avx2(const uint8 *src, const uint32 *pal32)
+{
+  __m128i index = _mm_loadu_si128((const __m128i *)src);
+  __m256i lo = _mm256_i32gather_epi32((const int *)pal32, _mm256_cvtepu8_epi32(index), 4);
+  __m256i hi = _mm256_i32gather_epi32((const int *)pal32, _mm256_cvtepu8_epi32(_mm_srli_si128(index, 8)), 4);
+  return _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xd8);
+}
+
+#define GATHER_AVX2(src, pal) gather_avx2(src, cache.pal32)
+
+#define LCD_BLEND_CHANNEL_AVX2(shift, mask) \
+{ \
+  __m256i nc = _mm256_and_si256(_mm256_srli_epi16(n, shift), _mm256_set1_epi16(mask)); \
+  __m256i oc = _mm256_and_si256(_mm256_srli_epi16(o, shift), _mm256_set1_epi16(mask)); \
+  __m256i d = _mm256_sub_epi16(oc, nc); \
+  d = _mm256_and_si256(d, _mm256_cmpgt_epi16(d, _mm256_setzero_si256())); \
+  nc = _mm256_add_epi16(nc, _mm256_srli_epi16(_mm256_mullo_epi16(d, rate), 8)); \
+  out = _mm256_or_si256(out, _mm256_slli_epi16(nc, shift)); \
+}
+
+TARGET("avx2") static __m256i lcd_blend_avx2(__m256i n, __m256i o, __m256i rate)
+{
+  __m256i out = _mm256_set1_epi16((short)LCD_ALPHA);
+  LCD_BLEND_CHANNEL_AVX2(LCD_SHIFT_0, LCD_MASK_0)
+  LCD_BLEND_CHANNEL_AVX2(LCD_SHIFT_1, LCD_MASK_1)
+  LCD_BLEND_CHANNEL_AVX2(LCD_SHIFT_2, LCD_MASK_2)
+  return out;
+}
+
+static void palette_cache_update(const PIXEL_OUT_T *pal)
+{
+  int i;
+
+  if ((pal != cache.pal) || cache.dirty)
+  {
+    for (i = 0; i < 0x100; i++)
+    {
+      cache.pal32[i] = pal[i];
+    }
+
+    cache.pal = pal;
+    cache.dirty = 0;
+  }
+}
+#endif
+
+TARGET("avx2") static void remap_avx2(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width)
+{
+#ifndef USE_32BPP_RENDERING
+  palette_cache_update(pal);
+#endif
+
+  for (; width >= AVX2_PIXELS; width -= AVX2_PIXELS, src += AVX2_PIXELS, dst += AVX2_PIXELS)
+  {
+    _mm256_storeu_si256((__m256i *)dst, GATHER_AVX2(src, pal));
+  }
+
+  while (width--)
+  {
+    *dst++ = pal[*src++];
+  }
+}
+
+TARGET("avx2") static void remap_lcd_avx2(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width, int rate)
+{
+  __m256i r = _mm256_set1_epi16(rate);
+
+#ifndef USE_32BPP_RENDERING
+  palette_cache_update(pal);
+#endif
+
+  for (; width >= AVX2_PIXELS; width -= AVX2_PIXELS, src += AVX2_PIXELS, dst += AVX2_PIXELS)
+  {
+    _mm256_storeu_si256((__m256i *)dst, lcd_blend_avx2(GATHER_AVX2(src, pal), _mm256_loadu_si256((const __m256i *)dst), r));
+  }
+
+  while (width--)
+  {
+    RENDER_PIXEL_LCD(src,dst,pal,rate);
+  }
+}
+
+static const t_remap_kernels kernels_avx2 = { "avx2", remap_avx2, remap_lcd_avx2, fill_scalar };
+
+#endif /* REMAP_X86 */
+
+
+/*--------------------------------------------------------------------------*/
+/* NEON kernels                                                             */
+/*--------------------------------------------------------------------------*/
+
+#ifdef REMAP_NEON
+
+#ifdef USE_32BPP_RENDERING
+#define NEON_PIXELS 4
+
+static uint16x8_t lcd_blend_channels_neon(uint16x8_t n, uint16x8_t o, uint16x8_t rate)
+{
+  int16x8_t d = vreinterpretq_s16_u16(vsubq_u16(o, n));
+  uint16x8_t decay = vandq_u16(vreinterpretq_u16_s16(d), vcgtq_s16(d, vdupq_n_s16(0)));
+  return vaddq_u16(n, vshrq_n_u16(vmulq_u16(decay, rate), 8));
+}
+
+static uint32x4_t lcd_blend_neon(uint32x4_t n, uint32x4_t o, uint16x8_t rate)
+{
+  uint8x16_t n8 = vreinterpretq_u8_u32(n);
+  uint8x16_t o8 = vreinterpretq_u8_u32(o);
+  uint16x8_t lo = lcd_blend_channels_neon(vmovl_u8(vget_low_u8(n8)), vmovl_u8(vget_low_u8(o8)), rate);
+  uint16x8_t hi = lcd_blend_channels_neon(vmovl_u8(vget_high_u8(n8)), vmovl_u8(vget_high_u8(o8)), rate);
+  uint32x4_t out = vreinterpretq_u32_u8(vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+  return vorrq_u32(out, vdupq_n_u32(LCD_ALPHA));
+}
+
+#define NEON_LOAD(p)      vld1q_u32(p)
+#define NEON_STORE(p, v)  vst1q_u32(p, v)
+#else
+#define NEON_PIXELS 8
+
+#define LCD_BLEND_CHANNEL_NEON(shift, mask) \
+{ \
+  uint16x8_t nc = vandq_u16(vshlq_u16(n, vdupq_n_s16(-(shift))), vdupq_n_u16(mask)); \
+  uint16x8_t oc = vandq_u16(vshlq_u16(o, vdupq_n_s16(-(shift))), vdupq_n_u16(mask)); \
+  int16x8_t d = vreinterpretq_s16_u16(vsubq_u16(oc, nc)); \
+  uint16x8_t decay = vandq_u16(vreinterpretq_u16_s16(d), vcgtq_s16(d, vdupq_n_s16(0))); \
+  nc = vaddq_u16(nc, vshrq_n_u16(vmulq_u16(decay, rate), 8)); \
+  out = vorrq_u16(out, vshlq_u16(nc, vdupq_n_s16(shift))); \
+}
+
+static uint16x8_t lcd_blend_neon(uint16x8_t n, uint16x8_t o, uint16x8_t rate)
+{
+  uint16x8_t out = vdupq_n_u16(LCD_ALPHA);
+  LCD_BLEND_CHANNEL_NEON(LCD_SHIFT_0, LCD_MASK_0)
+  LCD_BLEND_CHANNEL_NEON(LCD_SHIFT_1, LCD_MASK_1)
+  LCD_BLEND_CHANNEL_NEON(LCD_SHIFT_2, LCD_MASK_2)
+  return out;
+}
+
+#define NEON_LOAD(p)      vld1q_u16(p)
+#define NEON_STORE(p, v)  vst1q_u16(p, v)
+#endif
+
+static void remap_lcd_neon(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width, int rate)
+{
+  PIXEL_OUT_T temp[NEON_PIXELS];
+  uint16x8_t r = vdupq_n_u16(rate);
+
+  for (; width >= NEON_PIXELS; width -= NEON_PIXELS, src += NEON_PIXELS, dst += NEON_PIXELS)
+  {
+    remap_unrolled(temp, src, pal, NEON_PIXELS);
+    NEON_STORE(dst, lcd_blend_neon(NEON_LOAD(temp), NEON_LOAD(dst), r));
+  }
+
+  while (width--)
+  {
+    RENDER_PIXEL_LCD(src,dst,pal,rate);
+  }
+}
+
+static const t_remap_kernels kernels_neon = { "neon", remap_unrolled, remap_lcd_neon, fill_scalar };
+
+#endif /* REMAP_NEON */
+
+
+/*--------------------------------------------------------------------------*/
+/* Kernels selection                                                        */
+/*--------------------------------------------------------------------------*/
+
+/* kernels supported by host CPU, from slowest to fastest */
+static const t_remap_kernels *available[4];
+
+void remap_init(void)
+{
+  int count = 0;
+
+  available[count++] = &kernels_scalar;
+
+#ifdef REMAP_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+  {
+    available[count++] = &kernels_sse2;
+  }
+  if (__builtin_cpu_supports("avx2"))
+  {
+    available[count++] = &kernels_avx2;
+  }
+#endif
+
+#ifdef REMAP_NEON
+  /* NEON is mandatory on AArch64 */
+  available[count++] = &kernels_neon;
+#endif
+
+  available[count] = NULL;
+  remap_kernels = available[count - 1];
+  remap_palette_changed();
+}
+
+int remap_select(const char *name)
+{
+  int i;
+
+  for (i = 0; available[i]; i++)
+  {
+    if (!strcmp(available[i]->name, name))
+    {
+      remap_kernels = available[i];
+      remap_palette_changed();
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+const t_remap_kernels *remap_get(int index)
+{
+  return ((index >= 0) && (index < 4)) ? available[index] : NULL;
+}
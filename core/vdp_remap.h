@@ -0,0 +1,68 @@
+/***************************************************************************************
+ *  Genesis Plus GX
+ *  Pixel color remapping kernels (scalar, SSE2, AVX2, NEON)
+ *
+ *  Copyright (C) 2026  Genesis Plus GX contributors
+ *
+ *  Redistribution and use of this code or any derivative works are permitted
+ *  provided that the following conditions are met:
+ *
+ *   - Redistributions may not be sold, nor may they be used in a commercial
+ *     product or activity.
+ *
+ *   - Redistributions that are modified from the original source must include the
+ *     complete source code, including the source code for all components used by a
+ *     binary built from the modified sources. However, as a special exception, the
+ *     source code distributed need not include anything that is normally distributed
+ *     (in either source or binary form) with the major components (compiler, kernel,
+ *     and so on) of the operating system on which the executable runs, unless that
+ *     component itself accompanies the executable.
+ *
+ *   - Redistributions must reproduce the above copyright notice, this list of
+ *     conditions and the following disclaimer in the documentation and/or other
+ *     materials provided with the distribution.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ *  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ *  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ *  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ *  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************************/
+
+#ifndef _VDP_REMAP_H_
+#define _VDP_REMAP_H_
+
+/* Kernels converting VDP pixel data (palette indexes) to output pixel format:      */
+/*  - remap     : dst[i] = pal[src[i]]                                             */
+/*  - remap_lcd : same, blended with previous output (see RENDER_PIXEL_LCD)        */
+/*  - fill      : dst[i] = color                                                   */
+/*                                                                                  */
+/* The scalar implementation is always available. SIMD implementations are built   */
+/* when supported by the compiler and selected at runtime according to CPU features */
+/* by remap_init(). All implementations produce identical output.                  */
+
+typedef struct
+{
+  const char *name;
+  void (*remap)(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width);
+  void (*remap_lcd)(PIXEL_OUT_T *dst, const uint8 *src, const PIXEL_OUT_T *pal, int width, int rate);
+  void (*fill)(PIXEL_OUT_T *dst, PIXEL_OUT_T color, int width);
+} t_remap_kernels;
+
+/* Selected kernels */
+extern const t_remap_kernels *remap_kernels;
+
+/* Function prototypes */
+extern void remap_init(void);
+extern int remap_select(const char *name);
+extern const t_remap_kernels *remap_get(int index);
+extern void remap_palette_changed(void);
+
+#endif /* _VDP_REMAP_H_ */
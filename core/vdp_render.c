@@ -44,6 +44,28 @@
 #include "md_ntsc.h"
 #include "sms_ntsc.h"
 
+#ifdef USE_RENDER_THREAD
+#include <pthread.h>
+
+/* render thread accesses emulator state of the thread that started it */
+#ifdef USE_MULTI_INSTANCE
+#error "USE_RENDER_THREAD is not supported with USE_MULTI_INSTANCE"
+#endif
+#endif
+
+#ifdef USE_NTSC_THREADS
+#include <pthread.h>
+#include <stdint.h>
+
+/* NTSC filter threads write to output bitmap of the thread that started them */
+#ifdef USE_MULTI_INSTANCE
+#error "USE_NTSC_THREADS is not supported with USE_MULTI_INSTANCE"
+#endif
+#ifdef CUSTOM_BLITTER
+#error "USE_NTSC_THREADS is not supported with CUSTOM_BLITTER"
+#endif
+#endif
+
 #ifndef HAVE_NO_SPRITE_LIMIT
 #define MAX_SPRITES_PER_LINE 20
 #define TMS_MAX_SPRITES_PER_LINE 4
@@ -57,16 +79,6 @@ extern md_ntsc_t *md_ntsc;
 extern sms_ntsc_t *sms_ntsc;
 
 
-/* Output pixels type*/
-#if defined(USE_8BPP_RENDERING)
-#define PIXEL_OUT_T uint8
-#elif defined(USE_32BPP_RENDERING)
-#define PIXEL_OUT_T uint32
-#else
-#define PIXEL_OUT_T uint16
-#endif
-
-
 /* Pixel priority look-up tables information */
 #define LUT_MAX     (6)
 #define LUT_SIZE    (0x10000)
@@ -130,10 +142,10 @@ INLINE void WRITE_LONG(void *address, uint32 data)
 */
 #define GET_LSB_TILE(ATTR, LINE) \
   atex = atex_table[(ATTR >> 13) & 7]; \
-  src = (uint32 *)&bg_pattern_cache[(ATTR & 0x00001FFF) << 6 | (LINE)];
+  src = (uint32 *)PATTERN_LINE_M5((ATTR & 0x00001FFF) << 6 | (LINE));
 #define GET_MSB_TILE(ATTR, LINE) \
   atex = atex_table[(ATTR >> 29) & 7]; \
-  src = (uint32 *)&bg_pattern_cache[(ATTR & 0x1FFF0000) >> 10 | (LINE)];
+  src = (uint32 *)PATTERN_LINE_M5((ATTR & 0x1FFF0000) >> 10 | (LINE));
 
 /* Draw 2-cell column (16 pixels high) */
 /*
@@ -147,10 +159,10 @@ INLINE void WRITE_LONG(void *address, uint32 data)
 */
 #define GET_LSB_TILE_IM2(ATTR, LINE) \
   atex = atex_table[(ATTR >> 13) & 7]; \
-  src = (uint32 *)&bg_pattern_cache[((ATTR & 0x000003FF) << 7 | (ATTR & 0x00001800) << 6 | (LINE)) ^ ((ATTR & 0x00001000) >> 6)];
+  src = (uint32 *)PATTERN_LINE_M5(((ATTR & 0x000003FF) << 7 | (ATTR & 0x00001800) << 6 | (LINE)) ^ ((ATTR & 0x00001000) >> 6));
 #define GET_MSB_TILE_IM2(ATTR, LINE) \
   atex = atex_table[(ATTR >> 29) & 7]; \
-  src = (uint32 *)&bg_pattern_cache[((ATTR & 0x03FF0000) >> 9 | (ATTR & 0x18000000) >> 10 | (LINE)) ^ ((ATTR & 0x10000000) >> 22)];
+  src = (uint32 *)PATTERN_LINE_M5(((ATTR & 0x03FF0000) >> 9 | (ATTR & 0x18000000) >> 10 | (LINE)) ^ ((ATTR & 0x10000000) >> 22));
 
 /*
    One column = 2 tiles
@@ -426,7 +438,7 @@ INLINE void WRITE_LONG(void *address, uint32 data)
     { \
       temp |= (lb[i] << 8); \
       lb[i] = TABLE[temp | ATTR]; \
-      status |= ((temp & 0x8000) >> 10); \
+      SPR_STATUS |= ((temp & 0x8000) >> 10); \
     } \
   }
 
@@ -493,8 +505,11 @@ INLINE void WRITE_LONG(void *address, uint32 data)
 #define MAKE_PIXEL(r,g,b) ((0xff << 24) | (r) << 20 | (r) << 16 | (g) << 12 | (g)  << 8 | (b) << 4 | (b))
 #endif
 
+/* 8:8:8 RGB (runtime-selected output pixel formats) */
+#define MAKE_PIXEL_XRGB(r,g,b) ((0xff << 24) | (r) << 20 | (r) << 16 | (g) << 12 | (g)  << 8 | (b) << 4 | (b))
+
 /* Window & Plane A clipping */
-static struct clip_t
+static THREAD_LOCAL struct clip_t
 {
   uint8 left;
   uint8 right;
@@ -552,18 +567,104 @@ static const uint16 tms_palette[16] =
 };
 
 #elif defined(USE_32BPP_RENDERING)
-static const uint32 tms_palette[16] =
+#define tms_palette tms_palette_xrgb
+#endif
+
+/* 8:8:8 RGB (also used by runtime-selected output pixel formats) */
+static const uint32 tms_palette_xrgb[16] =
 {
   0xFF000000, 0xFF000000, 0xFF21C842, 0xFF5EDC78,
   0xFF5455ED, 0xFF7D76FC, 0xFFD4524D, 0xFF42EBF5,
   0xFFFC5554, 0xFFFF7978, 0xFFD4C154, 0xFFE6CE80,
   0xFF21B03B, 0xFFC95BB4, 0xFFCCCCCC, 0xFFFFFFFF
 };
+
+#ifdef USE_COMPACT_PATTERN_CACHE
+/* Cached patterns (128 KB), flipped when read */
+/*
+   Pattern cache base address: NNNNNNNN NNNYYYxxx (Mode 5) or NN NNNNNNNYYYxxx (Mode 4)
+
+   Addresses used by the rendering code still include the VH flip bits
+   of the uncompacted layout (see below), which PATTERN_LINE_M4/M5 apply
+   to the pattern line being read:
+    - vertical flip selects the mirrored pattern row
+    - horizontal flip reverses the order of the 8 pixel bytes (two 32-bit byte swaps)
+*/
+static THREAD_LOCAL uint8 ALIGNED_(4) bg_pattern_cache[0x20000];
+
+/* Horizontally flipped pattern lines (Mode 4 on 315-5124 VDP reads two pattern lines at once) */
+static THREAD_LOCAL uint32 pattern_flip[2][2];
+
+#if defined(__GNUC__)
+#define SWAP_PIXELS(x) __builtin_bswap32(x)
+#elif defined(_MSC_VER)
+#define SWAP_PIXELS(x) _byteswap_ulong(x)
+#else
+#define SWAP_PIXELS(x) (((x) >> 24) | (((x) >> 8) & 0xff00) | (((x) << 8) & 0xff0000) | ((x) << 24))
+#endif
+#else
+/* Cached and flipped patterns (512 KB) */
+static THREAD_LOCAL uint8 ALIGNED_(4) bg_pattern_cache[0x80000];
 #endif
 
-/* Cached and flipped patterns */
-static uint8 ALIGNED_(4) bg_pattern_cache[0x80000];
+/* Pattern cache statistics */
+THREAD_LOCAL t_pattern_stats pattern_stats;
+
+static void decode_pattern_m4(int name);
+static void decode_pattern_m5(int name);
+
+/* Modified patterns are only decoded when first used (VH = position of H flip bit in pattern cache address, 15 in Mode 4, 17 in Mode 5) */
+INLINE void pattern_use(unsigned int addr, int vh)
+{
+  int name = (addr >> 6) & ((1 << (vh - 6)) - 1);
+
+  if (bg_name_dirty[name])
+  {
+    /* decoding time is accounted in render_line, timing each pattern would cost more than decoding it */
+    PROFILE_COUNT(PROF_PATTERN_CACHE);
+    if (vh == 17)
+    {
+      decode_pattern_m5(name);
+    }
+    else
+    {
+      decode_pattern_m4(name);
+    }
+    pattern_stats.decoded++;
+  }
+}
+
+#ifdef USE_COMPACT_PATTERN_CACHE
+/* Flip bits are unpredictable from one pattern to the next, so pattern lines are selected without branching */
+INLINE uint8 *pattern_line(unsigned int addr, int vh, uint32 *buf)
+{
+  uint32 *src = (uint32 *)&bg_pattern_cache[(addr & ((1 << vh) - 1)) ^ (((addr >> (vh + 1)) & 1) * 0x38)];
+  uint32 mask, left, right;
+
+  pattern_use(addr, vh);
+
+  mask = -((addr >> vh) & 1);
+  left = src[0];
+  right = src[1];
+  buf[0] = left ^ ((left ^ SWAP_PIXELS(right)) & mask);
+  buf[1] = right ^ ((right ^ SWAP_PIXELS(left)) & mask);
+  return (uint8 *)buf;
+}
+
+#define PATTERN_LINE_M5(ADDR) pattern_line(ADDR, 17, pattern_flip[0])
+#define PATTERN_LINE_M4(ADDR, N) pattern_line(ADDR, 15, pattern_flip[N])
+#else
+INLINE uint8 *pattern_line(unsigned int addr, int vh)
+{
+  pattern_use(addr, vh);
+  return &bg_pattern_cache[addr];
+}
+
+#define PATTERN_LINE_M5(ADDR) pattern_line(ADDR, 17)
+#define PATTERN_LINE_M4(ADDR, N) pattern_line(ADDR, 15)
+#endif
 
+#ifdef BUILD_TABLES
 /* Sprite pattern name offset look-up table (Mode 5) */
 static uint8 name_lut[0x400];
 
@@ -572,17 +673,79 @@ static uint32 bp_lut[0x10000];
 
 /* Layer priority pixel look-up tables */
 static uint8 lut[LUT_MAX][LUT_SIZE];
+#else
+/* Pre-generated look-up tables (name_lut, bp_lut, lut) */
+#include "vdp_render_tables.h"
+#endif
 
 /* Output pixel data look-up tables*/
-static PIXEL_OUT_T pixel[0x100];
+static THREAD_LOCAL PIXEL_OUT_T pixel[0x100];
 static PIXEL_OUT_T pixel_lut[3][0x200];
 static PIXEL_OUT_T pixel_lut_m4[0x40];
 
+/* XRGB8888 output pixel colors (runtime-selected output pixel formats) */
+#if defined(USE_32BPP_RENDERING)
+#define pixel_xrgb        pixel
+#define pixel_lut_xrgb    pixel_lut
+#define pixel_lut_m4_xrgb pixel_lut_m4
+#define SET_PIXEL(index, data, xrgb) pixel[index] = (xrgb)
+#else
+static THREAD_LOCAL uint32 pixel_xrgb[0x100];
+static uint32 pixel_lut_xrgb[3][0x200];
+static uint32 pixel_lut_m4_xrgb[0x40];
+#define SET_PIXEL(index, data, xrgb) { pixel[index] = (data); pixel_xrgb[index] = (xrgb); }
+#endif
+
+#if !defined(CUSTOM_BLITTER) && !defined(USE_15BPP_RENDERING) && !defined(USE_16BPP_RENDERING)
+/* RGB565 output pixel colors (RGB565 output pixel format & NTSC filter input), converted when needed */
+#define CONVERT_RGB565
+static THREAD_LOCAL struct
+{
+  int dirty;
+  uint16 pal[0x100];
+} pixel_rgb565;
+#endif
+
 /* Background & Sprite line buffers */
-static uint8 linebuf[2][0x200];
+static THREAD_LOCAL uint8 linebuf[2][0x200];
+
+#ifndef CUSTOM_BLITTER
+/* Indexed output (PIXEL_FORMAT_INDEXED) modifications tracking */
+static THREAD_LOCAL struct
+{
+  t_indexed_frame frame;                /* modifications since last render_indexed_frame() call */
+  uint32 palette[0x100];                /* colors of last written line */
+  uint32 gen;                           /* incremented when colors of written lines are modified */
+  uint32 line_gen[INDEXED_MAX_LINES];   /* 'gen' value when line was last written */
+  uint8 check;                          /* output pixel colors have been modified */
+  uint8 restart;                        /* modifications have been read */
+} indexed;
+
+/* Output modifications tracking (all pixel formats), enabled by first render_dirty_lines() call */
+/* VDP pixel data of written lines is compared with the data previously written to the same */
+/* line, lines are also modified when output colors or settings have been modified since. */
+#define DIRTY_MAX_WIDTH 352
+
+static THREAD_LOCAL struct
+{
+  t_dirty_lines frame;                                /* modifications since last render_dirty_lines() call */
+  uint8 src[DIRTY_MAX_LINES][DIRTY_MAX_WIDTH];        /* VDP pixel data of written lines */
+  uint32 palette[0x100];                              /* colors of last written line */
+  uint32 gen;                                         /* incremented when colors or settings of written lines are modified */
+  uint32 line_gen[DIRTY_MAX_LINES];                   /* 'gen' value when line was last written */
+  struct
+  {
+    uint8 *data;
+    int pitch, format, ntsc, x, w;
+  } output;                                           /* settings of last written line */
+  uint8 enabled;                                      /* modifications are tracked */
+  uint8 check;                                        /* output pixel colors have been modified */
+  uint8 restart;                                      /* modifications have been read */
+} dirty_lines;
+#endif
 
 /* Sprite limit flag */
-static uint8 spr_ovr;
+static THREAD_LOCAL uint8 spr_ovr;
 
 /* Sprite parsing lists */
 typedef struct
@@ -593,21 +756,141 @@ typedef struct
   uint16 size;
 } object_info_t;
 
-static object_info_t obj_info[2][MAX_SPRITES_PER_LINE];
+static THREAD_LOCAL object_info_t obj_info[2][MAX_SPRITES_PER_LINE];
 
 /* Sprite Counter */
-static uint8 object_count[2];
+static THREAD_LOCAL uint8 object_count[2];
 
 /* Sprite Collision Info */
-uint16 spr_col;
+THREAD_LOCAL uint16 spr_col;
+
+#ifdef USE_RENDER_THREAD
+/* Mode 5 lines are rendered by a worker thread while CPUs keep running. Rendering */
+/* state only changes through VDP ports, DMA, savestates or frame boundaries, which */
+/* all wait for queued lines to be rendered first (see render_sync), so the output */
+/* is identical to synchronous rendering. Sprite collision & overflow flags set by */
+/* the render thread are kept apart and merged into VDP status on synchronization. */
+#define RENDER_QUEUE_SIZE 512
+
+static struct
+{
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t cond_work;     /* lines have been queued */
+  pthread_cond_t cond_idle;     /* all queued lines have been rendered */
+  int queue[RENDER_QUEUE_SIZE]; /* queued line numbers */
+  unsigned int head;            /* queue write index (emulation thread) */
+  unsigned int tail;            /* queue read index (render thread) */
+  int pending;                  /* set when queue is not empty */
+  int waiting;                  /* render thread waits for queued lines */
+  int syncing;                  /* emulation thread waits for empty queue */
+  int running;
+  int quit;
+} render_thread;
+
+static uint8 spr_status;
+
+#define SPR_STATUS spr_status
+#else
+#define SPR_STATUS status
+#endif
+
+#ifdef USE_NTSC_THREADS
+/* NTSC filtered lines are queued with a copy of their input pixels & palette, then filtered */
+/* at the end of frame (see ntsc_flush) by the calling thread and worker threads, each one */
+/* processing a strip of queued lines. Each line only writes its own output line and lines */
+/* written twice in a frame are flushed in between, so output is identical to synchronous */
+/* filtering. */
+#define NTSC_MAX_THREADS 8
+#define NTSC_MAX_JOBS 320
+#define NTSC_MAX_PALETTES 32
+#define NTSC_MAX_LINES 1024
+
+typedef struct
+{
+  int line;                       /* output line */
+  int width;                      /* input width */
+  int md;                         /* 1 = md_ntsc, 0 = sms_ntsc */
+  int out32;                      /* 1 = XRGB8888 output */
+  int palette;                    /* input palette slot */
+  uint8 src[sizeof(linebuf[0])];  /* input pixels */
+} t_ntsc_job;
+
+static struct
+{
+  pthread_t thread[NTSC_MAX_THREADS - 1];
+  pthread_mutex_t mutex;
+  pthread_cond_t cond_work;       /* lines have been submitted */
+  pthread_cond_t cond_done;       /* all worker threads have filtered their strip */
+  t_ntsc_job *job;                /* queued lines */
+  uint16 (*palette)[0x100];       /* input palettes of queued lines */
+  int jobs;
+  int palettes;
+  unsigned int batch;             /* incremented when queued lines have been filtered */
+  unsigned int queued[NTSC_MAX_LINES]; /* 'batch' value when output line was last queued */
+  int threads;                    /* number of strips (calling thread + worker threads) */
+  unsigned int gen;               /* incremented when queued lines are submitted */
+  int busy;                       /* number of worker threads filtering their strip */
+  int quit;
+  int running;
+} ntsc_threads;
+#endif
+
+THREAD_LOCAL uint8 render_dirty;
+THREAD_LOCAL t_line_stats line_stats;
+
+#ifdef USE_LINE_CACHE
+/* Unchanged lines cache (Mode 5, non-interlaced) */
+/* Rendering state (VRAM, CRAM, VSRAM, SAT cache, registers) only changes through VDP ports, DMA, */
+/* savestates or resets, which all set render_dirty. A line rendered again with no change since */
+/* its sprites were last parsed gives identical pixels: these are restored from the cache, output */
+/* line is left untouched and sprite masking & collision flags from cached line are replayed. */
+#define LINE_CACHE_LINES 240
+#define LINE_CACHE_WIDTH 352
+
+static THREAD_LOCAL struct
+{
+  uint32 changes;                     /* incremented on first rendered line after any change */
+  uint32 stamp[LINE_CACHE_LINES];     /* 'changes' value when line sprites were parsed (0 = not cached) */
+  uint8 ovr_in[LINE_CACHE_LINES];     /* sprite masking flag from previous line */
+  uint8 ovr_out[LINE_CACHE_LINES];    /* sprite masking flag for next line */
+  uint8 col[LINE_CACHE_LINES];        /* sprite collision flag */
+  uint8 pixels[LINE_CACHE_LINES][LINE_CACHE_WIDTH];
+  int last;                           /* last rendered line */
+  uint32 last_changes;                /* 'changes' value when last line was rendered */
+  int store;                          /* current line is being cached */
+  uint8 status;                       /* sprite collision flag before current line */
+
+  /* output settings of cached lines */
+  uint8 *data;
+  int pitch, format, x, y, w, lines, ntsc, limit;
+  void (*bg)(int line);
+  void (*obj)(int line);
+} line_cache;
+#endif
+
+/* Sprite list cache (Mode 5, non-interlaced) */
+/* Sprites visible on each line are indexed in sprite list order with a single walk of the */
+/* linked list, which is only done again once internal SAT Y position, size or link fields */
+/* (see sat_dirty), display width or sprite limits have been modified. */
+#define SPR_CACHE_LINES 0x200
+
+THREAD_LOCAL uint8 sat_dirty;
+
+static THREAD_LOCAL struct
+{
+  int width, total, max;                                      /* settings of cached list */
+  uint8 count[SPR_CACHE_LINES];                               /* visible sprites (up to max + 1) */
+  uint8 index[SPR_CACHE_LINES][MAX_SPRITES_PER_LINE + 1];     /* sprite numbers, in sprite list order */
+} spr_cache;
 
 /* Function pointers */
-void (*render_bg)(int line);
-void (*render_obj)(int line);
-void (*parse_satb)(int line);
-void (*update_bg_pattern_cache)(int index);
+THREAD_LOCAL void (*render_bg)(int line);
+THREAD_LOCAL void (*render_obj)(int line);
+THREAD_LOCAL void (*parse_satb)(int line);
 
 
+#ifdef BUILD_TABLES
 /*--------------------------------------------------------------------------*/
 /* Sprite pattern name offset look-up table function (Mode 5)               */
 /*--------------------------------------------------------------------------*/
@@ -947,12 +1230,21 @@ static uint32 make_lut_bgobj_m4(uint32 bx, uint32 sx)
   return (c | 0x80);
 }
 
+/* look-up tables built by render_init, in vdp_render_tables.h order (see sdl/headless/gen_tables.c) */
+void render_get_tables(const void *tables[3])
+{
+  tables[0] = name_lut;
+  tables[1] = bp_lut;
+  tables[2] = lut;
+}
+#endif /* BUILD_TABLES */
+
 
 /*--------------------------------------------------------------------------*/
 /* Pixel layer merging function                                             */
 /*--------------------------------------------------------------------------*/
 
-INLINE void merge(uint8 *srca, uint8 *srcb, uint8 *dst, uint8 *table, int width)
+INLINE void merge(uint8 *srca, uint8 *srcb, uint8 *dst, const uint8 *table, int width)
 {
   do
   {
@@ -961,6 +1253,21 @@ INLINE void merge(uint8 *srca, uint8 *srcb, uint8 *dst, uint8 *table, int width)
   while (--width);
 }
 
+#ifndef ALT_RENDERER
+/* Mode 5 background layers merging (shadow/highlight mode uses look-up table only) */
+INLINE void merge_bg_m5(void)
+{
+  if (reg[12] & 0x08)
+  {
+    merge(&linebuf[1][0x20], &linebuf[0][0x20], &linebuf[0][0x20], lut[2], bitmap.viewport.w);
+  }
+  else
+  {
+    merge_kernels->bg(&linebuf[1][0x20], &linebuf[0][0x20], &linebuf[0][0x20], lut[0], bitmap.viewport.w);
+  }
+}
+#endif
+
 
 /*--------------------------------------------------------------------------*/
 /* Pixel color lookup tables initialization                                 */
@@ -998,6 +1305,9 @@ static void palette_init(void)
     pixel_lut[0][i] = MAKE_PIXEL(r,g,b);
     pixel_lut[1][i] = MAKE_PIXEL(r<<1,g<<1,b<<1);
     pixel_lut[2][i] = MAKE_PIXEL(r+7,g+7,b+7);
+    pixel_lut_xrgb[0][i] = MAKE_PIXEL_XRGB(r,g,b);
+    pixel_lut_xrgb[1][i] = MAKE_PIXEL_XRGB(r<<1,g<<1,b<<1);
+    pixel_lut_xrgb[2][i] = MAKE_PIXEL_XRGB(r+7,g+7,b+7);
   }
 
   /* Initialize Mode 4 pixel color look-up table */
@@ -1010,9 +1320,23 @@ static void palette_init(void)
 
     /* Expand to full range & convert to output pixel format */
     pixel_lut_m4[i] = MAKE_PIXEL((r << 2) | r, (g << 2) | g, (b << 2) | b);
+    pixel_lut_m4_xrgb[i] = MAKE_PIXEL_XRGB((r << 2) | r, (g << 2) | g, (b << 2) | b);
   }
 }
 
+/* Output pixel colors have been modified */
+INLINE void palette_changed(void)
+{
+  remap_palette_changed();
+#ifdef CONVERT_RGB565
+  pixel_rgb565.dirty = 1;
+#endif
+#ifndef CUSTOM_BLITTER
+  indexed.check = 1;
+  dirty_lines.check = 1;
+#endif
+}
+
 
 /*--------------------------------------------------------------------------*/
 /* Color palette update functions                                           */
@@ -1020,6 +1344,8 @@ static void palette_init(void)
 
 void color_update_m4(int index, unsigned int data)
 {
+  uint32 xrgb;
+
   switch (system_hw)
   {
     case SYSTEM_GG:
@@ -1031,6 +1357,7 @@ void color_update_m4(int index, unsigned int data)
 
       /* Convert to output pixel */
       data = MAKE_PIXEL(r,g,b);
+      xrgb = MAKE_PIXEL_XRGB(r,g,b);
       break;
     }
 
@@ -1043,11 +1370,13 @@ void color_update_m4(int index, unsigned int data)
       {
         /* Colors 1-15 */
         data = tms_palette[index & 0x0F];
+        xrgb = tms_palette_xrgb[index & 0x0F];
       }
       else
       {
         /* Backdrop color */
         data = tms_palette[reg[7] & 0x0F];
+        xrgb = tms_palette_xrgb[reg[7] & 0x0F];
       }
       break;
     }
@@ -1079,6 +1408,7 @@ void color_update_m4(int index, unsigned int data)
       }
 
       /* Mode 4 palette */
+      xrgb = pixel_lut_m4_xrgb[data & 0x3F];
       data = pixel_lut_m4[data & 0x3F];
       break;
     }
@@ -1089,10 +1419,10 @@ void color_update_m4(int index, unsigned int data)
   if (reg[0] & 0x04)
   {
     /* Mode 4 */
-    pixel[0x00 | index] = data;
-    pixel[0x20 | index] = data;
-    pixel[0x80 | index] = data;
-    pixel[0xA0 | index] = data;
+    SET_PIXEL(0x00 | index, data, xrgb);
+    SET_PIXEL(0x20 | index, data, xrgb);
+    SET_PIXEL(0x80 | index, data, xrgb);
+    SET_PIXEL(0xA0 | index, data, xrgb);
   }
   else
   {
@@ -1100,24 +1430,27 @@ void color_update_m4(int index, unsigned int data)
     if ((index == 0x40) || (index == (0x10 | (reg[7] & 0x0F))))
     {
       /* Update backdrop color */
-      pixel[0x40] = data;
+      SET_PIXEL(0x40, data, xrgb);
 
       /* Update transparent color */
-      pixel[0x10] = data;
-      pixel[0x30] = data;
-      pixel[0x90] = data;
-      pixel[0xB0] = data;
+      SET_PIXEL(0x10, data, xrgb);
+      SET_PIXEL(0x30, data, xrgb);
+      SET_PIXEL(0x90, data, xrgb);
+      SET_PIXEL(0xB0, data, xrgb);
     }
 
     if (index & 0x0F)
     {
       /* update non-transparent colors */
-      pixel[0x00 | index] = data;
-      pixel[0x20 | index] = data;
-      pixel[0x80 | index] = data;
-      pixel[0xA0 | index] = data;
+      SET_PIXEL(0x00 | index, data, xrgb);
+      SET_PIXEL(0x20 | index, data, xrgb);
+      SET_PIXEL(0x80 | index, data, xrgb);
+      SET_PIXEL(0xA0 | index, data, xrgb);
     }
   }
+
+  palette_changed();
+  render_dirty = 1;
 }
 
 void color_update_m5(int index, unsigned int data)
@@ -1132,20 +1465,24 @@ void color_update_m5(int index, unsigned int data)
   if(reg[12] & 0x08)
   {
     /* Mode 5 (Shadow/Normal/Highlight) */
-    pixel[0x00 | index] = pixel_lut[0][data];
-    pixel[0x40 | index] = pixel_lut[1][data];
-    pixel[0x80 | index] = pixel_lut[2][data];
+    SET_PIXEL(0x00 | index, pixel_lut[0][data], pixel_lut_xrgb[0][data]);
+    SET_PIXEL(0x40 | index, pixel_lut[1][data], pixel_lut_xrgb[1][data]);
+    SET_PIXEL(0x80 | index, pixel_lut[2][data], pixel_lut_xrgb[2][data]);
   }
   else
   {
     /* Mode 5 (Normal) */
+    uint32 xrgb = pixel_lut_xrgb[1][data];
     data = pixel_lut[1][data];
 
     /* Input pixel: xxiiiiii */
-    pixel[0x00 | index] = data;
-    pixel[0x40 | index] = data;
-    pixel[0x80 | index] = data;
+    SET_PIXEL(0x00 | index, data, xrgb);
+    SET_PIXEL(0x40 | index, data, xrgb);
+    SET_PIXEL(0x80 | index, data, xrgb);
   }
+
+  palette_changed();
+  render_dirty = 1;
 }
 
 
@@ -1493,8 +1830,8 @@ void render_bg_m4(int line)
     if (system_hw <= SYSTEM_SMS)
     {
       /* Cached pattern data lines (4 bytes = 4 pixels at once) for pixels data bits 0:1 and 2:3 */
-      uint32 *src01 = (uint32 *)&bg_pattern_cache[((attr & (0x601 | (reg[3] << 1))) << 6) | v_line];
-      uint32 *src23 = (uint32 *)&bg_pattern_cache[((attr & (0x63F | ((reg[4] & 0x07) << 6))) << 6) | v_line];
+      uint32 *src01 = (uint32 *)PATTERN_LINE_M4(((attr & (0x601 | (reg[3] << 1))) << 6) | v_line, 0);
+      uint32 *src23 = (uint32 *)PATTERN_LINE_M4(((attr & (0x63F | ((reg[4] & 0x07) << 6))) << 6) | v_line, 1);
 
       /* Copy left & right half, retrieving each pixel data bits from appropriate source and adding the attribute bits in */
 #ifdef ALIGN_LONG
@@ -1510,7 +1847,7 @@ void render_bg_m4(int line)
     else
     {
       /* Cached pattern data line (4 bytes = 4 pixels at once) */
-      uint32 *src = (uint32 *)&bg_pattern_cache[((attr & 0x7FF) << 6) | v_line];
+      uint32 *src = (uint32 *)PATTERN_LINE_M4(((attr & 0x7FF) << 6) | v_line, 0);
 
       /* Copy left & right half, adding the attribute bits in */
 #ifdef ALIGN_LONG
@@ -1676,7 +2013,7 @@ void render_bg_m5(int line)
   }
 
   /* Merge background layers */
-  merge(&linebuf[1][0x20], &linebuf[0][0x20], &linebuf[0][0x20], lut[(reg[12] & 0x08) >> 2], bitmap.viewport.w);
+  merge_bg_m5();
 }
 
 void render_bg_m5_vs(int line)
@@ -1866,7 +2203,7 @@ void render_bg_m5_vs(int line)
   }
 
   /* Merge background layers */
-  merge(&linebuf[1][0x20], &linebuf[0][0x20], &linebuf[0][0x20], lut[(reg[12] & 0x08) >> 2], bitmap.viewport.w);
+  merge_bg_m5();
 }
 
 /* Enhanced function that allows each cell to be vscrolled individually, instead of being limited to 2-cell */
@@ -2155,7 +2492,7 @@ void render_bg_m5_vs_enhanced(int line)
   }
 
   /* Merge background layers */
-  merge(&linebuf[1][0x20], &linebuf[0][0x20], &linebuf[0][0x20], lut[(reg[12] & 0x08) >> 2], bitmap.viewport.w);
+  merge_bg_m5();
 }
 
 void render_bg_m5_im2(int line)
@@ -2310,7 +2647,7 @@ void render_bg_m5_im2(int line)
   }
 
   /* Merge background layers */
-  merge(&linebuf[1][0x20], &linebuf[0][0x20], &linebuf[0][0x20], lut[(reg[12] & 0x08) >> 2], bitmap.viewport.w);
+  merge_bg_m5();
 }
 
 void render_bg_m5_im2_vs(int line)
@@ -2503,7 +2840,7 @@ void render_bg_m5_im2_vs(int line)
   }
 
   /* Merge background layers */
-  merge(&linebuf[1][0x20], &linebuf[0][0x20], &linebuf[0][0x20], lut[(reg[12] & 0x08) >> 2], bitmap.viewport.w);
+  merge_bg_m5();
 }
 
 #else
@@ -2526,7 +2863,7 @@ void render_bg_m5(int line)
   int width = bitmap.viewport.w >> 4;
 
   /* Layer priority table */
-  uint8 *table = lut[(reg[12] & 8) >> 2];
+  const uint8 *table = lut[(reg[12] & 8) >> 2];
 
   /* Window vertical range (cell 0-31) */
   int a = (reg[18] & 0x1F) << 3;
@@ -2684,7 +3021,7 @@ void render_bg_m5_vs(int line)
   int width = bitmap.viewport.w >> 4;
 
   /* Layer priority table */
-  uint8 *table = lut[(reg[12] & 8) >> 2];
+  const uint8 *table = lut[(reg[12] & 8) >> 2];
 
   /* Window vertical range (cell 0-31) */
   int a = (reg[18] & 0x1F) << 3;
@@ -2882,7 +3219,7 @@ void render_bg_m5_vs_enhanced(int line)
   int width = bitmap.viewport.w >> 4;
 
   /* Layer priority table */
-  uint8 *table = lut[(reg[12] & 8) >> 2];
+  const uint8 *table = lut[(reg[12] & 8) >> 2];
 
   /* Window vertical range (cell 0-31) */
   int a = (reg[18] & 0x1F) << 3;
@@ -3218,7 +3555,7 @@ void render_bg_m5_im2(int line)
   int width = bitmap.viewport.w >> 4;
 
   /* Layer priority table */
-  uint8 *table = lut[(reg[12] & 8) >> 2];
+  const uint8 *table = lut[(reg[12] & 8) >> 2];
 
   /* Adjust line offset */
   line = (line << 1) + odd_frame;
@@ -3379,7 +3716,7 @@ void render_bg_m5_im2_vs(int line)
   int width = bitmap.viewport.w >> 4;
 
   /* Layer priority table */
-  uint8 *table = lut[(reg[12] & 8) >> 2];
+  const uint8 *table = lut[(reg[12] & 8) >> 2];
 
   /* Adjust line offset */
   line = (line << 1) + odd_frame;
@@ -3749,7 +4086,7 @@ void render_obj_m4(int line)
     temp = (object_info->attr | 0x100) & sg_mask;
 
     /* Pointer to pattern cache line */
-    src = (uint8 *)&bg_pattern_cache[(temp << 6) | (object_info->ypos << 3)];
+    src = PATTERN_LINE_M4((temp << 6) | (object_info->ypos << 3), 0);
 
     /* Sprite X position */
     xpos = object_info->xpos;
@@ -3814,13 +4151,14 @@ void render_obj_m4(int line)
 
 void render_obj_m5(int line)
 {
-  int i, column;
+  int column;
   int xpos, width;
   int pixelcount = 0;
   int masked = 0;
   int max_pixels = MODE5_MAX_SPRITE_PIXELS;
 
-  uint8 *src, *s, *lb;
+  uint8 *src, *lb;
+  const uint8 *s;
   uint32 temp, v_line;
   uint32 attr, name, atex;
 
@@ -3899,8 +4237,8 @@ void render_obj_m5(int line)
       for (column = 0; column < width; column++, lb+=8)
       {
         temp = attr | ((name + s[column]) & 0x07FF);
-        src = &bg_pattern_cache[(temp << 6) | (v_line)];
-        DRAW_SPRITE_TILE(8,atex,lut[1])
+        src = PATTERN_LINE_M5((temp << 6) | (v_line));
+        SPR_STATUS |= merge_kernels->obj(lb, src, atex, lut[1]);
       }
     }
 
@@ -3930,7 +4268,8 @@ void render_obj_m5_ste(int line)
   int masked = 0;
   int max_pixels = MODE5_MAX_SPRITE_PIXELS;
 
-  uint8 *src, *s, *lb;
+  uint8 *src, *lb;
+  const uint8 *s;
   uint32 temp, v_line;
   uint32 attr, name, atex;
 
@@ -4011,7 +4350,7 @@ void render_obj_m5_ste(int line)
       for (column = 0; column < width; column++, lb+=8)
       {
         temp = attr | ((name + s[column]) & 0x07FF);
-        src = &bg_pattern_cache[(temp << 6) | (v_line)];
+        src = PATTERN_LINE_M5((temp << 6) | (v_line));
         DRAW_SPRITE_TILE(8,atex,lut[3])
       }
     }
@@ -4042,13 +4381,14 @@ void render_obj_m5_ste(int line)
 
 void render_obj_m5_im2(int line)
 {
-  int i, column;
+  int column;
   int xpos, width;
   int pixelcount = 0;
   int masked = 0;
   int max_pixels = MODE5_MAX_SPRITE_PIXELS;
 
-  uint8 *src, *s, *lb;
+  uint8 *src, *lb;
+  const uint8 *s;
   uint32 temp, v_line;
   uint32 attr, name, atex;
 
@@ -4126,8 +4466,8 @@ void render_obj_m5_im2(int line)
       for(column = 0; column < width; column ++, lb+=8)
       {
         temp = attr | (((name + s[column]) & 0x3ff) << 1);
-        src = &bg_pattern_cache[((temp << 6) | (v_line)) ^ ((attr & 0x1000) >> 6)];
-        DRAW_SPRITE_TILE(8,atex,lut[1])
+        src = PATTERN_LINE_M5(((temp << 6) | (v_line)) ^ ((attr & 0x1000) >> 6));
+        SPR_STATUS |= merge_kernels->obj(lb, src, atex, lut[1]);
       }
     }
 
@@ -4157,7 +4497,8 @@ void render_obj_m5_im2_ste(int line)
   int masked = 0;
   int max_pixels = MODE5_MAX_SPRITE_PIXELS;
 
-  uint8 *src, *s, *lb;
+  uint8 *src, *lb;
+  const uint8 *s;
   uint32 temp, v_line;
   uint32 attr, name, atex;
 
@@ -4238,7 +4579,7 @@ void render_obj_m5_im2_ste(int line)
       for(column = 0; column < width; column ++, lb+=8)
       {
         temp = attr | (((name + s[column]) & 0x3ff) << 1);
-        src = &bg_pattern_cache[((temp << 6) | (v_line)) ^ ((attr & 0x1000) >> 6)];
+        src = PATTERN_LINE_M5(((temp << 6) | (v_line)) ^ ((attr & 0x1000) >> 6));
         DRAW_SPRITE_TILE(8,atex,lut[3])
       }
     }
@@ -4452,7 +4793,7 @@ void parse_satb_m4(int line)
   object_count[(line + 1) & 1] = count;
 }
 
-void parse_satb_m5(int line)
+static void parse_satb_m5_cache(int max, int total)
 {
   /* Sprite Y position */
   int ypos;
@@ -4460,15 +4801,56 @@ void parse_satb_m5(int line)
   /* Sprite height */
   int height;
 
-  /* Sprite size data */
-  int size;
-
   /* Sprite link data */
   int link = 0;
 
+  /* Pointer to internal RAM */
+  uint16 *q = (uint16 *) &sat[0];
+
+  spr_cache.width = bitmap.viewport.w;
+  spr_cache.total = total;
+  spr_cache.max = max;
+  memset(spr_cache.count, 0, sizeof(spr_cache.count));
+  sat_dirty = 0;
+
+  do
+  {
+    /* Read sprite Y position from internal SAT cache (9 bits) */
+    ypos = q[link] & 0x1FF;
+
+    /* Sprite height (8, 16, 24 or 32 pixels) */
+    height = 8 + ((q[link + 1] >> 5) & 0x18);
+
+    /* Add sprite to lines where it is visible (sprites after overflow are not needed) */
+    for (height += ypos; (ypos < height) && (ypos < SPR_CACHE_LINES); ypos++)
+    {
+      if (spr_cache.count[ypos] <= max)
+      {
+        spr_cache.index[ypos][spr_cache.count[ypos]++] = link >> 2;
+      }
+    }
+
+    /* Read link data from internal SAT cache */
+    link = (q[link + 1] & 0x7F) << 2;
+
+    /* Stop parsing if link data points to first entry (#0) or after the last entry (#64 in H32 mode, #80 in H40 mode) */
+    if ((link == 0) || (link >= bitmap.viewport.w)) break;
+  }
+  while (--total);
+}
+
+void parse_satb_m5(int line)
+{
+  /* Sprite link data */
+  int link;
+
   /* Sprite counter */
   int count = 0;
 
+  /* Cached sprites */
+  int i, n;
+  uint8 *index;
+
   /* max. number of rendered sprites (16 or 20 sprites per line by default) */
   int max = MODE5_MAX_SPRITES_PER_LINE;
 
@@ -4487,54 +4869,38 @@ void parse_satb_m5(int line)
   /* Adjust line offset */
   line += 0x81;
 
-  do
+  /* Index visible sprites of all lines when sprite list has been modified */
+  if (sat_dirty || (spr_cache.width != bitmap.viewport.w) || (spr_cache.total != total) || (spr_cache.max != max))
   {
-    /* Read sprite Y position from internal SAT cache (9 bits) */
-    ypos = q[link] & 0x1FF;
-
-    /* Check if sprite Y position has been reached */
-    if (line >= ypos)
-    {
-      /* Read sprite size from internal SAT cache */
-      size = q[link + 1] >> 8;
-
-      /* Sprite height (8, 16, 24 or 32 pixels) */
-      height = 8 + ((size & 3) << 3);
-
-      /* Y range */
-      ypos = line - ypos;
+    parse_satb_m5_cache(max, total);
+  }
 
-      /* Check if sprite is visible on current line */
-      if (ypos < height)
-      {
-        /* Sprite overflow */
-        if (count == max)
-        {
-          status |= 0x40;
-          break;
-        }
+  n = spr_cache.count[line];
+  index = spr_cache.index[line];
 
-        /* Update sprite list (only name, attribute & xpos are parsed from VRAM) */
-        object_info->attr  = p[link + 2];
-        object_info->xpos  = p[link + 3] & 0x1ff;
-        object_info->ypos  = ypos;
-        object_info->size  = size & 0x0f;
+  for (i = 0; i < n; i++)
+  {
+    /* Sprite overflow */
+    if (count == max)
+    {
+      SPR_STATUS |= 0x40;
+      break;
+    }
 
-        /* Increment Sprite count */
-        ++count;
+    link = index[i] << 2;
 
-        /* Next sprite entry */
-        object_info++;
-      }
-    }
+    /* Update sprite list (only name, attribute & xpos are parsed from VRAM) */
+    object_info->attr  = p[link + 2];
+    object_info->xpos  = p[link + 3] & 0x1ff;
+    object_info->ypos  = line - (q[link] & 0x1FF);
+    object_info->size  = (q[link + 1] >> 8) & 0x0f;
 
-    /* Read link data from internal SAT cache */
-    link = (q[link + 1] & 0x7F) << 2;
+    /* Increment Sprite count */
+    ++count;
 
-    /* Stop parsing if link data points to first entry (#0) or after the last entry (#64 in H32 mode, #80 in H40 mode) */
-    if ((link == 0) || (link >= bitmap.viewport.w)) break;
+    /* Next sprite entry */
+    object_info++;
   }
-  while (--total);
 
   /* Update sprite count for next line (line value already incremented) */
   object_count[line & 1] = count;
@@ -4598,7 +4964,7 @@ void parse_satb_m5_im2(int line)
         /* Sprite overflow */
         if (count == max)
         {
-          status |= 0x40;
+          SPR_STATUS |= 0x40;
           break;
         }
 
@@ -4630,119 +4996,130 @@ void parse_satb_m5_im2(int line)
 
 
 /*--------------------------------------------------------------------------*/
-/* Pattern cache update function                                            */
+/* Pattern cache update functions                                           */
 /*--------------------------------------------------------------------------*/
 
-void update_bg_pattern_cache_m4(int index)
+static void decode_pattern_m4(int name)
 {
-  int i;
   uint8 x, y, c;
   uint8 *dst;
-  uint16 name, bp01, bp23;
+  uint16 bp01, bp23;
   uint32 bp;
 
-  for(i = 0; i < index; i++)
+  /* Pattern cache base address */
+  dst = &bg_pattern_cache[name << 6];
+
+  /* Check modified lines */
+  for(y = 0; y < 8; y++)
   {
-    /* Get modified pattern name index */
-    name = bg_name_list[i];
+    if(bg_name_dirty[name] & (1 << y))
+    {
+      /* Byteplane data */
+      bp01 = *(uint16 *)&vram[(name << 5) | (y << 2) | (0)];
+      bp23 = *(uint16 *)&vram[(name << 5) | (y << 2) | (2)];
 
-    /* Pattern cache base address */
-    dst = &bg_pattern_cache[name << 6];
+      /* Convert to pixel line data (4 bytes = 8 pixels)*/
+      /* (msb) p7p6 p5p4 p3p2 p1p0 (lsb) */
+      bp = (bp_lut[bp01] >> 2) | (bp_lut[bp23]);
 
-    /* Check modified lines */
-    for(y = 0; y < 8; y++)
-    {
-      if(bg_name_dirty[name] & (1 << y))
+      /* Update cached line (8 pixels = 8 bytes) */
+      for(x = 0; x < 8; x++)
       {
-        /* Byteplane data */
-        bp01 = *(uint16 *)&vram[(name << 5) | (y << 2) | (0)];
-        bp23 = *(uint16 *)&vram[(name << 5) | (y << 2) | (2)];
-
-        /* Convert to pixel line data (4 bytes = 8 pixels)*/
-        /* (msb) p7p6 p5p4 p3p2 p1p0 (lsb) */
-        bp = (bp_lut[bp01] >> 2) | (bp_lut[bp23]);
+        /* Extract pixel data */
+        c = bp & 0x0F;
+
+        /* Pattern cache data (one pattern = 8 bytes) */
+        /* byte0 <-> p0 p1 p2 p3 p4 p5 p6 p7 <-> byte7 (hflip = 0) */
+        /* byte0 <-> p7 p6 p5 p4 p3 p2 p1 p0 <-> byte7 (hflip = 1) */
+        dst[0x00000 | (y << 3) | (x)] = (c);            /* vflip=0 & hflip=0 */
+#ifndef USE_COMPACT_PATTERN_CACHE
+        dst[0x08000 | (y << 3) | (x ^ 7)] = (c);        /* vflip=0 & hflip=1 */
+        dst[0x10000 | ((y ^ 7) << 3) | (x)] = (c);      /* vflip=1 & hflip=0 */
+        dst[0x18000 | ((y ^ 7) << 3) | (x ^ 7)] = (c);  /* vflip=1 & hflip=1 */
+#endif
 
-        /* Update cached line (8 pixels = 8 bytes) */
-        for(x = 0; x < 8; x++)
-        {
-          /* Extract pixel data */
-          c = bp & 0x0F;
-
-          /* Pattern cache data (one pattern = 8 bytes) */
-          /* byte0 <-> p0 p1 p2 p3 p4 p5 p6 p7 <-> byte7 (hflip = 0) */
-          /* byte0 <-> p7 p6 p5 p4 p3 p2 p1 p0 <-> byte7 (hflip = 1) */
-          dst[0x00000 | (y << 3) | (x)] = (c);            /* vflip=0 & hflip=0 */
-          dst[0x08000 | (y << 3) | (x ^ 7)] = (c);        /* vflip=0 & hflip=1 */
-          dst[0x10000 | ((y ^ 7) << 3) | (x)] = (c);      /* vflip=1 & hflip=0 */
-          dst[0x18000 | ((y ^ 7) << 3) | (x ^ 7)] = (c);  /* vflip=1 & hflip=1 */
-
-          /* Next pixel */
-          bp = bp >> 4;
-        }
+        /* Next pixel */
+        bp = bp >> 4;
       }
     }
-
-    /* Clear modified pattern flag */
-    bg_name_dirty[name] = 0;
   }
+
+  /* Clear modified pattern flag */
+  bg_name_dirty[name] = 0;
 }
 
-void update_bg_pattern_cache_m5(int index)
+void update_bg_pattern_cache_m4(int index)
 {
   int i;
-  uint8 x, y, c;
-  uint8 *dst;
-  uint16 name;
-  uint32 bp;
 
   for(i = 0; i < index; i++)
   {
-    /* Get modified pattern name index */
-    name = bg_name_list[i];
+    decode_pattern_m4(bg_name_list[i]);
+  }
+}
+
+static void decode_pattern_m5(int name)
+{
+  uint8 x, y, c;
+  uint8 *dst;
+  uint32 bp;
 
-    /* Pattern cache base address */
-    dst = &bg_pattern_cache[name << 6];
+  /* Pattern cache base address */
+  dst = &bg_pattern_cache[name << 6];
 
-    /* Check modified lines */
-    for(y = 0; y < 8; y ++)
+  /* Check modified lines */
+  for(y = 0; y < 8; y ++)
+  {
+    if(bg_name_dirty[name] & (1 << y))
     {
-      if(bg_name_dirty[name] & (1 << y))
-      {
-        /* Byteplane data (one pattern = 4 bytes) */
-        /* LIT_ENDIAN: byte0 (lsb) p2p3 p0p1 p6p7 p4p5 (msb) byte3 */
-        /* BIG_ENDIAN: byte0 (msb) p0p1 p2p3 p4p5 p6p7 (lsb) byte3 */
-        bp = *(uint32 *)&vram[(name << 5) | (y << 2)];
+      /* Byteplane data (one pattern = 4 bytes) */
+      /* LIT_ENDIAN: byte0 (lsb) p2p3 p0p1 p6p7 p4p5 (msb) byte3 */
+      /* BIG_ENDIAN: byte0 (msb) p0p1 p2p3 p4p5 p6p7 (lsb) byte3 */
+      bp = *(uint32 *)&vram[(name << 5) | (y << 2)];
 
-        /* Update cached line (8 pixels = 8 bytes) */
-        for(x = 0; x < 8; x ++)
-        {
-          /* Extract pixel data */
-          c = bp & 0x0F;
+      /* Update cached line (8 pixels = 8 bytes) */
+      for(x = 0; x < 8; x ++)
+      {
+        /* Extract pixel data */
+        c = bp & 0x0F;
 
-          /* Pattern cache data (one pattern = 8 bytes) */
-          /* byte0 <-> p0 p1 p2 p3 p4 p5 p6 p7 <-> byte7 (hflip = 0) */
-          /* byte0 <-> p7 p6 p5 p4 p3 p2 p1 p0 <-> byte7 (hflip = 1) */
+        /* Pattern cache data (one pattern = 8 bytes) */
+        /* byte0 <-> p0 p1 p2 p3 p4 p5 p6 p7 <-> byte7 (hflip = 0) */
+        /* byte0 <-> p7 p6 p5 p4 p3 p2 p1 p0 <-> byte7 (hflip = 1) */
 #ifdef LSB_FIRST
-          /* Byteplane data = (msb) p4p5 p6p7 p0p1 p2p3 (lsb) */
-          dst[0x00000 | (y << 3) | (x ^ 3)] = (c);        /* vflip=0, hflip=0 */
-          dst[0x20000 | (y << 3) | (x ^ 4)] = (c);        /* vflip=0, hflip=1 */
-          dst[0x40000 | ((y ^ 7) << 3) | (x ^ 3)] = (c);  /* vflip=1, hflip=0 */
-          dst[0x60000 | ((y ^ 7) << 3) | (x ^ 4)] = (c);  /* vflip=1, hflip=1 */
+        /* Byteplane data = (msb) p4p5 p6p7 p0p1 p2p3 (lsb) */
+        dst[0x00000 | (y << 3) | (x ^ 3)] = (c);        /* vflip=0, hflip=0 */
+#ifndef USE_COMPACT_PATTERN_CACHE
+        dst[0x20000 | (y << 3) | (x ^ 4)] = (c);        /* vflip=0, hflip=1 */
+        dst[0x40000 | ((y ^ 7) << 3) | (x ^ 3)] = (c);  /* vflip=1, hflip=0 */
+        dst[0x60000 | ((y ^ 7) << 3) | (x ^ 4)] = (c);  /* vflip=1, hflip=1 */
+#endif
 #else
-          /* Byteplane data = (msb) p0p1 p2p3 p4p5 p6p7 (lsb) */
-          dst[0x00000 | (y << 3) | (x ^ 7)] = (c);        /* vflip=0, hflip=0 */
-          dst[0x20000 | (y << 3) | (x)] = (c);            /* vflip=0, hflip=1 */
-          dst[0x40000 | ((y ^ 7) << 3) | (x ^ 7)] = (c);  /* vflip=1, hflip=0 */
-          dst[0x60000 | ((y ^ 7) << 3) | (x)] = (c);      /* vflip=1, hflip=1 */
+        /* Byteplane data = (msb) p0p1 p2p3 p4p5 p6p7 (lsb) */
+        dst[0x00000 | (y << 3) | (x ^ 7)] = (c);        /* vflip=0, hflip=0 */
+#ifndef USE_COMPACT_PATTERN_CACHE
+        dst[0x20000 | (y << 3) | (x)] = (c);            /* vflip=0, hflip=1 */
+        dst[0x40000 | ((y ^ 7) << 3) | (x ^ 7)] = (c);  /* vflip=1, hflip=0 */
+        dst[0x60000 | ((y ^ 7) << 3) | (x)] = (c);      /* vflip=1, hflip=1 */
 #endif
-          /* Next pixel */
-          bp = bp >> 4;
-        }
+#endif
+        /* Next pixel */
+        bp = bp >> 4;
       }
     }
+  }
+
+  /* Clear modified pattern flag */
+  bg_name_dirty[name] = 0;
+}
 
-    /* Clear modified pattern flag */
-    bg_name_dirty[name] = 0;
+void update_bg_pattern_cache_m5(int index)
+{
+  int i;
+
+  for(i = 0; i < index; i++)
+  {
+    decode_pattern_m5(bg_name_list[i]);
   }
 }
 
@@ -4802,51 +5179,174 @@ void window_clip(unsigned int data, unsigned int sw)
 
 void render_init(void)
 {
-  int bx, ax;
+  static int tables_initialized = 0;
 
-  /* Initialize layers priority pixel look-up tables */
-  uint16 index;
-  for (bx = 0; bx < 0x100; bx++)
+  /* look-up tables are shared by all instances and only need to be initialized once */
+  if (tables_initialized)
   {
-    for (ax = 0; ax < 0x100; ax++)
-    {
-      index = (bx << 8) | (ax);
+    return;
+  }
+
+#ifdef BUILD_TABLES
+  {
+    int bx, ax;
+    uint16 index;
 
-      lut[0][index] = make_lut_bg(bx, ax);
-      lut[1][index] = make_lut_bgobj(bx, ax);
-      lut[2][index] = make_lut_bg_ste(bx, ax);
-      lut[3][index] = make_lut_obj(bx, ax);
-      lut[4][index] = make_lut_bgobj_ste(bx, ax);
-      lut[5][index] = make_lut_bgobj_m4(bx,ax);
+    /* Initialize layers priority pixel look-up tables */
+    for (bx = 0; bx < 0x100; bx++)
+    {
+      for (ax = 0; ax < 0x100; ax++)
+      {
+        index = (bx << 8) | (ax);
+
+        lut[0][index] = make_lut_bg(bx, ax);
+        lut[1][index] = make_lut_bgobj(bx, ax);
+        lut[2][index] = make_lut_bg_ste(bx, ax);
+        lut[3][index] = make_lut_obj(bx, ax);
+        lut[4][index] = make_lut_bgobj_ste(bx, ax);
+        lut[5][index] = make_lut_bgobj_m4(bx,ax);
+      }
     }
+
+    /* Make sprite pattern name index look-up table (Mode 5) */
+    make_name_lut();
+
+    /* Make bitplane to pixel look-up table (Mode 4) */
+    make_bp_lut();
   }
+#endif
 
-  /* Initialize pixel color look-up tables */
+  /* Initialize pixel color look-up tables (depend on output pixel format) */
   palette_init();
 
-  /* Make sprite pattern name index look-up table (Mode 5) */
-  make_name_lut();
+  /* Select pixel color remapping & layers merging kernels (depend on host CPU) */
+  remap_init();
+  merge_init();
 
-  /* Make bitplane to pixel look-up table (Mode 4) */
-  make_bp_lut();
+  tables_initialized = 1;
 }
 
-void render_reset(void)
+const uint8 *render_lut(int index)
 {
-  /* Clear display bitmap */
-  memset(bitmap.data, 0, bitmap.pitch * bitmap.height);
-
-  /* Clear line buffers */
-  memset(linebuf, 0, sizeof(linebuf));
-
-  /* Clear color palettes */
-  memset(pixel, 0, sizeof(pixel));
-
-  /* Clear pattern cache */
-  memset ((char *) bg_pattern_cache, 0, sizeof (bg_pattern_cache));
-
-  /* Reset Sprite infos */
-  spr_ovr = spr_col = object_count[0] = object_count[1] = 0;
+  return lut[index];
+}
+
+int render_format_bpp(int format)
+{
+  switch (format)
+  {
+    case PIXEL_FORMAT_NATIVE:
+      return sizeof(PIXEL_OUT_T);
+#ifndef CUSTOM_BLITTER
+#ifndef USE_15BPP_RENDERING
+    case PIXEL_FORMAT_RGB565:
+      /* NTSC filter output depth is fixed to 15-bit in 15-bit pixels rendering */
+      return 2;
+#endif
+    case PIXEL_FORMAT_XRGB8888:
+      return 4;
+    case PIXEL_FORMAT_INDEXED:
+      return 1;
+#endif
+    default:
+      return 0;
+  }
+}
+
+const uint32 *render_palette(void)
+{
+  return pixel_xrgb;
+}
+
+const t_indexed_frame *render_indexed_frame(void)
+{
+#ifndef CUSTOM_BLITTER
+  render_sync();
+
+  /* modifications are cleared when next line is written */
+  indexed.restart = 1;
+  return &indexed.frame;
+#else
+  return NULL;
+#endif
+}
+
+#ifndef CUSTOM_BLITTER
+static void dirty_lines_start(void)
+{
+  /* Start new modifications list */
+  if (dirty_lines.restart)
+  {
+    memset(&dirty_lines.frame, 0, sizeof(dirty_lines.frame));
+    dirty_lines.restart = 0;
+  }
+}
+
+static void dirty_lines_all(void)
+{
+  /* All framebuffer lines are modified, lines written afterwards are compared with nothing */
+  dirty_lines_start();
+  memset(dirty_lines.frame.line, 1, sizeof(dirty_lines.frame.line));
+  dirty_lines.frame.count = DIRTY_MAX_LINES;
+  dirty_lines.gen++;
+}
+#endif
+
+const t_dirty_lines *render_dirty_lines(void)
+{
+#ifndef CUSTOM_BLITTER
+  render_sync();
+
+  /* framebuffer content is unknown to the caller when tracking starts */
+  if (!dirty_lines.enabled)
+  {
+    dirty_lines_all();
+    dirty_lines.enabled = 1;
+  }
+
+  /* modifications are cleared when next line is written */
+  dirty_lines.restart = 1;
+  return &dirty_lines.frame;
+#else
+  return NULL;
+#endif
+}
+
+void render_reset(void)
+{
+  render_sync();
+  ntsc_flush();
+
+  /* Clear display bitmap */
+  memset(bitmap.data, 0, bitmap.pitch * bitmap.height);
+  render_dirty = 1;
+
+  /* Clear line buffers */
+  memset(linebuf, 0, sizeof(linebuf));
+
+  /* Clear color palettes */
+  memset(pixel, 0, sizeof(pixel));
+  memset(pixel_xrgb, 0, sizeof(pixel_xrgb));
+  palette_changed();
+
+#ifndef CUSTOM_BLITTER
+  /* All lines are modified when next written */
+  memset(&indexed, 0, sizeof(indexed));
+  indexed.gen = 1;
+  indexed.restart = 1;
+
+  /* Display bitmap has been cleared */
+  if (dirty_lines.enabled)
+  {
+    dirty_lines_all();
+  }
+#endif
+
+  /* Clear pattern cache */
+  memset ((char *) bg_pattern_cache, 0, sizeof (bg_pattern_cache));
+
+  /* Reset Sprite infos */
+  spr_ovr = spr_col = object_count[0] = object_count[1] = 0;
 }
 
 
@@ -4854,17 +5354,120 @@ void render_reset(void)
 /* Line rendering functions                                                 */
 /*--------------------------------------------------------------------------*/
 
-void render_line(int line)
+#ifdef USE_LINE_CACHE
+static int line_cache_restore(int line)
+{
+  int width = bitmap.viewport.w + 2*bitmap.viewport.x;
+  uint32 stamp;
+
+  /* Rendering state has been modified */
+  if (render_dirty)
+  {
+    render_dirty = 0;
+    if (++line_cache.changes == 0)
+    {
+      /* counter wrap-around: all cached lines are discarded */
+      memset(line_cache.stamp, 0, sizeof(line_cache.stamp));
+      line_cache.changes = 1;
+    }
+  }
+
+  line_cache.store = 0;
+
+  /* Mode 5 only, interlaced output & LCD ghosting filter depend on previous frames */
+  if ((parse_satb != parse_satb_m5) || (line >= LINE_CACHE_LINES) || config.lcd || (interlaced && config.render) ||
+      (bitmap.viewport.x < 0) || (width > LINE_CACHE_WIDTH))
+  {
+    line_cache.last = -2;
+    return 0;
+  }
+
+  /* Output settings have been modified */
+  if ((line_cache.data != bitmap.data) || (line_cache.pitch != bitmap.pitch) || (line_cache.format != bitmap.format) || (line_cache.x != bitmap.viewport.x) ||
+      (line_cache.y != bitmap.viewport.y) || (line_cache.w != bitmap.viewport.w) || (line_cache.lines != lines_per_frame) ||
+      (line_cache.ntsc != config.ntsc) || (line_cache.limit != config.enhanced_vscroll_limit) ||
+      (line_cache.bg != render_bg) || (line_cache.obj != render_obj))
+  {
+    line_cache.data = bitmap.data;
+    line_cache.pitch = bitmap.pitch;
+    line_cache.format = bitmap.format;
+    line_cache.x = bitmap.viewport.x;
+    line_cache.y = bitmap.viewport.y;
+    line_cache.w = bitmap.viewport.w;
+    line_cache.lines = lines_per_frame;
+    line_cache.ntsc = config.ntsc;
+    line_cache.limit = config.enhanced_vscroll_limit;
+    line_cache.bg = render_bg;
+    line_cache.obj = render_obj;
+    memset(line_cache.stamp, 0, sizeof(line_cache.stamp));
+  }
+
+  /* Line sprites are only known to be parsed from same state when previous line has just been rendered */
+  stamp = (line_cache.last == (line - 1)) ? line_cache.last_changes : 0;
+  line_cache.last = line;
+  line_cache.last_changes = line_cache.changes;
+
+  /* No change since cached line sprites were parsed */
+  if (stamp && (stamp == line_cache.changes) && (line_cache.stamp[line] == stamp) && (line_cache.ovr_in[line] == spr_ovr))
+  {
+    memcpy(&linebuf[0][0x20 - bitmap.viewport.x], line_cache.pixels[line], width);
+    spr_ovr = line_cache.ovr_out[line];
+    SPR_STATUS |= line_cache.col[line];
+    line_stats.cached++;
+    return 1;
+  }
+
+  /* Cache rendered line */
+  line_cache.stamp[line] = stamp;
+  line_cache.ovr_in[line] = spr_ovr;
+  line_cache.status = SPR_STATUS & 0x20;
+  SPR_STATUS &= ~0x20;
+  line_cache.store = 1;
+  return 0;
+}
+
+static void line_cache_update(int line)
 {
+  if (line_cache.store)
+  {
+    memcpy(line_cache.pixels[line], &linebuf[0][0x20 - bitmap.viewport.x], bitmap.viewport.w + 2*bitmap.viewport.x);
+    line_cache.ovr_out[line] = spr_ovr;
+    line_cache.col[line] = SPR_STATUS & 0x20;
+    SPR_STATUS |= line_cache.status;
+    line_cache.store = 0;
+  }
+}
+#endif
+
+static void render_scanline(int line)
+{
+  PROFILE_START(PROF_RENDER_LINE);
+
   /* Check display status */
   if (reg[1] & 0x40)
   {
-    /* Update pattern cache */
-    if (bg_list_index)
+    /* Patterns modified since last rendered line are decoded when first used (see pattern_use) */
+    pattern_stats.modified += bg_list_index;
+    bg_list_index = 0;
+
+#ifdef USE_LINE_CACHE
+    /* Unchanged line */
+    if (line_cache_restore(line))
     {
-      update_bg_pattern_cache(bg_list_index);
-      bg_list_index = 0;
+      /* Parse sprites for next line */
+      if (line < (bitmap.viewport.h - 1))
+      {
+        PROFILE_START(PROF_PARSE_SATB);
+        parse_satb(line);
+        PROFILE_END(PROF_PARSE_SATB);
+      }
+
+      PROFILE_END(PROF_RENDER_LINE);
+      return;
     }
+#endif
+
+    line_stats.rendered++;
 
     /* Render BG layer(s) */
     render_bg(line);
@@ -4884,7 +5487,9 @@ void render_line(int line)
     /* Parse sprites for next line */
     if (line < (bitmap.viewport.h - 1))
     {
+      PROFILE_START(PROF_PARSE_SATB);
       parse_satb(line);
+      PROFILE_END(PROF_PARSE_SATB);
     }
 
     /* Horizontal borders */
@@ -4893,6 +5498,10 @@ void render_line(int line)
       memset(&linebuf[0][0x20 - bitmap.viewport.x], 0x40, bitmap.viewport.x);
       memset(&linebuf[0][0x20 + bitmap.viewport.w], 0x40, bitmap.viewport.x);
     }
+
+#ifdef USE_LINE_CACHE
+    line_cache_update(line);
+#endif
   }
   else
   {
@@ -4904,7 +5513,9 @@ void render_line(int line)
       spr_ovr = 0;
 
       /* Sprites are still parsed when display is disabled */
+      PROFILE_START(PROF_PARSE_SATB);
       parse_satb(line);
+      PROFILE_END(PROF_PARSE_SATB);
     }
 
     /* Blanked line */
@@ -4913,27 +5524,419 @@ void render_line(int line)
 
   /* Pixel color remapping */
   remap_line(line);
+
+  PROFILE_END(PROF_RENDER_LINE);
 }
 
-void blank_line(int line, int offset, int width)
+#ifdef USE_RENDER_THREAD
+static void *render_thread_main(void *arg)
 {
-  memset(&linebuf[0][0x20 + offset], 0x40, width);
-  remap_line(line);
+  int line;
+
+  /* rendering time is accounted in render thread counters (see profiler.h) */
+  PROFILE_THREAD(1);
+
+  pthread_mutex_lock(&render_thread.mutex);
+
+  for (;;)
+  {
+    while ((render_thread.head == render_thread.tail) && !render_thread.quit)
+    {
+      render_thread.waiting = 1;
+      pthread_cond_wait(&render_thread.cond_work, &render_thread.mutex);
+      render_thread.waiting = 0;
+    }
+
+    if (render_thread.head == render_thread.tail)
+    {
+      break;
+    }
+
+    line = render_thread.queue[render_thread.tail % RENDER_QUEUE_SIZE];
+    pthread_mutex_unlock(&render_thread.mutex);
+
+    render_scanline(line);
+
+    pthread_mutex_lock(&render_thread.mutex);
+    if (++render_thread.tail == render_thread.head)
+    {
+      /* rendered data is visible to emulation thread once it sees an empty queue */
+      __atomic_store_n(&render_thread.pending, 0, __ATOMIC_RELEASE);
+      if (render_thread.syncing)
+      {
+        pthread_cond_signal(&render_thread.cond_idle);
+      }
+    }
+  }
+
+  pthread_mutex_unlock(&render_thread.mutex);
+  return NULL;
 }
 
-void remap_line(int line)
+int render_thread_start(void)
 {
-  /* Line width */
-  int width = bitmap.viewport.w + 2*bitmap.viewport.x;
+  if (render_thread.running)
+  {
+    return 1;
+  }
 
-  /* Pixel line buffer */
-  uint8 *src = &linebuf[0][0x20 - bitmap.viewport.x];
+  render_thread.head = render_thread.tail = 0;
+  render_thread.pending = 0;
+  render_thread.waiting = 0;
+  render_thread.syncing = 0;
+  render_thread.quit = 0;
+
+  pthread_mutex_init(&render_thread.mutex, NULL);
+  pthread_cond_init(&render_thread.cond_work, NULL);
+  pthread_cond_init(&render_thread.cond_idle, NULL);
+
+  if (pthread_create(&render_thread.thread, NULL, render_thread_main, NULL))
+  {
+    pthread_cond_destroy(&render_thread.cond_idle);
+    pthread_cond_destroy(&render_thread.cond_work);
+    pthread_mutex_destroy(&render_thread.mutex);
+    return 0;
+  }
+
+  render_thread.running = 1;
+  return 1;
+}
+
+void render_thread_stop(void)
+{
+  if (!render_thread.running)
+  {
+    return;
+  }
+
+  render_sync();
+
+  pthread_mutex_lock(&render_thread.mutex);
+  render_thread.quit = 1;
+  pthread_cond_signal(&render_thread.cond_work);
+  pthread_mutex_unlock(&render_thread.mutex);
+
+  pthread_join(render_thread.thread, NULL);
+  pthread_cond_destroy(&render_thread.cond_idle);
+  pthread_cond_destroy(&render_thread.cond_work);
+  pthread_mutex_destroy(&render_thread.mutex);
+  render_thread.running = 0;
+}
+
+void render_sync(void)
+{
+  /* wait until all queued lines have been rendered */
+  if (__atomic_load_n(&render_thread.pending, __ATOMIC_ACQUIRE))
+  {
+    pthread_mutex_lock(&render_thread.mutex);
+    render_thread.syncing = 1;
+    while (render_thread.head != render_thread.tail)
+    {
+      pthread_cond_wait(&render_thread.cond_idle, &render_thread.mutex);
+    }
+    render_thread.syncing = 0;
+    pthread_mutex_unlock(&render_thread.mutex);
+  }
+
+  /* update sprite collision & overflow flags */
+  status |= spr_status;
+  spr_status = 0;
+}
+#endif
+
+#ifdef USE_NTSC_THREADS
+static void ntsc_blit_job(const t_ntsc_job *job)
+{
+  const uint16 *table = ntsc_threads.palette[job->palette];
+
+  if (job->md)
+  {
+    if (job->out32)
+    {
+      md_ntsc_blit_32(md_ntsc, table, (unsigned char *)job->src, job->width, job->line);
+    }
+    else
+    {
+      md_ntsc_blit(md_ntsc, table, (unsigned char *)job->src, job->width, job->line);
+    }
+  }
+  else
+  {
+    if (job->out32)
+    {
+      sms_ntsc_blit_32(sms_ntsc, table, (unsigned char *)job->src, job->width, job->line);
+    }
+    else
+    {
+      sms_ntsc_blit(sms_ntsc, table, (unsigned char *)job->src, job->width, job->line);
+    }
+  }
+}
+
+/* filter one strip of queued lines */
+static void ntsc_blit_strip(int index)
+{
+  int i = (ntsc_threads.jobs * index) / ntsc_threads.threads;
+  int end = (ntsc_threads.jobs * (index + 1)) / ntsc_threads.threads;
+
+  while (i < end)
+  {
+    ntsc_blit_job(&ntsc_threads.job[i++]);
+  }
+}
+
+static void *ntsc_thread_main(void *arg)
+{
+  int index = (int)(intptr_t)arg;
+  unsigned int gen = 0; /* lines may have been submitted before thread started */
+
+  pthread_mutex_lock(&ntsc_threads.mutex);
+
+  for (;;)
+  {
+    while ((ntsc_threads.gen == gen) && !ntsc_threads.quit)
+    {
+      pthread_cond_wait(&ntsc_threads.cond_work, &ntsc_threads.mutex);
+    }
+
+    if (ntsc_threads.quit)
+    {
+      break;
+    }
+
+    gen = ntsc_threads.gen;
+    pthread_mutex_unlock(&ntsc_threads.mutex);
+
+    ntsc_blit_strip(index);
+
+    pthread_mutex_lock(&ntsc_threads.mutex);
+    if (--ntsc_threads.busy == 0)
+    {
+      pthread_cond_signal(&ntsc_threads.cond_done);
+    }
+  }
+
+  pthread_mutex_unlock(&ntsc_threads.mutex);
+  return NULL;
+}
+
+int ntsc_threads_start(int count)
+{
+  if (ntsc_threads.running)
+  {
+    return 1;
+  }
+
+  if ((count < 1) || (count > NTSC_MAX_THREADS))
+  {
+    return 0;
+  }
+
+  ntsc_threads.job = malloc(NTSC_MAX_JOBS * sizeof(t_ntsc_job));
+  ntsc_threads.palette = malloc(NTSC_MAX_PALETTES * sizeof(*ntsc_threads.palette));
+  if (!ntsc_threads.job || !ntsc_threads.palette)
+  {
+    free(ntsc_threads.job);
+    free(ntsc_threads.palette);
+    return 0;
+  }
+
+  ntsc_threads.jobs = 0;
+  ntsc_threads.palettes = 0;
+  ntsc_threads.batch = 1;
+  memset(ntsc_threads.queued, 0, sizeof(ntsc_threads.queued));
+  ntsc_threads.threads = 1;
+  ntsc_threads.gen = 0;
+  ntsc_threads.busy = 0;
+  ntsc_threads.quit = 0;
+
+  pthread_mutex_init(&ntsc_threads.mutex, NULL);
+  pthread_cond_init(&ntsc_threads.cond_work, NULL);
+  pthread_cond_init(&ntsc_threads.cond_done, NULL);
+
+  /* calling thread filters first strip, worker threads filter the others */
+  while (ntsc_threads.threads < count)
+  {
+    if (pthread_create(&ntsc_threads.thread[ntsc_threads.threads - 1], NULL, ntsc_thread_main, (void *)(intptr_t)ntsc_threads.threads))
+    {
+      break;
+    }
+    ntsc_threads.threads++;
+  }
+
+  ntsc_threads.running = 1;
+  return ntsc_threads.threads;
+}
 
+void ntsc_threads_stop(void)
+{
+  int i;
+
+  if (!ntsc_threads.running)
+  {
+    return;
+  }
+
+  render_sync();
+  ntsc_flush();
+
+  pthread_mutex_lock(&ntsc_threads.mutex);
+  ntsc_threads.quit = 1;
+  pthread_cond_broadcast(&ntsc_threads.cond_work);
+  pthread_mutex_unlock(&ntsc_threads.mutex);
+
+  for (i = 1; i < ntsc_threads.threads; i++)
+  {
+    pthread_join(ntsc_threads.thread[i - 1], NULL);
+  }
+
+  pthread_cond_destroy(&ntsc_threads.cond_done);
+  pthread_cond_destroy(&ntsc_threads.cond_work);
+  pthread_mutex_destroy(&ntsc_threads.mutex);
+  free(ntsc_threads.job);
+  free(ntsc_threads.palette);
+  ntsc_threads.job = NULL;
+  ntsc_threads.palette = NULL;
+  ntsc_threads.running = 0;
+}
+
+void ntsc_flush(void)
+{
+  if (!ntsc_threads.jobs)
+  {
+    return;
+  }
+
+  /* wake up worker threads */
+  if (ntsc_threads.threads > 1)
+  {
+    pthread_mutex_lock(&ntsc_threads.mutex);
+    ntsc_threads.busy = ntsc_threads.threads - 1;
+    ntsc_threads.gen++;
+    pthread_cond_broadcast(&ntsc_threads.cond_work);
+    pthread_mutex_unlock(&ntsc_threads.mutex);
+  }
+
+  ntsc_blit_strip(0);
+
+  /* wait until all strips have been filtered */
+  if (ntsc_threads.threads > 1)
+  {
+    pthread_mutex_lock(&ntsc_threads.mutex);
+    while (ntsc_threads.busy)
+    {
+      pthread_cond_wait(&ntsc_threads.cond_done, &ntsc_threads.mutex);
+    }
+    pthread_mutex_unlock(&ntsc_threads.mutex);
+  }
+
+  ntsc_threads.jobs = 0;
+  ntsc_threads.palettes = 0;
+  ntsc_threads.batch++;
+}
+#endif
+
+#if !defined(CUSTOM_BLITTER) || defined(USE_15BPP_RENDERING) || defined(USE_16BPP_RENDERING)
+/* NTSC filter (md_ntsc for H40 mode, sms_ntsc otherwise), 32-bit XRGB8888 or 15/16-bit RGB output */
+static void ntsc_blit(const uint16 *table, uint8 *src, int width, int line, int out32)
+{
+#ifdef USE_NTSC_THREADS
+  if (ntsc_threads.running && (line < NTSC_MAX_LINES))
+  {
+    t_ntsc_job *job;
+
+    /* an output line written twice is filtered in order */
+    if (ntsc_threads.queued[line] == ntsc_threads.batch)
+    {
+      ntsc_flush();
+    }
+    ntsc_threads.queued[line] = ntsc_threads.batch;
+
+    /* input palette is copied when modified */
+    if (!ntsc_threads.palettes || memcmp(ntsc_threads.palette[ntsc_threads.palettes - 1], table, sizeof(*ntsc_threads.palette)))
+    {
+      if (ntsc_threads.palettes == NTSC_MAX_PALETTES)
+      {
+        ntsc_flush();
+      }
+      memcpy(ntsc_threads.palette[ntsc_threads.palettes++], table, sizeof(*ntsc_threads.palette));
+    }
+
+    job = &ntsc_threads.job[ntsc_threads.jobs];
+    job->line = line;
+    job->width = width;
+    job->md = reg[12] & 0x01;
+    job->out32 = out32;
+    job->palette = ntsc_threads.palettes - 1;
+    memcpy(job->src, src, width);
+
+    if (++ntsc_threads.jobs == NTSC_MAX_JOBS)
+    {
+      ntsc_flush();
+    }
+    return;
+  }
+#endif
+
+  if (reg[12] & 0x01)
+  {
+#ifndef CUSTOM_BLITTER
+    if (out32)
+    {
+      md_ntsc_blit_32(md_ntsc, table, src, width, line);
+      return;
+    }
+#endif
+    md_ntsc_blit(md_ntsc, table, src, width, line);
+  }
+  else
+  {
+#ifndef CUSTOM_BLITTER
+    if (out32)
+    {
+      sms_ntsc_blit_32(sms_ntsc, table, src, width, line);
+      return;
+    }
+#endif
+    sms_ntsc_blit(sms_ntsc, table, src, width, line);
+  }
+}
+#endif
+
+void render_line(int line)
+{
+#ifdef USE_RENDER_THREAD
+  /* Mode 5 lines are queued to render thread (Mega Drive & Mega CD frames only) */
+  if (render_thread.running && (reg[1] & 0x04) && (system_hw != SYSTEM_PBC))
+  {
+    pthread_mutex_lock(&render_thread.mutex);
+    if ((render_thread.head - render_thread.tail) < RENDER_QUEUE_SIZE)
+    {
+      render_thread.queue[render_thread.head++ % RENDER_QUEUE_SIZE] = line;
+      __atomic_store_n(&render_thread.pending, 1, __ATOMIC_RELAXED);
+      if (render_thread.waiting)
+      {
+        pthread_cond_signal(&render_thread.cond_work);
+      }
+      pthread_mutex_unlock(&render_thread.mutex);
+      return;
+    }
+    pthread_mutex_unlock(&render_thread.mutex);
+  }
+
+  render_sync();
+#endif
+
+  render_scanline(line);
+}
+
+static int remap_line_offset(int line)
+{
   /* Adjust line offset in framebuffer */
   line = (line + bitmap.viewport.y) % lines_per_frame;
 
   /* Take care of Game Gear reduced screen when overscan is disabled */
-  if (line < 0) return;
+  if (line < 0) return -1;
 
   /* Adjust for interlaced output */
   if (interlaced && config.render)
@@ -4941,18 +5944,360 @@ void remap_line(int line)
     line = (line * 2) + odd_frame;
   }
 
-#if defined(USE_15BPP_RENDERING) || defined(USE_16BPP_RENDERING)
-  /* NTSC Filter (only supported for 15 or 16-bit pixels rendering) */
-  if (config.ntsc)
+  return line;
+}
+
+#ifndef CUSTOM_BLITTER
+/* Compile-time output pixel format */
+#if defined(USE_16BPP_RENDERING)
+#define NATIVE_FORMAT PIXEL_FORMAT_RGB565
+#elif defined(USE_32BPP_RENDERING)
+#define NATIVE_FORMAT PIXEL_FORMAT_XRGB8888
+#else
+#define NATIVE_FORMAT PIXEL_FORMAT_NATIVE
+#endif
+
+INLINE int output_format(void)
+{
+  return (bitmap.format == NATIVE_FORMAT) ? PIXEL_FORMAT_NATIVE : bitmap.format;
+}
+
+#ifdef CONVERT_RGB565
+static const uint16 *palette_rgb565(void)
+{
+  if (pixel_rgb565.dirty)
   {
-    if (reg[12] & 0x01)
+    int i;
+    for (i = 0; i < 0x100; i++)
     {
-      md_ntsc_blit(md_ntsc, ( MD_NTSC_IN_T const * )pixel, src, width, line);
+      uint32 xrgb = pixel_xrgb[i];
+      pixel_rgb565.pal[i] = ((xrgb >> 8) & 0xf800) | ((xrgb >> 5) & 0x07e0) | ((xrgb >> 3) & 0x001f);
+    }
+    pixel_rgb565.dirty = 0;
+  }
+
+  return pixel_rgb565.pal;
+}
+#elif defined(USE_16BPP_RENDERING)
+#define palette_rgb565() (pixel)
+#endif
+
+/* NTSC filter input pixels (see md_ntsc_config.h) */
+#if defined(USE_15BPP_RENDERING)
+#define NTSC_IN_TABLE pixel
+#else
+#define NTSC_IN_TABLE palette_rgb565()
+#endif
+
+/* LCD ghosting filter applied to one color channel (see RENDER_PIXEL_LCD) */
+INLINE uint32 lcd_channel(uint32 in, uint32 old, int shift, int mask, int rate)
+{
+  int c = (in >> shift) & mask;
+  int decay = (int)((old >> shift) & mask) - c;
+  if (decay > 0) c += (rate * decay) >> 8;
+  return c << shift;
+}
+
+static void dirty_line(int line, const uint8 *src, int width)
+{
+  if (!dirty_lines.enabled) return;
+
+  dirty_lines_start();
+
+  /* Output colors of written lines are modified */
+  if (dirty_lines.check)
+  {
+    if (memcmp(dirty_lines.palette, pixel_xrgb, sizeof(dirty_lines.palette)))
+    {
+      memcpy(dirty_lines.palette, pixel_xrgb, sizeof(dirty_lines.palette));
+      dirty_lines.gen++;
+    }
+    dirty_lines.check = 0;
+  }
+
+  /* Output settings of written lines are modified */
+  if ((dirty_lines.output.data != bitmap.data) || (dirty_lines.output.pitch != bitmap.pitch) ||
+      (dirty_lines.output.format != bitmap.format) || (dirty_lines.output.ntsc != config.ntsc) ||
+      (dirty_lines.output.x != bitmap.viewport.x) || (dirty_lines.output.w != bitmap.viewport.w))
+  {
+    dirty_lines.output.data = bitmap.data;
+    dirty_lines.output.pitch = bitmap.pitch;
+    dirty_lines.output.format = bitmap.format;
+    dirty_lines.output.ntsc = config.ntsc;
+    dirty_lines.output.x = bitmap.viewport.x;
+    dirty_lines.output.w = bitmap.viewport.w;
+    dirty_lines.gen++;
+  }
+
+  if (line < DIRTY_MAX_LINES)
+  {
+    /* LCD ghosting filter output also depends on previous frames */
+    if (config.lcd || (width > DIRTY_MAX_WIDTH))
+    {
+      dirty_lines.line_gen[line] = 0;
+    }
+    else if ((dirty_lines.line_gen[line] == dirty_lines.gen) && !memcmp(dirty_lines.src[line], src, width))
+    {
+      return;
     }
     else
     {
-      sms_ntsc_blit(sms_ntsc, ( SMS_NTSC_IN_T const * )pixel, src, width, line);
+      memcpy(dirty_lines.src[line], src, width);
+      dirty_lines.line_gen[line] = dirty_lines.gen;
     }
+
+    if (!dirty_lines.frame.line[line])
+    {
+      dirty_lines.frame.line[line] = 1;
+      dirty_lines.frame.count++;
+    }
+  }
+}
+
+static void remap_line_indexed(int line, const uint8 *src, int width)
+{
+  uint8 *dst = &bitmap.data[(line * bitmap.pitch)];
+
+  /* Start new modifications list */
+  if (indexed.restart)
+  {
+    memcpy(indexed.frame.palette, indexed.palette, sizeof(indexed.palette));
+    memset(indexed.frame.dirty, 0, sizeof(indexed.frame.dirty));
+    indexed.frame.changes = 0;
+    indexed.frame.overflow = 0;
+    indexed.restart = 0;
+  }
+
+  /* Record colors modified since last written line */
+  if (indexed.check)
+  {
+    int i, modified = 0;
+    for (i = 0; i < 0x100; i++)
+    {
+      if (indexed.palette[i] != pixel_xrgb[i])
+      {
+        indexed.palette[i] = pixel_xrgb[i];
+        if (indexed.frame.changes < INDEXED_MAX_CHANGES)
+        {
+          indexed.frame.change[indexed.frame.changes].color = pixel_xrgb[i];
+          indexed.frame.change[indexed.frame.changes].index = i;
+          indexed.frame.changes++;
+        }
+        else
+        {
+          indexed.frame.overflow = 1;
+        }
+        modified = 1;
+      }
+    }
+    indexed.gen += modified;
+    indexed.check = 0;
+  }
+
+  if (line < INDEXED_MAX_LINES)
+  {
+    if ((indexed.line_gen[line] != indexed.gen) || memcmp(dst, src, width))
+    {
+      indexed.frame.dirty[line] = 1;
+      indexed.line_gen[line] = indexed.gen;
+    }
+    indexed.frame.palette_changes[line] = indexed.frame.changes;
+  }
+
+  /* VDP pixel data is output as is */
+  memcpy(dst, src, width);
+}
+
+#ifdef CONVERT_RGB565
+static void remap_line_rgb565(int line, uint8 *src, int width)
+{
+  uint16 *dst = (uint16 *)&bitmap.data[(line * bitmap.pitch)];
+  const uint16 *pal = palette_rgb565();
+
+  if (config.ntsc)
+  {
+    ntsc_blit(pal, src, width, line, 0);
+  }
+  else if (config.lcd)
+  {
+    do
+    {
+      uint32 in = pal[*src++];
+      *dst = lcd_channel(in, *dst, 11, 0x1f, config.lcd) | lcd_channel(in, *dst, 5, 0x3f, config.lcd) | lcd_channel(in, *dst, 0, 0x1f, config.lcd);
+      dst++;
+    }
+    while (--width);
+  }
+  else
+  {
+    do
+    {
+      *dst++ = pal[*src++];
+    }
+    while (--width);
+  }
+}
+#endif
+
+#ifndef USE_32BPP_RENDERING
+static void remap_line_xrgb8888(int line, uint8 *src, int width)
+{
+  uint32 *dst = (uint32 *)&bitmap.data[(line * bitmap.pitch)];
+  const uint32 *pal = pixel_xrgb;
+
+  if (config.ntsc)
+  {
+    ntsc_blit(NTSC_IN_TABLE, src, width, line, 1);
+  }
+  else if (config.lcd)
+  {
+    do
+    {
+      uint32 in = pal[*src++];
+      *dst = 0xff000000 | lcd_channel(in, *dst, 16, 0xff, config.lcd) | lcd_channel(in, *dst, 8, 0xff, config.lcd) | lcd_channel(in, *dst, 0, 0xff, config.lcd);
+      dst++;
+    }
+    while (--width);
+  }
+  else
+  {
+    do
+    {
+      *dst++ = pal[*src++];
+    }
+    while (--width);
+  }
+}
+#endif
+#endif
+
+void blank_line(int line, int offset, int width)
+{
+  render_sync();
+  memset(&linebuf[0][0x20 + offset], 0x40, width);
+
+#ifndef CUSTOM_BLITTER
+  if (!config.ntsc && !config.lcd)
+  {
+    /* Full blanked line is filled with backdrop color directly */
+    if ((offset == -bitmap.viewport.x) && (width == (bitmap.viewport.w + 2*bitmap.viewport.x)))
+    {
+      line = remap_line_offset(line);
+      if (line >= 0)
+      {
+        uint8 *dst = &bitmap.data[(line * bitmap.pitch)];
+        dirty_line(line, &linebuf[0][0x20 + offset], width);
+        switch (output_format())
+        {
+          case PIXEL_FORMAT_INDEXED:
+          {
+            remap_line_indexed(line, &linebuf[0][0x20 + offset], width);
+            break;
+          }
+
+#ifdef CONVERT_RGB565
+          case PIXEL_FORMAT_RGB565:
+          {
+            uint16 *out = (uint16 *)dst;
+            uint16 color = palette_rgb565()[0x40];
+            do
+            {
+              *out++ = color;
+            }
+            while (--width);
+            break;
+          }
+#endif
+
+#ifndef USE_32BPP_RENDERING
+          case PIXEL_FORMAT_XRGB8888:
+          {
+            uint32 *out = (uint32 *)dst;
+            uint32 color = pixel_xrgb[0x40];
+            do
+            {
+              *out++ = color;
+            }
+            while (--width);
+            break;
+          }
+#endif
+
+          default:
+          {
+            remap_kernels->fill((PIXEL_OUT_T *)dst, pixel[0x40], width);
+            break;
+          }
+        }
+      }
+      return;
+    }
+  }
+#endif
+
+  remap_line(line);
+}
+
+void remap_line(int line)
+{
+  /* Line width */
+  int width = bitmap.viewport.w + 2*bitmap.viewport.x;
+
+  /* Pixel line buffer */
+  uint8 *src = &linebuf[0][0x20 - bitmap.viewport.x];
+
+  /* Adjust line offset in framebuffer */
+  line = remap_line_offset(line);
+  if (line < 0) return;
+
+#ifndef CUSTOM_BLITTER
+  /* Track output modifications */
+  dirty_line(line, src, width);
+
+  /* Runtime-selected output pixel format */
+  switch (output_format())
+  {
+    case PIXEL_FORMAT_INDEXED:
+    {
+      remap_line_indexed(line, src, width);
+      return;
+    }
+
+#ifdef CONVERT_RGB565
+    case PIXEL_FORMAT_RGB565:
+    {
+      remap_line_rgb565(line, src, width);
+      return;
+    }
+#endif
+
+#ifndef USE_32BPP_RENDERING
+    case PIXEL_FORMAT_XRGB8888:
+    {
+      remap_line_xrgb8888(line, src, width);
+      return;
+    }
+#endif
+
+    default:
+    {
+      break;
+    }
+  }
+#endif
+
+#if defined(USE_15BPP_RENDERING) || defined(USE_16BPP_RENDERING)
+  /* NTSC Filter (only supported for 15, 16 or 32-bit pixels rendering) */
+  if (config.ntsc)
+  {
+    ntsc_blit(pixel, src, width, line, 0);
+  }
+  else
+#elif defined(USE_32BPP_RENDERING) && !defined(CUSTOM_BLITTER)
+  /* NTSC Filter (RGB565 input pixels) */
+  if (config.ntsc)
+  {
+    ntsc_blit(palette_rgb565(), src, width, line, 1);
   }
   else
 #endif
@@ -4964,19 +6309,11 @@ void remap_line(int line)
     PIXEL_OUT_T *dst = ((PIXEL_OUT_T *)&bitmap.data[(line * bitmap.pitch)]);
     if (config.lcd)
     {
-      do
-      {
-        RENDER_PIXEL_LCD(src,dst,pixel,config.lcd);
-      }
-      while (--width);
+      remap_kernels->remap_lcd(dst, src, pixel, width, config.lcd);
     }
     else
     {
-      do
-      {
-        *dst++ = pixel[*src++];
-      }
-      while (--width);
+      remap_kernels->remap(dst, src, pixel, width);
     }
  #endif
   }
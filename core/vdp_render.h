@@ -79,6 +79,22 @@
 #define GET_B(pixel) (((pixel) & 0x0000ff) >> 0)
 #endif
 
+/* Output pixels type*/
+#if defined(USE_8BPP_RENDERING)
+#define PIXEL_OUT_T uint8
+#elif defined(USE_32BPP_RENDERING)
+#define PIXEL_OUT_T uint32
+#else
+#define PIXEL_OUT_T uint16
+#endif
+
+/* Output pixel formats (bitmap.format) */
+/* Other formats than the compile-time one are converted by the scalar remapping code (see render_format_bpp) */
+#define PIXEL_FORMAT_NATIVE   0   /* compile-time format (PIXEL_OUT_T) */
+#define PIXEL_FORMAT_RGB565   1   /* 16-bit 5:6:5 RGB */
+#define PIXEL_FORMAT_XRGB8888 2   /* 32-bit 8:8:8 RGB */
+#define PIXEL_FORMAT_INDEXED  3   /* 8-bit VDP pixel data, see render_palette & render_indexed_frame */
+
 /* LCD image persistence (ghosting) filter */
 /* Simulates (roughly) the slow decay response time of passive-matrix LCD */
 /* Rate value is formatted as 0.8 fixed-point integer (between 0.0 and 0.99609375), a higher value meaning a slower decay */
@@ -99,11 +115,80 @@
   *out++ = PIXEL(r,g,b); \
 }
 
+/* Pattern cache statistics (modified patterns are only decoded when first used) */
+typedef struct
+{
+  uint32 modified;  /* patterns modified before a rendered line */
+  uint32 decoded;   /* patterns decoded */
+} t_pattern_stats;
+
+/* Unchanged lines cache statistics */
+typedef struct
+{
+  uint32 rendered;  /* rendered lines */
+  uint32 cached;    /* lines restored from cache */
+} t_line_stats;
+
+/* Indexed output modifications (PIXEL_FORMAT_INDEXED) */
+/* Colors of a written line are the initial palette with the first 'palette_changes[line]' changes applied in order */
+#define INDEXED_MAX_LINES   640   /* framebuffer lines (PAL interlaced output with borders) */
+#define INDEXED_MAX_CHANGES 4096  /* palette changes */
+
+typedef struct
+{
+  uint32 color;     /* XRGB8888 color */
+  uint8 index;      /* palette index (VDP pixel data) */
+} t_palette_change;
+
+typedef struct
+{
+  uint32 palette[0x100];                      /* initial XRGB8888 colors */
+  int changes;                                /* number of palette changes */
+  int overflow;                               /* 1 = more than INDEXED_MAX_CHANGES changes, colors of lines written afterwards are unknown */
+  t_palette_change change[INDEXED_MAX_CHANGES];
+  uint16 palette_changes[INDEXED_MAX_LINES];  /* number of palette changes applied to written line colors */
+  uint8 dirty[INDEXED_MAX_LINES];             /* 1 = line pixels or colors have been modified */
+} t_indexed_frame;
+
+/* Output modifications (all pixel formats) */
+#define DIRTY_MAX_LINES 640   /* framebuffer lines (PAL interlaced output with borders) */
+
+typedef struct
+{
+  int count;                      /* number of modified lines */
+  uint8 line[DIRTY_MAX_LINES];    /* 1 = framebuffer line has been modified */
+} t_dirty_lines;
+
 /* Global variables */
-extern uint16 spr_col;
+extern THREAD_LOCAL uint16 spr_col;
+extern THREAD_LOCAL t_pattern_stats pattern_stats;
+extern THREAD_LOCAL t_line_stats line_stats;
+extern THREAD_LOCAL uint8 render_dirty;  /* set when rendering state is modified (see vdp_render.c) */
+extern THREAD_LOCAL uint8 sat_dirty;     /* set when internal SAT Y position, size or link fields are modified */
+
+/* Threaded rendering (see vdp_render.c) */
+#ifdef USE_RENDER_THREAD
+extern int render_thread_start(void);
+extern void render_thread_stop(void);
+extern void render_sync(void);
+#else
+#define render_sync()
+#endif
+
+/* Multithreaded NTSC filter (see vdp_render.c) */
+#ifdef USE_NTSC_THREADS
+extern int ntsc_threads_start(int count);
+extern void ntsc_threads_stop(void);
+extern void ntsc_flush(void);
+#else
+#define ntsc_flush()
+#endif
 
 /* Function prototypes */
 extern void render_init(void);
+#ifdef BUILD_TABLES
+extern void render_get_tables(const void *tables[3]);
+#endif
 extern void render_reset(void);
 extern void render_line(int line);
 extern void blank_line(int line, int offset, int width);
@@ -134,13 +219,17 @@ extern void parse_satb_m5(int line);
 extern void parse_satb_m5_im2(int line);
 extern void update_bg_pattern_cache_m4(int index);
 extern void update_bg_pattern_cache_m5(int index);
+extern const uint8 *render_lut(int index);
+extern int render_format_bpp(int format);
+extern const uint32 *render_palette(void);
+extern const t_indexed_frame *render_indexed_frame(void);
+extern const t_dirty_lines *render_dirty_lines(void);
 extern void color_update_m4(int index, unsigned int data);
 extern void color_update_m5(int index, unsigned int data);
 
 /* Function pointers */
-extern void (*render_bg)(int line);
-extern void (*render_obj)(int line);
-extern void (*parse_satb)(int line);
-extern void (*update_bg_pattern_cache)(int index);
+extern THREAD_LOCAL void (*render_bg)(int line);
+extern THREAD_LOCAL void (*render_obj)(int line);
+extern THREAD_LOCAL void (*parse_satb)(int line);
 
 #endif /* _RENDER_H_ */
@@ -204,24 +204,25 @@
 
 #ifdef Z80_OVERCLOCK_SHIFT
 #define USE_CYCLES(A) Z80.cycles += ((A) * z80_cycle_ratio) >> Z80_OVERCLOCK_SHIFT
-UINT32 z80_cycle_ratio;
+THREAD_LOCAL UINT32 z80_cycle_ratio;
 #else
 #define USE_CYCLES(A) Z80.cycles += (A)
 #endif
 
-Z80_Regs Z80;
-UINT8 z80_last_fetch;
+THREAD_LOCAL Z80_Regs Z80;
+THREAD_LOCAL UINT8 z80_last_fetch;
 
-unsigned char *z80_readmap[64];
-unsigned char *z80_writemap[64];
+THREAD_LOCAL unsigned char *z80_readmap[64];
+THREAD_LOCAL unsigned char *z80_writemap[64];
 
-void (*z80_writemem)(unsigned int address, unsigned char data);
-unsigned char (*z80_readmem)(unsigned int address);
-void (*z80_writeport)(unsigned int port, unsigned char data);
-unsigned char (*z80_readport)(unsigned int port);
+THREAD_LOCAL void (*z80_writemem)(unsigned int address, unsigned char data);
+THREAD_LOCAL unsigned char (*z80_readmem)(unsigned int address);
+THREAD_LOCAL void (*z80_writeport)(unsigned int port, unsigned char data);
+THREAD_LOCAL unsigned char (*z80_readport)(unsigned int port);
 
-static UINT32 EA;
+static THREAD_LOCAL UINT32 EA;
 
+#ifdef BUILD_TABLES
 static UINT8 SZ[256];       /* zero and sign flags */
 static UINT8 SZ_BIT[256];   /* zero, sign and parity/overflow (=zero) flags for BIT opcode */
 static UINT8 SZP[256];      /* zero, sign and parity flags */
@@ -230,6 +231,9 @@ static UINT8 SZHV_dec[256]; /* zero, sign, half carry and overflow flags DEC r8
 
 static UINT8 SZHVC_add[2*256*256]; /* flags for ADD opcode */
 static UINT8 SZHVC_sub[2*256*256]; /* flags for SUB opcode */
+#else
+#include "z80_tables.h"
+#endif
 
 static const UINT16 cc_op[0x100] = {
    4*15,10*15, 7*15, 6*15, 4*15, 4*15, 7*15, 4*15, 4*15,11*15, 7*15, 6*15, 4*15, 4*15, 7*15, 4*15,
@@ -3297,10 +3301,11 @@ static void take_interrupt(void)
   WZ=PCD;
 }
 
+#ifdef BUILD_TABLES
 /****************************************************************************
- * Processor initialization
+ * Flag tables initialization
  ****************************************************************************/
-void z80_init(const void *config, int (*irqcallback)(int))
+static void init_tables(void)
 {
   int i, p;
 
@@ -3309,6 +3314,7 @@ void z80_init(const void *config, int (*irqcallback)(int))
   UINT8 *padc = &SZHVC_add[256*256];
   UINT8 *psub = &SZHVC_sub[  0*256];
   UINT8 *psbc = &SZHVC_sub[256*256];
+
   for (oldval = 0; oldval < 256; oldval++)
   {
     for (newval = 0; newval < 256; newval++)
@@ -3374,6 +3380,36 @@ void z80_init(const void *config, int (*irqcallback)(int))
     if( i == 0x7f ) SZHV_dec[i] |= VF;
     if( (i & 0x0f) == 0x0f ) SZHV_dec[i] |= HF;
   }
+}
+
+/* flag tables built by z80_init, in z80_tables.h order (see sdl/headless/gen_tables.c) */
+void z80_get_tables(const void *tables[7])
+{
+  tables[0] = SZ;
+  tables[1] = SZ_BIT;
+  tables[2] = SZP;
+  tables[3] = SZHV_inc;
+  tables[4] = SZHV_dec;
+  tables[5] = SZHVC_add;
+  tables[6] = SZHVC_sub;
+}
+#endif
+
+/****************************************************************************
+ * Processor initialization
+ ****************************************************************************/
+void z80_init(const void *config, int (*irqcallback)(int))
+{
+#ifdef BUILD_TABLES
+  static int tables_initialized = 0;
+
+  /* flag tables are shared by all instances and only need to be initialized once */
+  if (!tables_initialized)
+  {
+    init_tables();
+    tables_initialized = 1;
+  }
+#endif
 
   /* Initialize Z80 */
   memset(&Z80, 0, sizeof(Z80));
@@ -3419,19 +3455,23 @@ void z80_reset(void)
  ****************************************************************************/
 void z80_run(unsigned int cycles)
 {
+  PROFILE_START(PROF_Z80);
+
   while( Z80.cycles < cycles )
   {
     /* check for IRQs before each instruction */
     if (Z80.irq_state && IFF1 && !Z80.after_ei)
     {
       take_interrupt();
-      if (Z80.cycles >= cycles) return;
+      if (Z80.cycles >= cycles) break;
     }
 
     Z80.after_ei = FALSE;
     R++;
     EXEC_INLINE(op,ROP());
   }
+
+  PROFILE_END(PROF_Z80);
 } 
 
 /****************************************************************************
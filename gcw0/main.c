@@ -651,8 +651,8 @@ static int sdl_control_update(SDLKey keystate)
         if (f)
         {
             uint8 buf[STATE_SIZE];
-            fread(&buf, STATE_SIZE, 1, f);
-            state_load(buf);
+            int len = fread(&buf, 1, STATE_SIZE, f);
+            state_load(buf, len);
             fclose(f);
         }
         break;
@@ -1663,8 +1663,8 @@ static int gcw0menu(void)
                     if (f)
                     {
                         uint8 buf[STATE_SIZE];
-                        fread(&buf, STATE_SIZE, 1, f);
-                        state_load(buf);
+                        int len = fread(&buf, 1, STATE_SIZE, f);
+                        state_load(buf, len);
                         fclose(f);
                     }
                     if (config.sl_autoresume)
@@ -2183,8 +2183,8 @@ int sdl_input_update(void)
             if (f)
             {
                 uint8 buf[STATE_SIZE];
-                fread(&buf, STATE_SIZE, 1, f);
-                state_load(buf);
+                int len = fread(&buf, 1, STATE_SIZE, f);
+                state_load(buf, len);
                 fclose(f);
             }
             SDL_Delay(250);
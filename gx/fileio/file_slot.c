@@ -547,7 +547,7 @@ int slot_load(int slot, int device)
   if (slot > 0)
   {
     /* Load state */
-    if (state_load(buffer) <= 0)
+    if (state_load(buffer, done) <= 0)
     {
       free(buffer);
       GUI_WaitPrompt("Error","Invalid state file !");
@@ -84,6 +84,12 @@
 #define Z80_MAX_CYCLES 345
 #define OVERCLOCK_FRAME_DELAY 100
 
+#ifndef RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT
+/* from newer libretro.h */
+#define RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT (72 | RETRO_ENVIRONMENT_EXPERIMENTAL)
+#define RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_INSTANCE 1
+#endif
+
 #ifdef M68K_OVERCLOCK_SHIFT
 #ifndef HAVE_OVERCLOCK
 #define HAVE_OVERCLOCK
@@ -191,6 +197,16 @@ static uint32_t overclock_delay;
 
 static bool libretro_supports_option_categories = false;
 static bool libretro_supports_bitmasks          = false;
+static bool libretro_supports_dupe              = false;
+
+/* Last frame passed to frontend */
+static struct
+{
+   const void *data;
+   unsigned width;
+   unsigned height;
+   bool valid;    /* frame content is the one reported by render_dirty_lines() */
+} video_last;
 
 #define SOUND_FREQUENCY 44100
 
@@ -3085,24 +3101,32 @@ void retro_set_controller_port_device(unsigned port, unsigned device)
    input_reset();
 }
 
-size_t retro_serialize_size(void) { return STATE_SIZE; }
+size_t retro_serialize_size(void)
+{
+   /* largest savestate size for loaded game hardware, whatever FM core or audio buffer usage */
+   return state_size();
+}
 
 bool retro_serialize(void *data, size_t size)
 { 
-   if (size != STATE_SIZE)
+   int context = 0;
+
+   if (size < retro_serialize_size())
       return FALSE;
 
-   state_save(data);
+   /* snapshots can only be restored by this instance (run-ahead): */
+   /* netplay states are sent to other instances, and kept portable */
+   if (environ_cb(RETRO_ENVIRONMENT_GET_SAVESTATE_CONTEXT, &context) && (context == RETRO_SAVESTATE_CONTEXT_RUNAHEAD_SAME_INSTANCE))
+      return state_snapshot_save(data) ? TRUE : FALSE;
 
+   state_save(data);
    return TRUE;
 }
 
 bool retro_unserialize(const void *data, size_t size)
 {
-   if (size != STATE_SIZE)
-      return FALSE;
-
-   if (!state_load((uint8_t*)data))
+   /* state_load checks savestate length against provided data */
+   if (!state_load((uint8_t*)data, size))
       return FALSE;
 
 #ifdef HAVE_OVERCLOCK
@@ -3187,6 +3211,8 @@ bool retro_load_game(const struct retro_game_info *info)
    g_rom_data      = NULL;
    g_rom_size      = 0;
 
+   video_last.valid = false;
+
    /* Attempt to fetch extended game info */
    if (environ_cb(RETRO_ENVIRONMENT_GET_GAME_INFO_EXT, &info_ext))
    {
@@ -3428,6 +3454,22 @@ bool retro_load_game(const struct retro_game_info *info)
    system_reset();
    is_running = false;
 
+#ifdef USE_RENDER_THREAD
+   if (!render_thread_start() && log_cb)
+      log_cb(RETRO_LOG_WARN, "Could not create render thread, rendering synchronously.\n");
+#endif
+
+#ifdef USE_NTSC_THREADS
+   /* NTSC filter is applied to 4 strips of each frame, 3 of them on worker threads */
+   if ((ntsc_threads_start(4) < 4) && log_cb)
+      log_cb(RETRO_LOG_WARN, "Could not create all NTSC filter threads.\n");
+#endif
+
+#ifdef USE_FM_THREAD
+   if (!fm_thread_start() && log_cb)
+      log_cb(RETRO_LOG_WARN, "Could not create FM thread, synthesizing YM2612 samples synchronously.\n");
+#endif
+
    if (system_hw == SYSTEM_MCD)
       bram_load();
 
@@ -3471,6 +3513,16 @@ void retro_unload_game(void)
    if (system_hw == SYSTEM_MCD)
       bram_save();
 
+#ifdef USE_FM_THREAD
+   fm_thread_stop();
+#endif
+#ifdef USE_NTSC_THREADS
+   ntsc_threads_stop();
+#endif
+#ifdef USE_RENDER_THREAD
+   render_thread_stop();
+#endif
+
    audio_shutdown();
    if (md_ntsc)
       free(md_ntsc);
@@ -3566,6 +3618,9 @@ void retro_init(void)
    if (environ_cb(RETRO_ENVIRONMENT_GET_INPUT_BITMASKS, NULL))
       libretro_supports_bitmasks = true;
 
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_CAN_DUPE, &libretro_supports_dupe))
+      libretro_supports_dupe = false;
+
    check_system_specs();
 
    environ_cb(RETRO_ENVIRONMENT_SET_SERIALIZATION_QUIRKS, &serialization_quirks);
@@ -3585,6 +3640,7 @@ void retro_deinit(void)
 {
    libretro_supports_option_categories = false;
    libretro_supports_bitmasks          = false;
+   libretro_supports_dupe              = false;
 
    g_rom_data = NULL;
    g_rom_size = 0;
@@ -3599,9 +3655,35 @@ void retro_reset(void)
    gen_reset(0);
 }
 
+/* Check if frame passed to frontend is unchanged since last displayed frame */
+static bool video_frame_unchanged(const void *data, unsigned width, unsigned height)
+{
+   int av_enable = 0;
+   const t_dirty_lines *dirty;
+   bool unchanged;
+
+   /* frames which are not displayed (run-ahead) are not checked, their modifications are reported with next displayed frame */
+   if (environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable) && !(av_enable & 1))
+      return false;
+
+   dirty = render_dirty_lines();
+   unchanged = libretro_supports_dupe && video_last.valid && !dirty->count &&
+               (video_last.data == data) && (video_last.width == width) && (video_last.height == height);
+
+   /* light gun cursor is drawn in framebuffer */
+   video_last.data   = data;
+   video_last.width  = width;
+   video_last.height = height;
+   video_last.valid  = !config.gun_cursor;
+
+   return unchanged;
+}
+
 void retro_run(void) 
 {
    int do_skip = 0;
+   int av_enable = 0;
+   int mute;
    bool updated = false;
    int vwoffset = 0;
    int bmdoffset = 0;
@@ -3661,6 +3743,15 @@ void retro_run(void)
     update_audio_latency = false;
   }
 
+   /* sound samples are only skipped for frames whose emulation is discarded afterwards: run-ahead secondary */
+   /* instance (audio hard disabled) or run-ahead/rollback frames (audio disabled, fast savestates), since   */
+   /* FM chips internal state is not updated while muted. Fast-forward or muted frontend frames are kept.    */
+   if (!environ_cb(RETRO_ENVIRONMENT_GET_AUDIO_VIDEO_ENABLE, &av_enable))
+      av_enable = 3;
+   mute = (av_enable & 8) || ((av_enable & 6) == 4);
+   if (mute != snd.muted)
+      audio_set_mute(mute);
+
    if (system_hw == SYSTEM_MCD)
    {
       system_frame_scd(do_skip);
@@ -3725,7 +3816,11 @@ void retro_run(void)
 
    if (!do_skip)
    {
-        video_cb(bitmap.data + bmdoffset, vwidth - vwoffset, vheight, 720 * 2);	
+        /* unchanged frames are duplicated by frontend */
+        if (video_frame_unchanged(bitmap.data + bmdoffset, vwidth - vwoffset, vheight))
+            video_cb(NULL, vwidth - vwoffset, vheight, 720 * 2);
+        else
+            video_cb(bitmap.data + bmdoffset, vwidth - vwoffset, vheight, 720 * 2);
    }
    else
    {
@@ -0,0 +1,235 @@
+/*
+ *  gen_tables.c
+ *
+ *  Look-up tables generator
+ *
+ *  Writes the pre-generated table headers included by the core when it is
+ *  not built with BUILD_TABLES defined:
+ *
+ *    core/vdp_render_tables.h   (name_lut, bp_lut, lut)
+ *    core/z80/z80_tables.h      (flag tables)
+ *    core/sound/ym2612_tables.h (tl_tab, sin_tab, lfo_pm_table)
+ *    core/sound/ym2413_tables.h (tl_tab, sin_tab)
+ *
+ *  Tables are the ones built at init by the core itself (render_init, z80_init,
+ *  YM2612Init, YM2413Init), so this is only linked in BUILD_TABLES builds of
+ *  the headless frontend (-tables option).
+ *
+ *  usage: make -f Makefile.headless tables
+ *         make -f Makefile.headless tables-check (compare with current headers)
+ */
+
+#include "shared.h"
+#include "gen_tables.h"
+
+/* Generated files use the same line endings as the core sources */
+#define EOL "\r\n"
+
+static FILE *open_table(const char *dir, const char *name)
+{
+  char path[1024];
+  FILE *f;
+
+  snprintf(path, sizeof(path), "%s/%s", dir, name);
+  f = fopen(path, "wb");
+  if (!f)
+  {
+    fprintf(stderr, "Unable to create %s\n", path);
+    exit(1);
+  }
+
+  fprintf(f, "/* Pre-generated look-up tables (generated by sdl/headless/gen_tables.c, do not edit) */" EOL);
+  return f;
+}
+
+static void close_table(FILE *f)
+{
+  if (ferror(f) || fclose(f))
+  {
+    fprintf(stderr, "Write error\n");
+    exit(1);
+  }
+}
+
+/* Writes array values, 'cols' per line, with given indentation */
+static void write_values(FILE *f, const void *data, int size, int count, int cols, const char *indent)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+  {
+    if ((i % cols) == 0)
+    {
+      fputs(indent, f);
+    }
+
+    switch (size)
+    {
+      case 1:
+        fprintf(f, "0x%02x", ((const unsigned char *)data)[i]);
+        break;
+      case 4:
+        fprintf(f, "0x%08x", ((const unsigned int *)data)[i]);
+        break;
+      default:
+        fprintf(f, "%6d", ((const int *)data)[i]);
+        break;
+    }
+
+    if (i == (count - 1))
+    {
+      fputs(EOL, f);
+    }
+    else if ((i % cols) == (cols - 1))
+    {
+      fputs("," EOL, f);
+    }
+    else
+    {
+      fputs(", ", f);
+    }
+  }
+}
+
+static void write_bytes(FILE *f, const char *decl, const unsigned char *data, int count)
+{
+  fprintf(f, EOL "%s =" EOL "{" EOL, decl);
+  write_values(f, data, 1, count, 16, "  ");
+  fprintf(f, "};" EOL);
+}
+
+static void write_ints(FILE *f, const char *decl, const int *data, int count)
+{
+  fprintf(f, EOL "%s =" EOL "{" EOL, decl);
+  write_values(f, data, 0, count, 16, "  ");
+  fprintf(f, "};" EOL);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* VDP tables (core/vdp_render.c)                                           */
+/*--------------------------------------------------------------------------*/
+
+#define LUT_MAX     (6)
+#define LUT_SIZE    (0x10000)
+
+static void write_vdp_tables(const char *dir)
+{
+  static unsigned int bp_lut_swap[0x10000];
+  const void *tables[3];
+  const unsigned char *lut;
+  const unsigned int *bp_lut;
+  int i;
+  FILE *f;
+
+  render_init();
+  render_get_tables(tables);
+  bp_lut = tables[1];
+  lut = tables[2];
+
+  /* bitplanes byte order depends on host endianness, other layout has both bytes of the index swapped */
+  for (i = 0; i < 0x10000; i++)
+  {
+    bp_lut_swap[((i & 0xff) << 8) | (i >> 8)] = bp_lut[i];
+  }
+
+  f = open_table(dir, "vdp_render_tables.h");
+
+  write_bytes(f, "static const uint8 name_lut[0x400]", tables[0], 0x400);
+
+  fprintf(f, EOL "#ifdef LSB_FIRST" EOL "static const uint32 bp_lut[0x10000] =" EOL "{" EOL);
+#ifdef LSB_FIRST
+  write_values(f, bp_lut, 4, 0x10000, 8, "  ");
+#else
+  write_values(f, bp_lut_swap, 4, 0x10000, 8, "  ");
+#endif
+  fprintf(f, "};" EOL "#else" EOL "static const uint32 bp_lut[0x10000] =" EOL "{" EOL);
+#ifdef LSB_FIRST
+  write_values(f, bp_lut_swap, 4, 0x10000, 8, "  ");
+#else
+  write_values(f, bp_lut, 4, 0x10000, 8, "  ");
+#endif
+  fprintf(f, "};" EOL "#endif" EOL);
+
+  fprintf(f, EOL "static const uint8 lut[LUT_MAX][LUT_SIZE] =" EOL "{" EOL);
+  for (i = 0; i < LUT_MAX; i++)
+  {
+    fprintf(f, "  {" EOL);
+    write_values(f, &lut[i * LUT_SIZE], 1, LUT_SIZE, 16, "    ");
+    fprintf(f, (i < (LUT_MAX - 1)) ? "  }," EOL : "  }" EOL);
+  }
+  fprintf(f, "};" EOL);
+
+  close_table(f);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* Z80 flag tables (core/z80/z80.c)                                         */
+/*--------------------------------------------------------------------------*/
+
+static void write_z80_tables(const char *dir)
+{
+  const void *tables[7];
+  FILE *f;
+
+  z80_init(0, 0);
+  z80_get_tables(tables);
+
+  f = open_table(dir, "z80/z80_tables.h");
+  write_bytes(f, "static const UINT8 SZ[256]", tables[0], 256);
+  write_bytes(f, "static const UINT8 SZ_BIT[256]", tables[1], 256);
+  write_bytes(f, "static const UINT8 SZP[256]", tables[2], 256);
+  write_bytes(f, "static const UINT8 SZHV_inc[256]", tables[3], 256);
+  write_bytes(f, "static const UINT8 SZHV_dec[256]", tables[4], 256);
+  write_bytes(f, "static const UINT8 SZHVC_add[2*256*256]", tables[5], 2*256*256);
+  write_bytes(f, "static const UINT8 SZHVC_sub[2*256*256]", tables[6], 2*256*256);
+  close_table(f);
+}
+
+
+/*--------------------------------------------------------------------------*/
+/* FM tables (core/sound/ym2612.c & core/sound/ym2413.c)                    */
+/*--------------------------------------------------------------------------*/
+
+#define SIN_LEN     (1<<10)
+#define TL_RES_LEN  (256)
+
+static void write_ym2612_tables(const char *dir)
+{
+  const void *tables[3];
+  FILE *f;
+
+  YM2612Init();
+  YM2612GetTables(tables);
+
+  f = open_table(dir, "sound/ym2612_tables.h");
+  write_ints(f, "static const signed int tl_tab[TL_TAB_LEN]", tables[0], 13*2*TL_RES_LEN);
+  write_ints(f, "static const unsigned int sin_tab[SIN_LEN]", tables[1], SIN_LEN);
+  write_ints(f, "static const INT32 lfo_pm_table[128*8*32]", tables[2], 128*8*32);
+  close_table(f);
+}
+
+static void write_ym2413_tables(const char *dir)
+{
+  const void *tables[2];
+  FILE *f;
+
+  YM2413Init();
+  YM2413GetTables(tables);
+
+  f = open_table(dir, "sound/ym2413_tables.h");
+  write_ints(f, "static const signed int tl_tab[TL_TAB_LEN]", tables[0], 11*2*TL_RES_LEN);
+  write_ints(f, "static const unsigned int sin_tab[SIN_LEN * 2]", tables[1], SIN_LEN * 2);
+  close_table(f);
+}
+
+int gen_tables(const char *dir)
+{
+  write_vdp_tables(dir);
+  write_z80_tables(dir);
+  write_ym2612_tables(dir);
+  write_ym2413_tables(dir);
+
+  return 0;
+}
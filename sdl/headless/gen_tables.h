@@ -0,0 +1,7 @@
+#ifndef _GEN_TABLES_H_
+#define _GEN_TABLES_H_
+
+/* writes core look-up tables headers into given core directory (BUILD_TABLES builds only) */
+extern int gen_tables(const char *dir);
+
+#endif /* _GEN_TABLES_H_ */
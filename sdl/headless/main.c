@@ -0,0 +1,1867 @@
+/*
+ *  main.c
+ *
+ *  Headless benchmark frontend
+ *
+ *  Runs a fixed number of frames with no video, audio or input device attached
+ *  and reports emulation speed and output checksums, so that core performance
+ *  regressions can be tracked from the command line.
+ */
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#ifdef USE_MULTI_INSTANCE
+#include <pthread.h>
+#endif
+
+#include <zlib.h>
+
+#include "shared.h"
+#include "sms_ntsc.h"
+#include "md_ntsc.h"
+#ifdef BUILD_TABLES
+#include "gen_tables.h"
+#endif
+
+#define SOUND_FREQUENCY 48000
+#define SOUND_SAMPLES_SIZE  2048
+
+#define BENCH_FRAMES 3000
+#define BENCH_MAX_INSTANCES 64
+
+#define BENCH_REMAP_WIDTH 348   /* H40 line with borders */
+#define BENCH_REMAP_LINES 200000
+#define BENCH_REMAP_LCD   0x80
+
+#define BENCH_PATTERN_LOOPS 2000
+
+#define BENCH_MERGE_WIDTH 320   /* H40 active line */
+#define BENCH_MERGE_LINES 200000
+
+#define BENCH_FM_RUNS     5
+#define BENCH_OPN2_CYCLES (53267 * 24 * 2)  /* 2 seconds of Nuked OPN2 output */
+#define BENCH_YM2612_SAMPLES (53267 * 2)    /* 2 seconds of YM2612 output */
+
+#define BENCH_BLIP_FRAMES 300
+#define BENCH_BLIP_CLOCKS (3420 * 262)  /* NTSC frame M-cycles */
+#define BENCH_BLIP_RATE   48000
+#define BENCH_BLIP_RUNS   5
+
+int log_error   = 0;
+int debug_on    = 0;
+
+/* NTSC filters (only allocated with -ntsc option) */
+md_ntsc_t *md_ntsc;
+sms_ntsc_t *sms_ntsc;
+
+static const uint8 brm_format[0x40] =
+{
+  0x5f,0x5f,0x5f,0x5f,0x5f,0x5f,0x5f,0x5f,0x5f,0x5f,0x5f,0x00,0x00,0x00,0x00,0x40,
+  0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+  0x53,0x45,0x47,0x41,0x5f,0x43,0x44,0x5f,0x52,0x4f,0x4d,0x00,0x01,0x00,0x00,0x00,
+  0x52,0x41,0x4d,0x5f,0x43,0x41,0x52,0x54,0x52,0x49,0x44,0x47,0x45,0x5f,0x5f,0x5f
+};
+
+typedef struct
+{
+  char *filename;     /* game file */
+  int id;             /* instance number */
+  int frames;         /* number of measured frames */
+  int warmup;         /* number of frames run before measurement starts */
+  int do_skip;        /* 1 = skip video rendering */
+  int rewind;         /* rewind buffer size (in MB), 0 = disabled */
+  int runahead;       /* number of frames emulated ahead then rolled back, 0 = disabled */
+  int mute;           /* 1 = disable sound generation, 2 = for rolled back frames only */
+  int threaded;       /* 1 = render Mode 5 lines on a worker thread */
+  int ntsc_threads;   /* number of NTSC filter strips (calling thread + worker threads), 0 = synchronous filter */
+  int fm_thread;      /* 1 = synthesize YM2612 samples on a worker thread */
+  int format;         /* output pixel format (PIXEL_FORMAT_xxx) */
+  uint32 *indexed;    /* XRGB8888 frame rebuilt from indexed output modifications */
+  uint32 indexed_crc; /* checksum of last rebuilt frame */
+  uint32 dirty_lines; /* number of modified lines during measurement */
+  uint32 palette_changes; /* number of palette changes during measurement */
+  int overflows;      /* number of frames with too many palette changes */
+  int dirty;          /* 1 = copy modified lines only (see render_dirty_lines) */
+  uint8 *copy;        /* frame copy updated with modified lines only, like a remote display */
+  uint32 copy_crc;    /* checksum of last frame copy */
+  uint32 copy_lines;  /* number of lines copied during measurement */
+  double t_frame;     /* time spent in system_frame_* */
+  double t_audio;     /* time spent in audio_update */
+  double t_rewind;    /* time spent in rewind_push */
+  int snapshots;      /* number of snapshots in rewind buffer */
+  uint32 rewind_size; /* rewind buffer usage */
+  int rewind_ok;      /* rewind check result (-1 = not checked) */
+  double t_snapshot;  /* time spent in state_snapshot_save & state_snapshot_load */
+  double t_runahead;  /* time spent in emulation of rolled back frames */
+  uint8 *snapshot;    /* run-ahead snapshot buffer */
+  int runahead_check; /* 1 = run measured frames without run-ahead first, then compare outputs */
+  int runahead_ok;    /* run-ahead check result (-1 = not checked) */
+  uint32 plain_audio_crc; /* audio & video checksums of measured frames run without run-ahead */
+  uint32 plain_video_crc;
+  char *record;       /* movie file recorded from power-on, with synthetic input */
+  char *play;         /* movie file replayed from its starting point */
+  uint32 input_seed;  /* synthetic input generator state */
+  int movie_frames;   /* number of replayed movie frames */
+  int movie_length;   /* number of movie frames */
+  int replay_check;   /* 1 = replay recorded movie after measurement and compare outputs */
+  int replay_ok;      /* replay check result (-1 = not checked) */
+  uint32 replay_audio_crc; /* audio & video checksums of measured frames replayed from movie */
+  uint32 replay_video_crc;
+  uint32 audio_crc;   /* checksum of all audio samples output during measurement */
+  uint32 samples;     /* number of audio samples output during measurement */
+  uint32 video_crc;   /* checksum of last rendered frame */
+  int video_w;        /* last rendered frame dimensions */
+  int video_h;
+} t_bench;
+
+/* per-instance frontend state */
+static THREAD_LOCAL short soundframe[SOUND_SAMPLES_SIZE];
+static THREAD_LOCAL t_bench bench;
+
+#ifdef USE_MULTI_INSTANCE
+/* core initialization is not reentrant, neither are reports */
+static pthread_mutex_t bench_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define BENCH_LOCK()   pthread_mutex_lock(&bench_mutex)
+#define BENCH_UNLOCK() pthread_mutex_unlock(&bench_mutex)
+#else
+#define BENCH_LOCK()
+#define BENCH_UNLOCK()
+#endif
+
+/* monotonic wall-clock time, in seconds */
+static double bench_time(void)
+{
+#ifdef _WIN32
+  LARGE_INTEGER freq, now;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&now);
+  return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static const char *bench_system_name(void)
+{
+  switch (system_hw)
+  {
+    case SYSTEM_SG:           return "SG-1000";
+    case SYSTEM_SGII:
+    case SYSTEM_SGII_RAM_EXT: return "SG-1000 II";
+    case SYSTEM_MARKIII:      return "Mark III";
+    case SYSTEM_SMS:
+    case SYSTEM_SMS2:         return "Master System";
+    case SYSTEM_GG:
+    case SYSTEM_GGMS:         return "Game Gear";
+    case SYSTEM_PBC:          return "Mega Drive (PBC)";
+    case SYSTEM_PICO:         return "Pico";
+    case SYSTEM_MCD:          return "Mega CD";
+    default:                  return "Mega Drive";
+  }
+}
+
+static void bench_video_crc(void)
+{
+  int line;
+  int bpp = render_format_bpp(bitmap.format);
+  uint32 crc = crc32(0L, Z_NULL, 0);
+
+  bench.video_w = bitmap.viewport.w + 2 * bitmap.viewport.x;
+  bench.video_h = bitmap.viewport.h + 2 * bitmap.viewport.y;
+
+  if (config.ntsc)
+  {
+    bench.video_w = (reg[12] & 0x01) ? MD_NTSC_OUT_WIDTH(bench.video_w) : SMS_NTSC_OUT_WIDTH(bench.video_w);
+  }
+
+  for (line = 0; line < bench.video_h; line++)
+  {
+    crc = crc32(crc, bitmap.data + (line * bitmap.pitch), bench.video_w * bpp);
+  }
+
+  bench.video_crc = crc;
+
+  if (bench.indexed)
+  {
+    crc = crc32(0L, Z_NULL, 0);
+    for (line = 0; line < bench.video_h; line++)
+    {
+      crc = crc32(crc, (const Bytef *)(bench.indexed + (line * bitmap.width)), bench.video_w * 4);
+    }
+    bench.indexed_crc = crc;
+  }
+
+  if (bench.copy)
+  {
+    crc = crc32(0L, Z_NULL, 0);
+    for (line = 0; line < bench.video_h; line++)
+    {
+      crc = crc32(crc, bench.copy + (line * bitmap.pitch), bench.video_w * bpp);
+    }
+    bench.copy_crc = crc;
+  }
+}
+
+/* only modified lines of displayed frames are copied */
+static void bench_copy_frame(int measure)
+{
+  const t_dirty_lines *frame = render_dirty_lines();
+  int line;
+
+  for (line = 0; (line < bitmap.height) && (line < DIRTY_MAX_LINES); line++)
+  {
+    if (frame->line[line])
+    {
+      memcpy(bench.copy + (line * bitmap.pitch), bitmap.data + (line * bitmap.pitch), bitmap.pitch);
+
+      if (measure)
+      {
+        bench.copy_lines++;
+      }
+    }
+  }
+}
+
+/* indexed output is converted the way a video encoder would do it: only modified lines, with their own colors */
+static void bench_indexed_frame(int measure)
+{
+  const t_indexed_frame *frame = render_indexed_frame();
+  int width = bitmap.viewport.w + 2 * bitmap.viewport.x;
+  int line, i;
+
+  for (line = 0; (line < bitmap.height) && (line < INDEXED_MAX_LINES); line++)
+  {
+    if (frame->dirty[line])
+    {
+      uint32 palette[0x100];
+      const uint8 *src = bitmap.data + (line * bitmap.pitch);
+      uint32 *dst = bench.indexed + (line * bitmap.width);
+
+      memcpy(palette, frame->palette, sizeof(palette));
+      for (i = 0; i < frame->palette_changes[line]; i++)
+      {
+        palette[frame->change[i].index] = frame->change[i].color;
+      }
+
+      for (i = 0; i < width; i++)
+      {
+        dst[i] = palette[src[i]];
+      }
+
+      if (measure)
+      {
+        bench.dirty_lines++;
+      }
+    }
+  }
+
+  if (measure)
+  {
+    bench.palette_changes += frame->changes;
+    bench.overflows += frame->overflow;
+  }
+}
+
+static void bench_frame(int do_skip)
+{
+  if (system_hw == SYSTEM_MCD)
+  {
+    system_frame_scd(do_skip);
+  }
+  else if ((system_hw & SYSTEM_PBC) == SYSTEM_MD)
+  {
+    system_frame_gen(do_skip);
+  }
+  else
+  {
+    system_frame_sms(do_skip);
+  }
+}
+
+/* emulates frames ahead then rolls back to current frame, like frontends reducing input latency */
+static void bench_runahead(void)
+{
+  double t0, t1, t2;
+  int i;
+
+  t0 = bench_time();
+
+  state_snapshot_save(bench.snapshot);
+
+  t1 = bench_time();
+
+  if (bench.mute == 2)
+  {
+    audio_set_mute(1);
+  }
+
+  /* rolled back frames are not displayed and their audio output is discarded */
+  for (i = 0; i < bench.runahead; i++)
+  {
+    bench_frame(1);
+    audio_update(soundframe);
+  }
+
+  if (bench.mute == 2)
+  {
+    audio_set_mute(0);
+  }
+
+  t2 = bench_time();
+
+  state_snapshot_load(bench.snapshot);
+
+  bench.t_snapshot += (t1 - t0) + (bench_time() - t2);
+  bench.t_runahead += (t2 - t1);
+}
+
+/* runs measured frames without run-ahead then rolls back to their start, so that */
+/* run-ahead measurement can be checked against the same frames (see bench_report) */
+static void bench_runahead_plain(void)
+{
+  uint32 seed = bench.input_seed;
+  uint8 *start = malloc(state_size());
+  int i, size;
+
+  bench.runahead_ok = -1;
+  if (!start || !state_snapshot_save(start))
+  {
+    free(start);
+    return;
+  }
+
+  bench.plain_audio_crc = crc32(0L, Z_NULL, 0);
+  for (i = 0; i < bench.frames; i++)
+  {
+    bench_frame(bench.do_skip);
+    size = audio_update(soundframe);
+    bench.plain_audio_crc = crc32(bench.plain_audio_crc, (const Bytef *)soundframe, size * 2 * sizeof(short));
+  }
+  bench_video_crc();
+  bench.plain_video_crc = bench.video_crc;
+
+  /* synthetic input is generated again */
+  bench.runahead_ok = state_snapshot_load(start) ? 0 : -1;
+  bench.input_seed = seed;
+  free(start);
+}
+
+static void bench_run(int measure)
+{
+  double t0, t1, t2;
+  int size;
+
+  t0 = bench_time();
+
+  bench_frame(bench.do_skip);
+
+  t1 = bench_time();
+
+  size = audio_update(soundframe);
+
+  t2 = bench_time();
+
+  if (measure)
+  {
+    if (bench.rewind)
+    {
+      rewind_push();
+      bench.t_rewind += (bench_time() - t2);
+    }
+
+    bench.t_frame += (t1 - t0);
+    bench.t_audio += (t2 - t1);
+    bench.audio_crc = crc32(bench.audio_crc, (const Bytef *)soundframe, size * 2 * sizeof(short));
+    bench.samples += size;
+  }
+
+  if (bench.indexed)
+  {
+    bench_indexed_frame(measure);
+  }
+
+  if (bench.copy)
+  {
+    bench_copy_frame(measure);
+  }
+}
+
+static void bench_report(double elapsed)
+{
+  /* emulated frame rate */
+  double frame_rate = (double)system_clock / (double)(MCYCLES_PER_LINE * lines_per_frame);
+
+  if (bench.id > 0)
+  {
+    printf("instance:     %d\n", bench.id);
+  }
+  printf("rom:          %s\n", bench.filename);
+  printf("system:       %s (%s)\n", bench_system_name(), vdp_pal ? "PAL" : "NTSC");
+  printf("frames:       %d (+%d warm-up)\n", bench.frames, bench.warmup);
+  if (bench.threaded)
+  {
+    printf("rendering:    threaded\n");
+  }
+  if (bench.fm_thread)
+  {
+    printf("fm synthesis: threaded\n");
+  }
+  if (bench.mute)
+  {
+    printf("sound:        muted%s\n", (bench.mute == 2) ? " (run-ahead frames)" : "");
+  }
+  if (bench.format || config.ntsc)
+  {
+    static const char *formats[] = { "native", "rgb565", "xrgb8888", "indexed" };
+    printf("output:       %s%s", formats[bench.format], config.ntsc ? ", NTSC filter" : "");
+    if (config.ntsc && bench.ntsc_threads)
+    {
+      printf(" (%d threads)", bench.ntsc_threads);
+    }
+    printf("\n");
+  }
+  printf("time:         %.3f s\n", elapsed);
+  printf("fps:          %.2f (%.2fx real-time)\n", bench.frames / elapsed, (bench.frames / elapsed) / frame_rate);
+  printf("emulation:    %.3f s (%.1f%%)\n", bench.t_frame, 100.0 * bench.t_frame / elapsed);
+  printf("audio:        %.3f s (%.1f%%)\n", bench.t_audio, 100.0 * bench.t_audio / elapsed);
+  printf("samples:      %u\n", bench.samples);
+  printf("audio crc32:  %08x\n", bench.audio_crc);
+  printf("video crc32:  %08x (%dx%d)\n", bench.video_crc, bench.video_w, bench.video_h);
+  if (bench.indexed)
+  {
+    printf("indexed:      %.1f modified lines, %.1f palette changes per frame (%d overflows)\n",
+           (double)bench.dirty_lines / bench.frames, (double)bench.palette_changes / bench.frames, bench.overflows);
+    printf("rebuilt crc:  %08x (XRGB8888)\n", bench.indexed_crc);
+  }
+  if (bench.copy)
+  {
+    printf("copy:         %.1f modified lines per frame\n", (double)bench.copy_lines / bench.frames);
+    printf("copy crc32:   %08x\n", bench.copy_crc);
+  }
+  printf("patterns:     %.1f modified, %.1f decoded per frame (%.1f%% decodes avoided)\n",
+         (double)pattern_stats.modified / bench.frames, (double)pattern_stats.decoded / bench.frames,
+         pattern_stats.modified ? 100.0 * (1.0 - (double)pattern_stats.decoded / pattern_stats.modified) : 0.0);
+  printf("lines:        %.1f rendered, %.1f unchanged per frame\n",
+         (double)line_stats.rendered / bench.frames, (double)line_stats.cached / bench.frames);
+
+  if (bench.runahead)
+  {
+    printf("run-ahead:    %d frame(s), %.3f s (%.1f%%)\n", bench.runahead, bench.t_runahead, 100.0 * bench.t_runahead / elapsed);
+    printf("snapshots:    %.3f s (%.1f us/frame)\n", bench.t_snapshot, bench.t_snapshot * 1e6 / bench.frames);
+    if (bench.runahead_check)
+    {
+      printf("run-ahead check: %s (audio crc32 %08x, video crc32 %08x without run-ahead)\n",
+             (bench.runahead_ok < 0) ? "skipped" : (bench.runahead_ok ? "ok" : "FAILED"), bench.plain_audio_crc, bench.plain_video_crc);
+    }
+  }
+
+  if (bench.record)
+  {
+    printf("movie:        %d frames recorded to %s\n", bench.movie_length, bench.record);
+    if (bench.replay_check)
+    {
+      printf("replay check: %s (audio crc32 %08x, video crc32 %08x replayed)\n",
+             (bench.replay_ok < 0) ? "skipped" : (bench.replay_ok ? "ok" : "FAILED"), bench.replay_audio_crc, bench.replay_video_crc);
+    }
+  }
+
+  if (bench.play)
+  {
+    printf("movie:        %d/%d frames replayed from %s\n", bench.movie_frames, bench.movie_length, bench.play);
+  }
+
+  if (bench.rewind)
+  {
+    printf("rewind:       %.3f s (%.1f us/frame)\n", bench.t_rewind, bench.t_rewind * 1e6 / bench.frames);
+    printf("snapshots:    %d (%.1f KB used, %.2f KB/delta)\n", bench.snapshots, bench.rewind_size / 1024.0, (bench.snapshots > 1) ? (bench.rewind_size / 1024.0 / (bench.snapshots - 1)) : 0.0);
+    printf("rewind check: %s\n", (bench.rewind_ok < 0) ? "skipped (history too short)" : (bench.rewind_ok ? "ok" : "FAILED"));
+  }
+
+#ifdef USE_PROFILER
+  {
+    /* per-subsystem time split (inclusive, see profiler.h) */
+    const prof_counter_t *total = profiler_get_total();
+    int i;
+
+    printf("\n%-14s %10s %10s %12s %7s\n", "subsystem", "time (s)", "us/frame", "calls", "share");
+    for (i = 0; i < PROF_MAX; i++)
+    {
+      if (total[i].calls && !total[i].time)
+      {
+        /* counted only (time accounted in caller) */
+        printf("%-14s %10s %10s %12u %7s\n", profiler_get_name(i), "-", "-", total[i].calls, "-");
+      }
+      else if (total[i].calls)
+      {
+        double t = (double)total[i].time * 1e-9;
+        printf("%-14s %10.3f %10.1f %12u %6.1f%%\n", profiler_get_name(i), t, t * 1e6 / bench.frames, total[i].calls, 100.0 * t / elapsed);
+      }
+    }
+  }
+#endif
+
+  if (bench.id > 0)
+  {
+    printf("\n");
+  }
+}
+
+static int bench_movie_start(void)
+{
+  FILE *fp;
+  uint8 *data;
+  long size;
+  int result;
+
+  if (bench.record)
+  {
+    return movie_record(0);
+  }
+
+  fp = fopen(bench.play, "rb");
+  if (!fp)
+  {
+    return 0;
+  }
+
+  fseek(fp, 0, SEEK_END);
+  size = ftell(fp);
+  fseek(fp, 0, SEEK_SET);
+
+  data = malloc(size);
+  result = data && (fread(data, 1, size, fp) == (size_t)size) && movie_play(data, size);
+
+  free(data);
+  fclose(fp);
+  return result;
+}
+
+static int bench_movie_save(void)
+{
+  FILE *fp;
+  uint8 *data;
+  int size, result;
+
+  movie_stop();
+  size = movie_data(&data);
+
+  fp = fopen(bench.record, "wb");
+  if (!fp)
+  {
+    return 0;
+  }
+
+  result = (fwrite(data, 1, size, fp) == (size_t)size);
+  fclose(fp);
+  return result;
+}
+
+/* replays recorded movie from power-on, with the same run-ahead setup as during recording: */
+/* all frames must be replayed once and measured frames output must be the same           */
+static int bench_movie_replay(void)
+{
+  uint8 *data, *copy;
+  uint32 video_crc = bench.video_crc;
+  double t_snapshot = bench.t_snapshot;
+  double t_runahead = bench.t_runahead;
+  int i, size;
+
+  /* movie buffer is reloaded by movie_play */
+  size = movie_data(&data);
+  copy = malloc(size);
+  if (!copy)
+  {
+    return -1;
+  }
+  memcpy(copy, data, size);
+
+  if (!movie_play(copy, size))
+  {
+    free(copy);
+    return 0;
+  }
+  free(copy);
+
+  for (i = 0; i < (bench.warmup + bench.frames); i++)
+  {
+    if (i == bench.warmup)
+    {
+      bench.replay_audio_crc = crc32(0L, Z_NULL, 0);
+    }
+
+    if (bench.runahead && (i >= bench.warmup))
+    {
+      bench_runahead();
+    }
+
+    bench_frame(bench.do_skip);
+    size = audio_update(soundframe);
+
+    if (i >= bench.warmup)
+    {
+      bench.replay_audio_crc = crc32(bench.replay_audio_crc, (const Bytef *)soundframe, size * 2 * sizeof(short));
+    }
+  }
+
+  bench_video_crc();
+  bench.replay_video_crc = bench.video_crc;
+  bench.video_crc = video_crc;
+  bench.t_snapshot = t_snapshot;
+  bench.t_runahead = t_runahead;
+
+  return (movie_status() == MOVIE_IDLE) && (movie_frame() == movie_length()) && (movie_length() == (bench.warmup + bench.frames)) &&
+         (bench.replay_audio_crc == bench.audio_crc) && (bench.replay_video_crc == bench.video_crc);
+}
+
+/* rewinds to the middle of measured frames and compares with the state saved at that point */
+static int bench_rewind_check(const uint8 *ref, int ref_size)
+{
+  int i, size, result;
+  int pops = bench.frames - (bench.frames / 2) + 1;
+  uint8 *state;
+
+  if (rewind_count() < pops)
+  {
+    return -1;
+  }
+
+  for (i = 0; i < pops; i++)
+  {
+    if (!rewind_pop())
+    {
+      return 0;
+    }
+  }
+
+  state = malloc(state_size());
+  if (!state)
+  {
+    return 0;
+  }
+
+  size = state_save(state);
+  result = (size == ref_size) && !memcmp(state, ref, size);
+  free(state);
+  return result;
+}
+
+/* runs one emulator instance from game loading to report, returns 0 on success */
+static int bench_instance(void)
+{
+  FILE *fp;
+  int i;
+  double start, elapsed;
+  uint8 *ref = NULL;
+  int ref_size = 0;
+
+  BENCH_LOCK();
+
+  /* mark all BIOS as unloaded */
+  system_bios = 0;
+
+  /* Genesis BOOT ROM support (2KB max) */
+  memset(boot_rom, 0xFF, 0x800);
+  fp = fopen(MD_BIOS, "rb");
+  if (fp != NULL)
+  {
+    /* read BOOT ROM */
+    fread(boot_rom, 1, 0x800, fp);
+    fclose(fp);
+
+    /* check BOOT ROM */
+    if (!memcmp((char *)(boot_rom + 0x120),"GENESIS OS", 10))
+    {
+      /* mark Genesis BIOS as loaded */
+      system_bios = SYSTEM_MD;
+    }
+
+    /* Byteswap ROM */
+    for (i=0; i<0x800; i+=2)
+    {
+      uint8 temp = boot_rom[i];
+      boot_rom[i] = boot_rom[i+1];
+      boot_rom[i+1] = temp;
+    }
+  }
+
+  /* initialize Genesis virtual system */
+  memset(&bitmap, 0, sizeof(t_bitmap));
+  bitmap.width        = 720;
+  bitmap.height       = 576;
+  bitmap.format       = bench.format;
+  bitmap.pitch        = (bitmap.width * render_format_bpp(bitmap.format));
+  bitmap.data         = calloc(bitmap.height, bitmap.pitch);
+  bitmap.viewport.changed = 3;
+
+  /* indexed output consumer */
+  if (bitmap.format == PIXEL_FORMAT_INDEXED)
+  {
+    bench.indexed = calloc(bitmap.height, bitmap.width * 4);
+  }
+
+  /* modified lines consumer */
+  if (bench.dirty)
+  {
+    bench.copy = calloc(bitmap.height, bitmap.pitch);
+  }
+
+  /* Load game file */
+  if (!bitmap.data || ((bitmap.format == PIXEL_FORMAT_INDEXED) && !bench.indexed) || (bench.dirty && !bench.copy) || !load_rom(bench.filename))
+  {
+    BENCH_UNLOCK();
+    fprintf(stderr, "Error loading file `%s'.\n", bench.filename);
+    free(bench.indexed);
+    free(bench.copy);
+    free(bitmap.data);
+    return 1;
+  }
+
+  /* initialize system hardware */
+  audio_init(SOUND_FREQUENCY, 0);
+  system_init();
+
+#ifdef USE_RENDER_THREAD
+  if (bench.threaded && !render_thread_start())
+  {
+    fprintf(stderr, "Error creating render thread.\n");
+    bench.threaded = 0;
+  }
+#endif
+
+#ifdef USE_NTSC_THREADS
+  if (bench.ntsc_threads)
+  {
+    bench.ntsc_threads = ntsc_threads_start(bench.ntsc_threads);
+    if (!bench.ntsc_threads)
+    {
+      fprintf(stderr, "Error creating NTSC filter threads.\n");
+    }
+  }
+#endif
+
+#ifdef USE_FM_THREAD
+  if (bench.fm_thread && !fm_thread_start())
+  {
+    fprintf(stderr, "Error creating FM thread.\n");
+    bench.fm_thread = 0;
+  }
+#endif
+
+  if (bench.mute == 1)
+  {
+    audio_set_mute(1);
+  }
+
+  BENCH_UNLOCK();
+
+  /* Mega CD specific */
+  if (system_hw == SYSTEM_MCD)
+  {
+    uint8 format[0x40];
+
+    /* start with a freshly formatted internal backup RAM so that runs are reproducible */
+    memcpy(format, brm_format, 0x40);
+    format[0x10] = format[0x12] = format[0x14] = format[0x16] = 0x00;
+    format[0x11] = format[0x13] = format[0x15] = format[0x17] = (sizeof(scd.bram) / 64) - 3;
+    memset(scd.bram, 0x00, 0x200);
+    memcpy(scd.bram + 0x2000 - 0x40, format, 0x40);
+  }
+
+  /* reset system hardware */
+  system_reset();
+
+  /* movies start from power-on */
+  if ((bench.record || bench.play) && !bench_movie_start())
+  {
+    fprintf(stderr, "Error %s movie `%s'.\n", bench.record ? "recording" : "loading", bench.record ? bench.record : bench.play);
+    bench.record = bench.play = NULL;
+  }
+
+  /* warm-up frames are not measured */
+  for (i = 0; i < bench.warmup; i++)
+  {
+    bench_run(0);
+  }
+
+  if (bench.runahead_check)
+  {
+    bench_runahead_plain();
+  }
+
+  bench.audio_crc = crc32(0L, Z_NULL, 0);
+  memset(&pattern_stats, 0, sizeof(pattern_stats));
+  memset(&line_stats, 0, sizeof(line_stats));
+
+#ifdef USE_PROFILER
+  profiler_reset();
+#endif
+
+  if (bench.rewind)
+  {
+    ref = malloc(state_size());
+    if (!ref || !rewind_init(bench.rewind << 20))
+    {
+      fprintf(stderr, "Error allocating rewind buffer.\n");
+      bench.rewind = 0;
+    }
+  }
+
+  if (bench.runahead)
+  {
+    bench.snapshot = malloc(state_size());
+    if (!bench.snapshot)
+    {
+      fprintf(stderr, "Error allocating snapshot buffer.\n");
+      bench.runahead = 0;
+    }
+  }
+
+  /* measured frames */
+  start = bench_time();
+  for (i = 0; i < bench.frames; i++)
+  {
+    if (bench.runahead)
+    {
+      bench_runahead();
+    }
+
+    bench_run(1);
+
+    /* reference state for rewind check */
+    if (bench.rewind && (i == (bench.frames / 2) - 1))
+    {
+      ref_size = state_save(ref);
+    }
+  }
+  elapsed = bench_time() - start;
+
+  bench_video_crc();
+
+  if (bench.runahead_ok == 0)
+  {
+    bench.runahead_ok = (bench.audio_crc == bench.plain_audio_crc) && (bench.video_crc == bench.plain_video_crc);
+  }
+
+  if (bench.play)
+  {
+    bench.movie_frames = movie_frame();
+    bench.movie_length = movie_length();
+  }
+
+  if (bench.record)
+  {
+    bench.movie_length = movie_length();
+    if (!bench_movie_save())
+    {
+      fprintf(stderr, "Error writing movie `%s'.\n", bench.record);
+      bench.record = NULL;
+    }
+    else if (bench.replay_check)
+    {
+      bench.replay_ok = bench_movie_replay();
+    }
+  }
+
+  if (bench.rewind)
+  {
+    bench.snapshots = rewind_count();
+    bench.rewind_size = rewind_usage();
+    bench.rewind_ok = ref_size ? bench_rewind_check(ref, ref_size) : -1;
+  }
+
+  BENCH_LOCK();
+  bench_report(elapsed);
+  BENCH_UNLOCK();
+
+#ifdef USE_FM_THREAD
+  fm_thread_stop();
+#endif
+#ifdef USE_NTSC_THREADS
+  ntsc_threads_stop();
+#endif
+#ifdef USE_RENDER_THREAD
+  render_thread_stop();
+#endif
+  rewind_shutdown();
+  movie_shutdown();
+  free(ref);
+  free(bench.snapshot);
+  bench.snapshot = NULL;
+  free(bench.indexed);
+  bench.indexed = NULL;
+  free(bench.copy);
+  bench.copy = NULL;
+  audio_shutdown();
+  free(bitmap.data);
+  bitmap.data = NULL;
+
+#ifdef USE_DYNAMIC_ALLOC
+  free(ext);
+  ext = NULL;
+#endif
+
+  /* failed run-ahead & replay checks are reported in exit status */
+  return (bench.runahead_ok == 0) || (bench.replay_ok == 0);
+}
+
+#ifdef USE_MULTI_INSTANCE
+static void *bench_thread(void *arg)
+{
+  /* each thread owns an independent emulator instance */
+  bench = *(t_bench *)arg;
+
+  /* input configuration is per-instance (see set_config_defaults) */
+  input.system[0] = SYSTEM_GAMEPAD;
+  input.system[1] = SYSTEM_GAMEPAD;
+  return (void *)(size_t)bench_instance();
+}
+#endif
+
+int sdl_input_update(void)
+{
+  /* no input device attached: when recording a movie, pseudo-random gamepad */
+  /* inputs, held for 8 frames, are generated so that input paths are exercised */
+  if (bench.record && !(movie_frame() & 7))
+  {
+    bench.input_seed = bench.input_seed * 1103515245 + 12345;
+    input.pad[0] = (bench.input_seed >> 16) & 0x0fff;
+    input.pad[4] = (bench.input_seed >> 4) & 0x0fff;
+  }
+
+  return 1;
+}
+
+/* pixel color remapping kernels microbenchmark (see vdp_remap.h) */
+static int bench_remap(void)
+{
+  static PIXEL_OUT_T pal[0x100];
+  static PIXEL_OUT_T ref[BENCH_REMAP_WIDTH], ref_lcd[BENCH_REMAP_WIDTH], old[BENCH_REMAP_WIDTH], out[BENCH_REMAP_WIDTH];
+  static uint8 src[BENCH_REMAP_WIDTH];
+  const t_remap_kernels *scalar;
+  const t_remap_kernels *k;
+  uint32 seed = 1;
+  int i, n, result = 0;
+
+  remap_init();
+  scalar = remap_get(0);
+
+  /* random palette, pixels and previous output line */
+  for (i = 0; i < 0x100; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    pal[i] = (PIXEL_OUT_T)((seed >> 8) | (seed << 24));
+  }
+  for (i = 0; i < BENCH_REMAP_WIDTH; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    src[i] = seed >> 24;
+    old[i] = pal[(seed >> 16) & 0xff];
+  }
+
+  /* reference output */
+  scalar->remap(ref, src, pal, BENCH_REMAP_WIDTH);
+  memcpy(ref_lcd, old, sizeof(old));
+  scalar->remap_lcd(ref_lcd, src, pal, BENCH_REMAP_WIDTH, BENCH_REMAP_LCD);
+
+  printf("remap kernels: %d-pixel line, %d-bit pixels\n", BENCH_REMAP_WIDTH, (int)sizeof(PIXEL_OUT_T) * 8);
+
+  for (i = 0; (k = remap_get(i)) != NULL; i++)
+  {
+    double t0, t1, t2, t3;
+    int ok;
+
+    remap_select(k->name);
+
+    /* check output matches scalar implementation */
+    k->remap(out, src, pal, BENCH_REMAP_WIDTH);
+    ok = !memcmp(out, ref, sizeof(out));
+    memcpy(out, old, sizeof(old));
+    k->remap_lcd(out, src, pal, BENCH_REMAP_WIDTH, BENCH_REMAP_LCD);
+    ok &= !memcmp(out, ref_lcd, sizeof(out));
+
+    t0 = bench_time();
+    for (n = 0; n < BENCH_REMAP_LINES; n++)
+    {
+      k->remap(out, src, pal, BENCH_REMAP_WIDTH);
+    }
+    t1 = bench_time();
+    for (n = 0; n < BENCH_REMAP_LINES; n++)
+    {
+      k->remap_lcd(out, src, pal, BENCH_REMAP_WIDTH, BENCH_REMAP_LCD);
+    }
+    t2 = bench_time();
+    for (n = 0; n < BENCH_REMAP_LINES; n++)
+    {
+      k->fill(out, pal[n & 0xff], BENCH_REMAP_WIDTH);
+    }
+    t3 = bench_time();
+
+    printf("  %-8s remap %7.1f ns  lcd %7.1f ns  fill %7.1f ns  %s\n", k->name,
+           (t1 - t0) * 1e9 / BENCH_REMAP_LINES, (t2 - t1) * 1e9 / BENCH_REMAP_LINES, (t3 - t2) * 1e9 / BENCH_REMAP_LINES,
+           ok ? "ok" : "MISMATCH");
+
+    if (!ok) result = 1;
+  }
+
+  remap_init();
+  return result;
+}
+
+/* Mode 5 layers merging kernels microbenchmark (see vdp_merge.h) */
+static int bench_merge(void)
+{
+  static uint8 srca[0x10000], srcb[0x10000], ref[0x10000], out[0x10000];
+  static uint8 lb[BENCH_MERGE_WIDTH];
+  const uint8 *lut_bg, *lut_obj;
+  const t_merge_kernels *scalar;
+  const t_merge_kernels *k;
+  uint32 seed = 1;
+  int i, j, n, result = 0;
+
+  render_init();
+  lut_bg = render_lut(0);
+  lut_obj = render_lut(1);
+  scalar = merge_get(0);
+
+  /* all background layers pixel pairs */
+  for (i = 0; i < 0x10000; i++)
+  {
+    srca[i] = i & 0xff;
+    srcb[i] = i >> 8;
+  }
+  scalar->bg(srca, srcb, ref, lut_bg, 0x10000);
+
+  printf("merge kernels: %d-pixel line\n", BENCH_MERGE_WIDTH);
+
+  for (i = 0; (k = merge_get(i)) != NULL; i++)
+  {
+    double t0, t1, t2;
+    int ok, atex;
+
+    /* check background layers output matches look-up table (odd width to include remaining pixels) */
+    memset(out, 0, sizeof(out));
+    k->bg(srca, srcb, out, lut_bg, 0x10000 - 7);
+    ok = !memcmp(out, ref, 0x10000 - 7) && !out[0x10000 - 7];
+
+    /* check sprite layer output and collision flag, for all sprite pixels, line buffer pixels & palettes */
+    for (atex = 0; atex < 0x80; atex += 0x10)
+    {
+      for (j = 0; j < 0x1000; j += 8)
+      {
+        uint8 src[8], lb_ref[8], lb_out[8];
+        int status_ref, status_out;
+
+        for (n = 0; n < 8; n++)
+        {
+          src[n] = (j + n) & 0x0f;
+          lb_ref[n] = lb_out[n] = (j + n) >> 4;
+        }
+        status_ref = scalar->obj(lb_ref, src, atex, lut_obj);
+        status_out = k->obj(lb_out, src, atex, lut_obj);
+        ok &= !memcmp(lb_out, lb_ref, 8) && (status_out == status_ref);
+      }
+    }
+
+    /* random line buffers */
+    for (j = 0; j < BENCH_MERGE_WIDTH; j++)
+    {
+      seed = seed * 1103515245 + 12345;
+      srca[j] = seed >> 24;
+      srcb[j] = seed >> 16;
+      lb[j] = (seed >> 8) & 0x7f;
+    }
+
+    t0 = bench_time();
+    for (n = 0; n < BENCH_MERGE_LINES; n++)
+    {
+      k->bg(srca, srcb, out, lut_bg, BENCH_MERGE_WIDTH);
+    }
+    t1 = bench_time();
+    for (n = 0; n < BENCH_MERGE_LINES; n++)
+    {
+      /* same sprite pattern line drawn over the whole line */
+      for (j = 0; j < BENCH_MERGE_WIDTH; j += 8)
+      {
+        k->obj(&lb[j], &srcb[j], 0x20, lut_obj);
+      }
+    }
+    t2 = bench_time();
+
+    printf("  %-8s bg %7.1f ns  obj %7.1f ns  %s\n", k->name,
+           (t1 - t0) * 1e9 / BENCH_MERGE_LINES, (t2 - t1) * 1e9 / BENCH_MERGE_LINES,
+           ok ? "ok" : "MISMATCH");
+
+    /* restore all pixel pairs */
+    for (j = 0; j < BENCH_MERGE_WIDTH; j++)
+    {
+      srca[j] = j & 0xff;
+      srcb[j] = j >> 8;
+    }
+
+    if (!ok) result = 1;
+  }
+
+  merge_init();
+  return result;
+}
+
+/* pattern cache update microbenchmark (whole VRAM rewritten, as with DMA-heavy games) */
+static int bench_patterns(void)
+{
+  uint32 seed = 1;
+  double start, elapsed;
+  int i, n;
+
+  for (i = 0; i < 0x10000; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    vram[i] = seed >> 24;
+  }
+
+  start = bench_time();
+  for (n = 0; n < BENCH_PATTERN_LOOPS; n++)
+  {
+    for (i = 0; i < 0x800; i++)
+    {
+      bg_name_list[i] = i;
+      bg_name_dirty[i] = 0xFF;
+    }
+    update_bg_pattern_cache_m5(0x800);
+  }
+  elapsed = bench_time() - start;
+
+#ifdef USE_COMPACT_PATTERN_CACHE
+  printf("pattern cache: compact (128 KB, flipped when rendered)\n");
+#else
+  printf("pattern cache: pre-flipped (512 KB)\n");
+#endif
+  printf("  2048 patterns update: %.1f us\n", elapsed * 1e6 / BENCH_PATTERN_LOOPS);
+  return 0;
+}
+
+#if defined(HAVE_YM3438_CORE) || defined(USE_YM2612_SIMD)
+static unsigned int bench_fm_writes[32];
+static int bench_fm_count;
+
+/* queue YM2612 register write (0x000-0x1ff), written to the chip by bench_opn2_run or bench_ym2612_run */
+static void bench_fm_write(unsigned int r, unsigned int v)
+{
+  bench_fm_writes[bench_fm_count++] = (r << 8) | v;
+}
+
+/* a few random register writes, like a sound driver between updates */
+static uint32 bench_fm_registers(uint32 seed)
+{
+  int n = 1 + ((seed >> 16) & 7);
+  while (n--)
+  {
+    unsigned int r, v, port;
+
+    seed = seed * 1103515245 + 12345;
+    v = (seed >> 8) & 0xff;
+    port = (seed >> 7) & 0x100;
+
+    switch ((seed >> 24) % 12)
+    {
+      case 0: case 1: case 2: /* operators parameters (incl. SSG-EG) */
+        r = 0x30 + ((seed >> 16) % 0x70);
+        if ((r & 3) == 3) r--;
+        if ((r & 0xf0) == 0x40) v &= 0x3f; /* mostly audible TL */
+        if (((r & 0xf0) == 0x90) && (v & 0x70)) v &= 0x07; /* occasional SSG-EG */
+        bench_fm_write(port | r, v);
+        break;
+      case 3: /* frequency (incl. CH3 special mode frequencies) */
+        r = ((seed >> 16) & 8) + ((seed >> 20) % 3);
+        bench_fm_write(port | (0xa4 + r), (v & 0x3f) | 0x08);
+        bench_fm_write(port | (0xa0 + r), v);
+        break;
+      case 4: /* feedback & algorithm */
+        bench_fm_write(port | (0xb0 + ((seed >> 16) % 3)), v & 0x3f);
+        break;
+      case 5: /* panning, AMS & PMS */
+        bench_fm_write(port | (0xb4 + ((seed >> 16) % 3)), v | (((seed >> 20) & 1) ? 0xc0 : 0x40));
+        break;
+      case 6: /* LFO */
+        bench_fm_write(0x22, v & 0x0f);
+        break;
+      case 7: /* CH3 special & CSM modes, timer A */
+        bench_fm_write(0x24, v);
+        bench_fm_write(0x25, 0);
+        bench_fm_write(0x27, ((v & 7) == 0) ? 0x95 : ((v & 0x40) | 0x30));
+        break;
+      case 8: case 9: case 10: /* key on/off */
+        bench_fm_write(0x28, (v & 0xf7) | ((v & 0x04) ? 0 : (v & 0x03) % 3));
+        break;
+      default: /* DAC */
+        bench_fm_write(0x2b, ((v & 0x1f) == 0) ? 0x80 : 0x00);
+        bench_fm_write(0x2a, v);
+        break;
+    }
+  }
+
+  return seed;
+}
+#endif
+
+#ifdef HAVE_YM3438_CORE
+static ym3438_t bench_opn2;
+
+/* run Nuked OPN2 chip for a number of cycles, one by one or batched */
+static double bench_opn2_clock(Bit16s *buffer, int cycles, int batch)
+{
+  double start = bench_time();
+
+  if (batch)
+  {
+    OPN2_ClockBatch(&bench_opn2, buffer, cycles);
+  }
+  else
+  {
+    while (cycles--)
+    {
+      OPN2_Clock(&bench_opn2, buffer);
+      buffer += 2;
+    }
+  }
+
+  return bench_time() - start;
+}
+
+/* run Nuked OPN2 with random register writes, returns elapsed time */
+static double bench_opn2_run(Bit16s *buffer, int batch)
+{
+  uint32 seed = 1;
+  double elapsed = 0.0;
+  int i, n, count = 0;
+
+  OPN2_SetChipType(ym3438_mode_ym2612);
+  OPN2_Reset(&bench_opn2);
+
+  while (count < BENCH_OPN2_CYCLES)
+  {
+    bench_fm_count = 0;
+    seed = bench_fm_registers(seed);
+
+    /* address & data writes are latched on next cycle, then wait for busy flag */
+    for (i = 0; (i < bench_fm_count) && (count < BENCH_OPN2_CYCLES - 48); i++)
+    {
+      unsigned int w = bench_fm_writes[i];
+      OPN2_Write(&bench_opn2, (w >> 15) & 2, (w >> 8) & 0xff);
+      elapsed += bench_opn2_clock(&buffer[count * 2], 2, batch);
+      OPN2_Write(&bench_opn2, ((w >> 15) & 2) | 1, w & 0xff);
+      elapsed += bench_opn2_clock(&buffer[count * 2 + 4], 46, batch);
+      count += 48;
+    }
+
+    /* run chip */
+    seed = seed * 1103515245 + 12345;
+    n = 1 + ((seed >> 16) % (96 * 24));
+    if (n > (BENCH_OPN2_CYCLES - count))
+    {
+      n = BENCH_OPN2_CYCLES - count;
+    }
+    elapsed += bench_opn2_clock(&buffer[count * 2], n, batch);
+    count += n;
+  }
+
+  return elapsed;
+}
+
+/* Nuked OPN2 batched clocking microbenchmark (see OPN2_ClockBatch) */
+static int bench_opn2_batch(void)
+{
+  static Bit16s ref[BENCH_OPN2_CYCLES * 2], out[BENCH_OPN2_CYCLES * 2];
+  static ym3438_t chip;
+  double t, t_cycle, t_batch;
+  int i, ok;
+
+  t_cycle = bench_opn2_run(ref, 0);
+  chip = bench_opn2;
+  t_batch = bench_opn2_run(out, 1);
+  ok = !memcmp(out, ref, sizeof(ref)) && !memcmp(&chip, &bench_opn2, sizeof(chip));
+
+  /* best of BENCH_FM_RUNS alternated runs */
+  for (i = 1; i < BENCH_FM_RUNS; i++)
+  {
+    t = bench_opn2_run(out, 0);
+    if (t < t_cycle) t_cycle = t;
+    t = bench_opn2_run(out, 1);
+    if (t < t_batch) t_batch = t;
+  }
+
+  printf("nuked opn2 clocking: %d cycles, random register writes\n", BENCH_OPN2_CYCLES);
+  printf("  per-cycle %6.1f ns/cycle\n", t_cycle * 1e9 / BENCH_OPN2_CYCLES);
+  printf("  batched   %6.1f ns/cycle  %s\n", t_batch * 1e9 / BENCH_OPN2_CYCLES, ok ? "ok" : "MISMATCH");
+
+  return !ok;
+}
+#endif
+
+#ifdef USE_YM2612_SIMD
+/* run YM2612 with random register writes, operators evaluated per channel or all at once, returns elapsed time */
+static double bench_ym2612_run(int *buffer, int soa)
+{
+  uint32 seed = 1;
+  double start, elapsed = 0.0;
+  int i, n, count = 0;
+
+  YM2612SelectOperators(soa);
+  YM2612Init();
+  YM2612Config(YM2612_DISCRETE);
+  YM2612ResetChip();
+
+  while (count < BENCH_YM2612_SAMPLES)
+  {
+    bench_fm_count = 0;
+    seed = bench_fm_registers(seed);
+
+    for (i = 0; i < bench_fm_count; i++)
+    {
+      unsigned int w = bench_fm_writes[i];
+      YM2612Write((w >> 15) & 2, (w >> 8) & 0xff);
+      YM2612Write(((w >> 15) & 2) | 1, w & 0xff);
+    }
+
+    /* run chip */
+    seed = seed * 1103515245 + 12345;
+    n = 1 + ((seed >> 16) % 96);
+    if (n > (BENCH_YM2612_SAMPLES - count))
+    {
+      n = BENCH_YM2612_SAMPLES - count;
+    }
+    start = bench_time();
+    YM2612Update(&buffer[count * 2], n);
+    elapsed += bench_time() - start;
+    count += n;
+  }
+
+  return elapsed;
+}
+
+/* YM2612 structure-of-arrays operators microbenchmark (see YM2612SelectOperators) */
+static int bench_ym2612(void)
+{
+  static int ref[BENCH_YM2612_SAMPLES * 2], out[BENCH_YM2612_SAMPLES * 2];
+  unsigned char *ref_state = malloc(YM2612GetContextSize());
+  unsigned char *state = malloc(YM2612GetContextSize());
+  double t, t_chan, t_soa;
+  int i, ok;
+
+  if (!ref_state || !state)
+  {
+    free(ref_state);
+    free(state);
+    return 1;
+  }
+
+  t_chan = bench_ym2612_run(ref, 0);
+  YM2612SaveContext(ref_state);
+  t_soa = bench_ym2612_run(out, 1);
+  YM2612SaveContext(state);
+  ok = !memcmp(out, ref, sizeof(ref)) && !memcmp(state, ref_state, YM2612GetContextSize());
+  free(ref_state);
+  free(state);
+
+  /* best of BENCH_FM_RUNS alternated runs */
+  for (i = 1; i < BENCH_FM_RUNS; i++)
+  {
+    t = bench_ym2612_run(out, 0);
+    if (t < t_chan) t_chan = t;
+    t = bench_ym2612_run(out, 1);
+    if (t < t_soa) t_soa = t;
+  }
+
+  printf("ym2612 operators: %d samples, random register writes\n", BENCH_YM2612_SAMPLES);
+  printf("  per-channel     %6.1f ns/sample\n", t_chan * 1e9 / BENCH_YM2612_SAMPLES);
+  printf("  all channels    %6.1f ns/sample  %s\n", t_soa * 1e9 / BENCH_YM2612_SAMPLES, ok ? "ok" : "MISMATCH");
+
+  return !ok;
+}
+#endif
+
+/* recorded blip buffer deltas */
+typedef struct
+{
+  uint32 time;
+  int l, r;
+} t_bench_delta;
+
+static t_bench_delta *bench_deltas;
+static int bench_deltas_frame[BENCH_BLIP_FRAMES + 1];  /* first delta of each frame */
+
+static void bench_delta(int *count, uint32 time, int l, int r)
+{
+  bench_deltas[*count].time = time;
+  bench_deltas[*count].l = l;
+  bench_deltas[*count].r = r;
+  (*count)++;
+}
+
+/* record PSG-heavy music deltas, in the order they are added by psg_update & sound_update */
+static int bench_blip_record(void)
+{
+  int polarity[4] = {1, 1, 1, 1};
+  uint32 counter[4] = {0, 0, 0, 0};
+  uint32 seed = 1;
+  uint32 t;
+  int fm_l = 0, fm_r = 0;
+  int f, i, count = 0;
+
+  /* up to 3733 transitions per frame & channel, one FM sample every 1008 M-cycles */
+  bench_deltas = malloc(BENCH_BLIP_FRAMES * (4 * (BENCH_BLIP_CLOCKS / 240 + 1) + BENCH_BLIP_CLOCKS / 1008 + 1) * sizeof(t_bench_delta));
+  if (!bench_deltas)
+  {
+    return 0;
+  }
+
+  for (f = 0; f < BENCH_BLIP_FRAMES; f++)
+  {
+    bench_deltas_frame[f] = count;
+
+    /* 3 tone channels & noise channel (panned), with new high-pitched period & volume each frame */
+    for (i = 0; i < 4; i++)
+    {
+      int period, volume;
+      seed = seed * 1103515245 + 12345;
+      period = (1 + ((seed >> 16) & 3)) * 240;
+      volume = (seed >> 4) & 0x7ff;
+      for (t = counter[i]; t < BENCH_BLIP_CLOCKS; t += period)
+      {
+        polarity[i] = -polarity[i];
+        bench_delta(&count, t, polarity[i] * volume, polarity[i] * ((i == 3) ? (volume >> 1) : volume));
+      }
+      counter[i] = t - BENCH_BLIP_CLOCKS;
+    }
+
+    /* FM output random walk, with a few out-of-range steps */
+    for (t = 0; t < BENCH_BLIP_CLOCKS; t += 1008)
+    {
+      int l, r;
+      seed = seed * 1103515245 + 12345;
+      l = (int)((seed >> 16) & 0x1ff) - 0x100;
+      r = ((seed >> 8) & 1) ? l : ((int)((seed >> 4) & 0x1ff) - 0x100);
+      if ((seed & 0x3ff) == 0)
+      {
+        l = (fm_l > 0) ? -40000 : 40000;
+      }
+      fm_l += l;
+      fm_r += r;
+      bench_delta(&count, t, l, r);
+    }
+  }
+
+  bench_deltas_frame[f] = count;
+  return count;
+}
+
+/* replay recorded deltas into a blip buffer, read (or mixed with 2 extra streams) at end of frame */
+static void bench_blip_run(blip_t **blips, int mix, short *out, double *t_add, double *t_out)
+{
+  uint32 seed = 1;
+  int f, i, n, size, level = 0;
+  double t0, t1, t2;
+
+  for (i = 0; i < 3; i++)
+  {
+    blip_clear(blips[i]);
+  }
+
+  for (f = 0; f < BENCH_BLIP_FRAMES; f++)
+  {
+    t0 = bench_time();
+    for (i = bench_deltas_frame[f]; i < bench_deltas_frame[f + 1]; i++)
+    {
+      blip_add_delta(blips[0], bench_deltas[i].time, bench_deltas[i].l, bench_deltas[i].r);
+    }
+    t1 = bench_time();
+
+    blip_end_frame(blips[0], BENCH_BLIP_CLOCKS);
+    size = blip_samples_avail(blips[0]);
+
+    if (mix)
+    {
+      /* PCM & CD-DA like streams (see audio_update) */
+      for (i = 1; i < 3; i++)
+      {
+        int clocks = blip_clocks_needed(blips[i], size);
+        for (n = 0; n < clocks; n++)
+        {
+          seed = seed * 1103515245 + 12345;
+          blip_add_delta_fast(blips[i], n, ((seed >> 16) & 0xff) - level, ((seed >> 8) & 0xff) - level);
+        }
+        level = 0x80;
+        blip_end_frame(blips[i], clocks);
+      }
+      t2 = bench_time();
+      blip_mix_samples(blips[0], &blips[1], 2, out, size);
+    }
+    else
+    {
+      t2 = bench_time();
+      blip_read_samples(blips[0], out, size);
+    }
+
+    *t_add += t1 - t0;
+    *t_out += bench_time() - t2;
+    out += size * 2;
+  }
+}
+
+/* blip buffer kernels microbenchmark (see blip_kernels) */
+static int bench_blip(void)
+{
+  static short ref[2][BENCH_BLIP_FRAMES * 1024 * 2], out[2][BENCH_BLIP_FRAMES * 1024 * 2];
+  blip_t *blips[3];
+  const char *name;
+  int i, k, r, count, result = 0;
+
+  count = bench_blip_record();
+  if (!count)
+  {
+    fprintf(stderr, "Error allocating delta buffer.\n");
+    return 1;
+  }
+
+  for (i = 0; i < 3; i++)
+  {
+    blips[i] = blip_new(BENCH_BLIP_RATE / 10);
+  }
+  blip_set_rates(blips[0], (double)BENCH_BLIP_CLOCKS * 60, BENCH_BLIP_RATE);
+  blip_set_rates(blips[1], 32552, BENCH_BLIP_RATE);
+  blip_set_rates(blips[2], 44100, BENCH_BLIP_RATE);
+
+  printf("blip kernels: %d frames, %.1f deltas per frame\n", BENCH_BLIP_FRAMES, (double)count / BENCH_BLIP_FRAMES);
+
+  for (k = 0; (name = blip_kernels(k)) != NULL; k++)
+  {
+    double t_add = 1e9, t_read = 1e9, t_mix = 1e9;
+    int ok = 1;
+
+    blip_select_kernels(name);
+
+    /* best of BENCH_BLIP_RUNS runs */
+    for (r = 0; r < BENCH_BLIP_RUNS; r++)
+    {
+      double add[2] = {0.0, 0.0}, t_out[2] = {0.0, 0.0};
+
+      for (i = 0; i < 2; i++)
+      {
+        bench_blip_run(blips, i, out[i], &add[i], &t_out[i]);
+
+        /* check output matches scalar implementation */
+        if (k == 0)
+        {
+          memcpy(ref[i], out[i], sizeof(ref[i]));
+        }
+        else
+        {
+          ok &= !memcmp(out[i], ref[i], sizeof(ref[i]));
+        }
+      }
+
+      if (add[0] < t_add) t_add = add[0];
+      if (t_out[0] < t_read) t_read = t_out[0];
+      if (t_out[1] < t_mix) t_mix = t_out[1];
+    }
+
+    printf("  %-8s add %6.2f ns/delta  read %6.2f ns/sample  mix %6.2f ns/sample  %s\n", name,
+           t_add * 1e9 / count, t_read * 1e9 / (BENCH_BLIP_FRAMES * (BENCH_BLIP_RATE / 60)),
+           t_mix * 1e9 / (BENCH_BLIP_FRAMES * (BENCH_BLIP_RATE / 60)), ok ? "ok" : "MISMATCH");
+
+    if (!ok) result = 1;
+  }
+
+  /* fastest kernels remain selected */
+  blip_select_kernels(blip_kernels(k - 1));
+
+  for (i = 0; i < 3; i++)
+  {
+    blip_delete(blips[i]);
+  }
+  free(bench_deltas);
+
+  return result;
+}
+
+static int usage(const char *name)
+{
+  fprintf(stderr, "Genesis Plus GX headless benchmark\n");
+  fprintf(stderr, "usage: %s [options] gamename\n", name);
+  fprintf(stderr, "  -frames <n>     number of measured frames (default %d)\n", BENCH_FRAMES);
+  fprintf(stderr, "  -warmup <n>     number of frames run before measurement (default 0)\n");
+  fprintf(stderr, "  -skip           skip video rendering\n");
+  fprintf(stderr, "  -nuked          use Nuked YM2612 core (if available)\n");
+  fprintf(stderr, "  -runahead <n>   emulate <n> frames ahead and roll back before each frame\n");
+  fprintf(stderr, "  -runahead-check run measured frames without run-ahead first and check run-ahead output is the same\n");
+  fprintf(stderr, "  -mute           disable sound generation (silent audio output, timers & status kept accurate)\n");
+  fprintf(stderr, "  -mute-ahead     disable sound generation for run-ahead frames only\n");
+  fprintf(stderr, "  -rewind <mb>    record rewind history in a <mb> MB buffer and check it after measurement\n");
+  fprintf(stderr, "  -record <file>  record a movie of the whole run (warm-up included), driven by synthetic gamepad input\n");
+  fprintf(stderr, "  -play <file>    replay a movie from its starting point\n");
+  fprintf(stderr, "  -replay-check   replay recorded movie after measurement and check output is the same\n");
+  fprintf(stderr, "  -format <fmt>   output pixel format: rgb565, xrgb8888 or indexed (default: compile-time format)\n");
+  fprintf(stderr, "  -ntsc           apply NTSC composite video filter\n");
+  fprintf(stderr, "  -dirty          copy modified lines of each frame to a second framebuffer and check it\n");
+  fprintf(stderr, "  -remap          benchmark pixel color remapping kernels and exit (no game needed)\n");
+  fprintf(stderr, "  -merge          benchmark Mode 5 layers merging kernels and exit (no game needed)\n");
+  fprintf(stderr, "  -patterns       benchmark pattern cache update and exit (no game needed)\n");
+  fprintf(stderr, "  -blip           check & benchmark blip buffer kernels with recorded deltas and exit (no game needed)\n");
+#ifdef HAVE_YM3438_CORE
+  fprintf(stderr, "  -ym3438         check & benchmark Nuked OPN2 batched clocking against per-cycle clocking and exit (no game needed)\n");
+#endif
+#ifdef BUILD_TABLES
+  fprintf(stderr, "  -tables <dir>   write look-up tables headers built by the core into <dir> and exit (no game needed)\n");
+#endif
+#ifdef USE_YM2612_SIMD
+  fprintf(stderr, "  -ym2612         check & benchmark YM2612 operators evaluated all at once against per-channel evaluation and exit (no game needed)\n");
+#endif
+#ifdef USE_MULTI_INSTANCE
+  fprintf(stderr, "  -instances <n>  number of emulator instances run concurrently (default 1)\n");
+#endif
+#ifdef USE_RENDER_THREAD
+  fprintf(stderr, "  -threaded       render Mode 5 lines on a worker thread\n");
+#endif
+#ifdef USE_NTSC_THREADS
+  fprintf(stderr, "  -ntsc-threads <n> apply NTSC filter at end of frame in <n> strips, on <n>-1 worker threads\n");
+#endif
+#ifdef USE_FM_THREAD
+  fprintf(stderr, "  -fm-thread      synthesize YM2612 samples on a worker thread\n");
+#endif
+  return 1;
+}
+
+int main (int argc, char **argv)
+{
+  int i;
+  int instances = 1;
+  int result = 0;
+
+  /* set default config */
+  error_init();
+  set_config_defaults();
+
+  memset(&bench, 0, sizeof(bench));
+  bench.frames = BENCH_FRAMES;
+  bench.runahead_ok = -1;
+  bench.replay_ok = -1;
+
+  /* parse command line */
+  for (i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "-frames") && (i + 1 < argc))
+    {
+      bench.frames = atoi(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-warmup") && (i + 1 < argc))
+    {
+      bench.warmup = atoi(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-skip"))
+    {
+      bench.do_skip = 1;
+    }
+    else if (!strcmp(argv[i], "-nuked"))
+    {
+#ifdef HAVE_YM3438_CORE
+      config.ym3438 = 1;
+#endif
+    }
+    else if (!strcmp(argv[i], "-mute"))
+    {
+      bench.mute = 1;
+    }
+    else if (!strcmp(argv[i], "-mute-ahead"))
+    {
+      bench.mute = 2;
+    }
+    else if (!strcmp(argv[i], "-runahead") && (i + 1 < argc))
+    {
+      bench.runahead = atoi(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-runahead-check"))
+    {
+      bench.runahead_check = 1;
+    }
+    else if (!strcmp(argv[i], "-rewind") && (i + 1 < argc))
+    {
+      bench.rewind = atoi(argv[++i]);
+    }
+    else if (!strcmp(argv[i], "-record") && (i + 1 < argc))
+    {
+      bench.record = argv[++i];
+    }
+    else if (!strcmp(argv[i], "-play") && (i + 1 < argc))
+    {
+      bench.play = argv[++i];
+    }
+    else if (!strcmp(argv[i], "-replay-check"))
+    {
+      bench.replay_check = 1;
+    }
+    else if (!strcmp(argv[i], "-format") && (i + 1 < argc))
+    {
+      i++;
+      if (!strcmp(argv[i], "rgb565"))
+      {
+        bench.format = PIXEL_FORMAT_RGB565;
+      }
+      else if (!strcmp(argv[i], "xrgb8888"))
+      {
+        bench.format = PIXEL_FORMAT_XRGB8888;
+      }
+      else if (!strcmp(argv[i], "indexed"))
+      {
+        bench.format = PIXEL_FORMAT_INDEXED;
+      }
+      else
+      {
+        return usage(argv[0]);
+      }
+
+      if (!render_format_bpp(bench.format))
+      {
+        fprintf(stderr, "Pixel format `%s' is not supported by this build.\n", argv[i]);
+        return 1;
+      }
+    }
+    else if (!strcmp(argv[i], "-ntsc"))
+    {
+      config.ntsc = 1;
+    }
+    else if (!strcmp(argv[i], "-dirty"))
+    {
+      bench.dirty = 1;
+    }
+    else if (!strcmp(argv[i], "-remap"))
+    {
+      return bench_remap();
+    }
+    else if (!strcmp(argv[i], "-merge"))
+    {
+      return bench_merge();
+    }
+    else if (!strcmp(argv[i], "-patterns"))
+    {
+      return bench_patterns();
+    }
+    else if (!strcmp(argv[i], "-blip"))
+    {
+      return bench_blip();
+    }
+#ifdef HAVE_YM3438_CORE
+    else if (!strcmp(argv[i], "-ym3438"))
+    {
+      return bench_opn2_batch();
+    }
+#endif
+#ifdef BUILD_TABLES
+    else if (!strcmp(argv[i], "-tables") && (i + 1 < argc))
+    {
+      return gen_tables(argv[i + 1]);
+    }
+#endif
+#ifdef USE_YM2612_SIMD
+    else if (!strcmp(argv[i], "-ym2612"))
+    {
+      return bench_ym2612();
+    }
+#endif
+#ifdef USE_MULTI_INSTANCE
+    else if (!strcmp(argv[i], "-instances") && (i + 1 < argc))
+    {
+      instances = atoi(argv[++i]);
+    }
+#endif
+#ifdef USE_RENDER_THREAD
+    else if (!strcmp(argv[i], "-threaded"))
+    {
+      bench.threaded = 1;
+    }
+#endif
+#ifdef USE_NTSC_THREADS
+    else if (!strcmp(argv[i], "-ntsc-threads") && (i + 1 < argc))
+    {
+      bench.ntsc_threads = atoi(argv[++i]);
+    }
+#endif
+#ifdef USE_FM_THREAD
+    else if (!strcmp(argv[i], "-fm-thread"))
+    {
+      bench.fm_thread = 1;
+    }
+#endif
+    else if (argv[i][0] == '-')
+    {
+      return usage(argv[0]);
+    }
+    else
+    {
+      bench.filename = argv[i];
+    }
+  }
+
+  if (!bench.filename || (bench.frames <= 0) || (bench.rewind < 0) || (bench.runahead < 0) || (bench.runahead_check && !bench.runahead) || (bench.replay_check && !bench.record) || (bench.record && bench.play) || (instances <= 0) || (instances > BENCH_MAX_INSTANCES))
+  {
+    return usage(argv[0]);
+  }
+
+  if (config.ntsc)
+  {
+    /* filter tables are shared by all instances */
+    md_ntsc = calloc(1, sizeof(md_ntsc_t));
+    sms_ntsc = calloc(1, sizeof(sms_ntsc_t));
+    if (!md_ntsc || !sms_ntsc)
+    {
+      fprintf(stderr, "Error allocating NTSC filters.\n");
+      return 1;
+    }
+    md_ntsc_init(md_ntsc, &md_ntsc_composite);
+    sms_ntsc_init(sms_ntsc, &sms_ntsc_composite);
+  }
+
+#ifdef USE_MULTI_INSTANCE
+  if (instances > 1)
+  {
+    pthread_t threads[BENCH_MAX_INSTANCES];
+    t_bench setup[BENCH_MAX_INSTANCES];
+    double start = bench_time();
+
+    for (i = 0; i < instances; i++)
+    {
+      setup[i] = bench;
+      setup[i].id = i + 1;
+      if (pthread_create(&threads[i], NULL, bench_thread, &setup[i]))
+      {
+        fprintf(stderr, "Error creating instance %d.\n", i + 1);
+        instances = i;
+        result = 1;
+        break;
+      }
+    }
+
+    for (i = 0; i < instances; i++)
+    {
+      void *status;
+      pthread_join(threads[i], &status);
+      result |= (int)(size_t)status;
+    }
+
+    printf("instances:    %d\n", instances);
+    printf("total time:   %.3f s\n", bench_time() - start);
+  }
+  else
+#endif
+  {
+    result = bench_instance();
+  }
+
+  free(md_ntsc);
+  free(sms_ntsc);
+  error_shutdown();
+
+  return result;
+}
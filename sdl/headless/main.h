@@ -0,0 +1,10 @@
+#ifndef _MAIN_H_
+#define _MAIN_H_
+
+#define MAX_INPUTS 8
+
+extern int debug_on;
+extern int log_error;
+extern int sdl_input_update(void);
+
+#endif /* _MAIN_H_ */
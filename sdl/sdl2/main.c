@@ -156,8 +156,40 @@ static int sdl_video_init()
   return 1;
 }
 
+static void sdl_video_blit(int full)
+{
+  const t_dirty_lines *dirty = render_dirty_lines();
+  SDL_Rect srect = sdl_video.srect;
+  SDL_Rect drect = sdl_video.drect;
+  int y, end = sdl_video.srect.y + sdl_video.srect.h;
+
+  if (full)
+  {
+    SDL_BlitSurface(sdl_video.surf_bitmap, &srect, sdl_video.surf_screen, &drect);
+    return;
+  }
+
+  /* only modified lines are blitted, consecutive lines together */
+  for (y = sdl_video.srect.y; y < end; y++)
+  {
+    if ((y < DIRTY_MAX_LINES) && !dirty->line[y]) continue;
+
+    srect.y = y;
+    while ((y < end) && ((y >= DIRTY_MAX_LINES) || dirty->line[y])) y++;
+    srect.h = y - srect.y;
+
+    drect.x = sdl_video.drect.x;
+    drect.y = sdl_video.drect.y + (srect.y - sdl_video.srect.y);
+    drect.w = srect.w;
+    drect.h = srect.h;
+    SDL_BlitSurface(sdl_video.surf_bitmap, &srect, sdl_video.surf_screen, &drect);
+  }
+}
+
 static void sdl_video_update()
 {
+  int full = 0;
+
   if (system_hw == SYSTEM_MCD)
   {
     system_frame_scd(0);
@@ -200,6 +232,7 @@ static void sdl_video_update()
 
     /* clear destination surface */
     SDL_FillRect(sdl_video.surf_screen, 0, 0);
+    full = 1;
 
 #if 0
     if (config.render && (interlaced || config.ntsc))  rect.h *= 2;
@@ -242,7 +275,7 @@ static void sdl_video_update()
 #endif
   }
 
-  SDL_BlitSurface(sdl_video.surf_bitmap, &sdl_video.srect, sdl_video.surf_screen, &sdl_video.drect);
+  sdl_video_blit(full);
   SDL_UpdateWindowSurface(sdl_video.window);
 
   ++sdl_video.frames_rendered;
@@ -373,8 +406,8 @@ static int sdl_control_update(SDL_Keycode keystate)
         if (f)
         {
           uint8 buf[STATE_SIZE];
-          fread(&buf, STATE_SIZE, 1, f);
-          state_load(buf);
+          int len = fread(&buf, 1, STATE_SIZE, f);
+          state_load(buf, len);
           fclose(f);
         }
         break;